@@ -0,0 +1,262 @@
+#include "async_io.h"
+
+#include <errno.h>
+#include <linux/io_uring.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <algorithm>
+
+namespace {
+
+int io_uring_setup(unsigned entries, struct io_uring_params *params) {
+    return static_cast<int>(syscall(__NR_io_uring_setup, entries, params));
+}
+
+int io_uring_enter(int ring_fd, unsigned to_submit, unsigned min_complete, unsigned flags) {
+    return static_cast<int>(syscall(__NR_io_uring_enter, ring_fd, to_submit, min_complete, flags, nullptr, 0));
+}
+
+// 完成线程收到该user_data时退出
+constexpr uint64_t SHUTDOWN_USER_DATA = 0;
+
+}  // namespace
+
+std::unique_ptr<AsyncIO> AsyncIO::create(unsigned queue_depth) {
+    queue_depth = std::max(queue_depth, 1u);
+    if (auto ring = IoUringIO::create(queue_depth)) {
+        return ring;
+    }
+    return std::make_unique<ThreadPoolIO>(queue_depth);
+}
+
+/**
+ * @description: 创建io_uring并映射提交队列、完成队列和SQE数组
+ * @return {unique_ptr<IoUringIO>} 内核不支持io_uring或创建失败时返回nullptr
+ */
+std::unique_ptr<IoUringIO> IoUringIO::create(unsigned queue_depth) {
+    queue_depth = std::max(queue_depth, 1u);
+    std::unique_ptr<IoUringIO> ring(new IoUringIO());
+    struct io_uring_params params;
+    memset(&params, 0, sizeof(params));
+    // 多留一个位置给关闭时的NOP
+    ring->ring_fd_ = io_uring_setup(queue_depth + 1, &params);
+    if (ring->ring_fd_ < 0) {
+        return nullptr;
+    }
+    ring->queue_depth_ = queue_depth;
+    ring->sq_ring_size_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    ring->cq_ring_size_ = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+    bool single_mmap = params.features & IORING_FEAT_SINGLE_MMAP;
+    if (single_mmap) {
+        ring->sq_ring_size_ = ring->cq_ring_size_ = std::max(ring->sq_ring_size_, ring->cq_ring_size_);
+    }
+    ring->sq_ring_ = mmap(nullptr, ring->sq_ring_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                          ring->ring_fd_, IORING_OFF_SQ_RING);
+    if (ring->sq_ring_ == MAP_FAILED) {
+        ring->sq_ring_ = nullptr;
+        return nullptr;
+    }
+    if (single_mmap) {
+        ring->cq_ring_ = ring->sq_ring_;
+    } else {
+        ring->cq_ring_ = mmap(nullptr, ring->cq_ring_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                              ring->ring_fd_, IORING_OFF_CQ_RING);
+        if (ring->cq_ring_ == MAP_FAILED) {
+            ring->cq_ring_ = nullptr;
+            return nullptr;
+        }
+    }
+    ring->sqes_size_ = params.sq_entries * sizeof(struct io_uring_sqe);
+    void *sqes = mmap(nullptr, ring->sqes_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring->ring_fd_,
+                      IORING_OFF_SQES);
+    if (sqes == MAP_FAILED) {
+        return nullptr;
+    }
+    ring->sqes_ = static_cast<struct io_uring_sqe *>(sqes);
+
+    char *sq = static_cast<char *>(ring->sq_ring_);
+    ring->sq_head_ = reinterpret_cast<unsigned *>(sq + params.sq_off.head);
+    ring->sq_tail_ = reinterpret_cast<unsigned *>(sq + params.sq_off.tail);
+    ring->sq_mask_ = reinterpret_cast<unsigned *>(sq + params.sq_off.ring_mask);
+    ring->sq_array_ = reinterpret_cast<unsigned *>(sq + params.sq_off.array);
+    char *cq = static_cast<char *>(ring->cq_ring_);
+    ring->cq_head_ = reinterpret_cast<unsigned *>(cq + params.cq_off.head);
+    ring->cq_tail_ = reinterpret_cast<unsigned *>(cq + params.cq_off.tail);
+    ring->cq_mask_ = reinterpret_cast<unsigned *>(cq + params.cq_off.ring_mask);
+    ring->cqes_ = reinterpret_cast<struct io_uring_cqe *>(cq + params.cq_off.cqes);
+
+    ring->completer_ = std::thread(&IoUringIO::completion_loop, ring.get());
+    return ring;
+}
+
+IoUringIO::~IoUringIO() {
+    if (completer_.joinable()) {
+        int err;
+        {
+            // 等待在途请求完成，再提交一个NOP通知完成线程退出
+            std::unique_lock lock{latch_};
+            slot_cv_.wait(lock, [this] { return inflight_ == 0; });
+            err = push_sqe(IORING_OP_NOP, -1, 0, nullptr);
+        }
+        if (err != 0) {
+            // 无法唤醒完成线程，它仍在使用映射的队列，只能放弃回收这些资源
+            completer_.detach();
+            return;
+        }
+        completer_.join();
+    }
+    if (sqes_ != nullptr) {
+        munmap(sqes_, sqes_size_);
+    }
+    if (cq_ring_ != nullptr && cq_ring_ != sq_ring_) {
+        munmap(cq_ring_, cq_ring_size_);
+    }
+    if (sq_ring_ != nullptr) {
+        munmap(sq_ring_, sq_ring_size_);
+    }
+    if (ring_fd_ >= 0) {
+        close(ring_fd_);
+    }
+}
+
+/**
+ * @description: 提交一次向量读写，在途请求数达到队列深度时阻塞
+ */
+void IoUringIO::submit(int fd, off_t offset, std::vector<struct iovec> iov, bool is_write, IOCallback callback) {
+    auto *request = new Request{std::move(iov), std::move(callback)};
+    std::unique_lock lock{latch_};
+    slot_cv_.wait(lock, [this] { return inflight_ < queue_depth_; });
+    inflight_++;
+    int err = push_sqe(is_write ? IORING_OP_WRITEV : IORING_OP_READV, fd, offset, request);
+    if (err == 0) {
+        return;
+    }
+    // 请求没有进入内核，不会产生完成事件，直接以错误码完成
+    inflight_--;
+    lock.unlock();
+    slot_cv_.notify_all();
+    request->callback(err);
+    delete request;
+}
+
+/**
+ * @description: 填写一个SQE并通知内核，调用前需持有latch_
+ * @return {int} 成功返回0；io_uring_enter失败时撤回该SQE并返回-errno
+ */
+int IoUringIO::push_sqe(uint8_t opcode, int fd, off_t offset, Request *request) {
+    unsigned tail = *sq_tail_;
+    unsigned index = tail & *sq_mask_;
+    struct io_uring_sqe *sqe = &sqes_[index];
+    memset(sqe, 0, sizeof(*sqe));
+    sqe->opcode = opcode;
+    sqe->fd = fd;
+    sqe->off = static_cast<uint64_t>(offset);
+    if (request != nullptr) {
+        sqe->addr = reinterpret_cast<uint64_t>(request->iov.data());
+        sqe->len = static_cast<uint32_t>(request->iov.size());
+    }
+    sqe->user_data = request == nullptr ? SHUTDOWN_USER_DATA : reinterpret_cast<uint64_t>(request);
+    sq_array_[index] = index;
+    // SQE写完后才能让内核看到新的tail
+    __atomic_store_n(sq_tail_, tail + 1, __ATOMIC_RELEASE);
+    while (io_uring_enter(ring_fd_, 1, 0, 0) < 0) {
+        if (errno == EINTR || errno == EAGAIN) {
+            continue;
+        }
+        // 内核没有取走该SQE，latch_保证期间没有其他提交，可以安全撤回tail
+        int err = errno;
+        __atomic_store_n(sq_tail_, tail, __ATOMIC_RELEASE);
+        return -err;
+    }
+    return 0;
+}
+
+/**
+ * @description: 完成线程主循环：等待完成事件，执行回调并释放提交队列中的位置
+ */
+void IoUringIO::completion_loop() {
+    while (true) {
+        unsigned head = *cq_head_;
+        if (head == __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE)) {
+            io_uring_enter(ring_fd_, 0, 1, IORING_ENTER_GETEVENTS);
+            continue;
+        }
+        struct io_uring_cqe *cqe = &cqes_[head & *cq_mask_];
+        uint64_t user_data = cqe->user_data;
+        ssize_t result = cqe->res;
+        __atomic_store_n(cq_head_, head + 1, __ATOMIC_RELEASE);
+        if (user_data == SHUTDOWN_USER_DATA) {
+            return;
+        }
+        auto *request = reinterpret_cast<Request *>(user_data);
+        request->callback(result);
+        delete request;
+        {
+            std::scoped_lock lock{latch_};
+            inflight_--;
+        }
+        slot_cv_.notify_all();
+    }
+}
+
+ThreadPoolIO::ThreadPoolIO(unsigned queue_depth) : queue_depth_(std::max(queue_depth, 1u)) {
+    unsigned num_workers = std::min(queue_depth_, MAX_WORKERS);
+    for (unsigned i = 0; i < num_workers; i++) {
+        workers_.emplace_back(&ThreadPoolIO::worker_loop, this);
+    }
+}
+
+ThreadPoolIO::~ThreadPoolIO() {
+    {
+        std::unique_lock lock{latch_};
+        slot_cv_.wait(lock, [this] { return inflight_ == 0; });
+        running_ = false;
+    }
+    work_cv_.notify_all();
+    for (auto &worker : workers_) {
+        worker.join();
+    }
+}
+
+/**
+ * @description: 把请求放入队列交给工作线程，排队和执行中的请求数达到队列深度时阻塞
+ */
+void ThreadPoolIO::submit(int fd, off_t offset, std::vector<struct iovec> iov, bool is_write, IOCallback callback) {
+    {
+        std::unique_lock lock{latch_};
+        slot_cv_.wait(lock, [this] { return inflight_ < queue_depth_; });
+        inflight_++;
+        queue_.push_back({fd, offset, std::move(iov), is_write, std::move(callback)});
+    }
+    work_cv_.notify_one();
+}
+
+/**
+ * @description: 工作线程主循环
+ */
+void ThreadPoolIO::worker_loop() {
+    while (true) {
+        Request request;
+        {
+            std::unique_lock lock{latch_};
+            work_cv_.wait(lock, [this] { return !running_ || !queue_.empty(); });
+            if (queue_.empty()) {
+                return;
+            }
+            request = std::move(queue_.front());
+            queue_.pop_front();
+        }
+        int iovcnt = static_cast<int>(request.iov.size());
+        ssize_t result = request.is_write ? pwritev(request.fd, request.iov.data(), iovcnt, request.offset)
+                                          : preadv(request.fd, request.iov.data(), iovcnt, request.offset);
+        request.callback(result < 0 ? -errno : result);
+        {
+            std::scoped_lock lock{latch_};
+            inflight_--;
+        }
+        slot_cv_.notify_all();
+    }
+}
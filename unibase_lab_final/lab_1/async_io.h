@@ -0,0 +1,126 @@
+#pragma once
+
+#include <sys/types.h>
+#include <sys/uio.h>
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/* 异步读写完成时的回调，参数为preadv/pwritev的返回值，出错时为-errno
+ * 回调在后端的完成线程中执行，不能在回调中再提交请求，否则队列满时完成线程会等待自己 */
+using IOCallback = std::function<void(ssize_t)>;
+
+/**
+ * @description: 异步页面读写后端，由DiskManager持有
+ *               提交后立即返回，已提交未完成的请求数达到队列深度时submit阻塞，直到有请求完成
+ */
+class AsyncIO {
+   public:
+    virtual ~AsyncIO() = default;
+
+    /**
+     * @description: 提交一次从offset开始的向量读或写，iov中的缓冲区在回调执行前必须保持有效
+     */
+    virtual void submit(int fd, off_t offset, std::vector<struct iovec> iov, bool is_write, IOCallback callback) = 0;
+
+    virtual const char *name() const = 0;
+
+    /**
+     * @description: 优先创建io_uring后端，内核不支持或被禁止（如seccomp）时退回线程池后端
+     * @param {unsigned} queue_depth 同时在途的最大请求数，为0时按1处理
+     */
+    static std::unique_ptr<AsyncIO> create(unsigned queue_depth);
+};
+
+/**
+ * @description: 基于io_uring的后端，直接使用io_uring_setup/io_uring_enter系统调用，不依赖liburing
+ *               提交在调用线程中完成，一个完成线程阻塞在io_uring_enter上收割完成事件并执行回调
+ */
+class IoUringIO : public AsyncIO {
+   public:
+    ~IoUringIO() override;
+
+    // io_uring不可用时返回nullptr
+    static std::unique_ptr<IoUringIO> create(unsigned queue_depth);
+
+    void submit(int fd, off_t offset, std::vector<struct iovec> iov, bool is_write, IOCallback callback) override;
+
+    const char *name() const override { return "io_uring"; }
+
+   private:
+    struct Request {
+        std::vector<struct iovec> iov;
+        IOCallback callback;
+    };
+
+    IoUringIO() = default;
+
+    int push_sqe(uint8_t opcode, int fd, off_t offset, Request *request);
+
+    void completion_loop();
+
+    int ring_fd_ = -1;
+    unsigned queue_depth_ = 0;
+    void *sq_ring_ = nullptr;
+    size_t sq_ring_size_ = 0;
+    void *cq_ring_ = nullptr;       // 内核支持IORING_FEAT_SINGLE_MMAP时与sq_ring_相同
+    size_t cq_ring_size_ = 0;
+    struct io_uring_sqe *sqes_ = nullptr;
+    size_t sqes_size_ = 0;
+
+    // 映射到共享内存中的环形队列字段
+    unsigned *sq_head_ = nullptr;
+    unsigned *sq_tail_ = nullptr;
+    unsigned *sq_mask_ = nullptr;
+    unsigned *sq_array_ = nullptr;
+    unsigned *cq_head_ = nullptr;
+    unsigned *cq_tail_ = nullptr;
+    unsigned *cq_mask_ = nullptr;
+    struct io_uring_cqe *cqes_ = nullptr;
+
+    std::mutex latch_;              // 保护提交队列和inflight_
+    std::condition_variable slot_cv_;
+    unsigned inflight_ = 0;         // 已提交未完成的请求数，不超过queue_depth_，保证完成队列不会溢出
+    std::thread completer_;
+};
+
+/**
+ * @description: 线程池后端，io_uring不可用时使用，每个工作线程同步执行preadv/pwritev
+ */
+class ThreadPoolIO : public AsyncIO {
+   public:
+    explicit ThreadPoolIO(unsigned queue_depth);
+
+    ~ThreadPoolIO() override;
+
+    void submit(int fd, off_t offset, std::vector<struct iovec> iov, bool is_write, IOCallback callback) override;
+
+    const char *name() const override { return "thread_pool"; }
+
+   private:
+    struct Request {
+        int fd;
+        off_t offset;
+        std::vector<struct iovec> iov;
+        bool is_write;
+        IOCallback callback;
+    };
+
+    void worker_loop();
+
+    static constexpr unsigned MAX_WORKERS = 16;
+
+    unsigned queue_depth_;
+    std::mutex latch_;              // 保护queue_、inflight_和running_
+    std::condition_variable work_cv_;
+    std::condition_variable slot_cv_;
+    std::deque<Request> queue_;
+    unsigned inflight_ = 0;         // 排队和执行中的请求数
+    bool running_ = true;
+    std::vector<std::thread> workers_;
+};
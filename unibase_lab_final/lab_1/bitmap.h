@@ -0,0 +1,160 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+static constexpr int BITMAP_WIDTH = 8;
+static constexpr unsigned BITMAP_HIGHEST_BIT = 0x80u;  // 10000000
+
+/**
+ * @description: 页面中记录槽位的位图，第pos位存放在第pos / 8个字节中，字节内从最高位开始编号
+ *               查找和遍历按8字节的字处理：按小端读入一个字并把每个字节内的位反转后，第pos位恰好是字的第pos % 64位，
+ *               用ctz一次跳过所有不满足条件的位，用word & (word - 1)清除已处理的最低位；
+ *               位图较宽时先用SSE2每次跳过16个全0（或全1）的字节
+ */
+class Bitmap {
+   public:
+    // 从地址bm开始的size个字节全部置0
+    static void init(char *bm, int size) { memset(bm, 0, size); }
+
+    // pos位 置1
+    static void set(char *bm, int pos) { bm[get_bucket(pos)] |= get_bit(pos); }
+
+    // [begin, end)中的位全部置1，中间的整字节直接memset
+    static void set_range(char *bm, int begin, int end) {
+        while (begin < end && begin % BITMAP_WIDTH != 0) {
+            set(bm, begin++);
+        }
+        int num_full_bytes = (end - begin) / BITMAP_WIDTH;
+        if (num_full_bytes > 0) {
+            memset(bm + get_bucket(begin), 0xff, num_full_bytes);
+            begin += num_full_bytes * BITMAP_WIDTH;
+        }
+        while (begin < end) {
+            set(bm, begin++);
+        }
+    }
+
+    // pos位 置0
+    static void reset(char *bm, int pos) { bm[get_bucket(pos)] &= static_cast<char>(~get_bit(pos)); }
+
+    // 如果pos位是1，则返回true
+    static bool is_set(const char *bm, int pos) { return (bm[get_bucket(pos)] & get_bit(pos)) != 0; }
+
+    /**
+     * @brief 找下一个为0 or 1的位
+     * @param bit false表示要找下一个为0的位，true表示要找下一个为1的位
+     * @param bm 要找的起始地址为bm
+     * @param max_n 要找的从起始地址开始的偏移为[curr+1,max_n)
+     * @param curr 要找的从起始地址开始的偏移为[curr+1,max_n)
+     * @return 找到了就返回偏移位置，没找到就返回max_n
+     */
+    static int next_bit(bool bit, const char *bm, int max_n, int curr) {
+        int pos = curr + 1;
+        int num_bytes = (max_n + BITMAP_WIDTH - 1) / BITMAP_WIDTH;
+        while (pos < max_n) {
+            int byte = skip_bytes(bit, bm, pos / BITMAP_WIDTH, num_bytes);
+            if (byte * BITMAP_WIDTH > pos) {
+                pos = byte * BITMAP_WIDTH;
+            }
+            if (pos >= max_n) {
+                break;
+            }
+            byte = pos / BITMAP_WIDTH;
+            uint64_t word = load_word(bm, byte, num_bytes);
+            if (!bit) {
+                word = ~word;
+            }
+            word &= ~0ULL << (pos % BITMAP_WIDTH);  // 去掉pos之前的位
+            if (word != 0) {
+                int found = byte * BITMAP_WIDTH + __builtin_ctzll(word);
+                return found < max_n ? found : max_n;
+            }
+            pos = (byte + 8) * BITMAP_WIDTH;
+        }
+        return max_n;
+    }
+
+    // 相当于next_bit(bit, bm, max_n, -1)
+    static int first_bit(bool bit, const char *bm, int max_n) { return next_bit(bit, bm, max_n, -1); }
+
+    /**
+     * @brief 按递增顺序对[0, max_n)中每个为1的位调用f(pos)，每次处理一个字，比逐个调用next_bit少一半分支
+     */
+    template <typename F>
+    static void for_each_set(const char *bm, int max_n, F &&f) {
+        int num_bytes = (max_n + BITMAP_WIDTH - 1) / BITMAP_WIDTH;
+        int byte = 0;
+        while (byte < num_bytes) {
+            byte = skip_bytes(true, bm, byte, num_bytes);
+            if (byte >= num_bytes) {
+                break;
+            }
+            uint64_t word = load_word(bm, byte, num_bytes);
+            while (word != 0) {
+                int pos = byte * BITMAP_WIDTH + __builtin_ctzll(word);
+                if (pos >= max_n) {
+                    return;
+                }
+                f(pos);
+                word &= word - 1;
+            }
+            byte += 8;
+        }
+    }
+
+    // [0, max_n)中为1的位的个数
+    static int count(const char *bm, int max_n) {
+        int num_bytes = (max_n + BITMAP_WIDTH - 1) / BITMAP_WIDTH;
+        int total = 0;
+        for (int byte = 0; byte < num_bytes; byte += 8) {
+            uint64_t word = load_word(bm, byte, num_bytes);
+            int end = max_n - byte * BITMAP_WIDTH;
+            if (end < 64) {
+                word &= (1ULL << end) - 1;  // 去掉max_n及之后的位
+            }
+            total += __builtin_popcountll(word);
+        }
+        return total;
+    }
+
+   private:
+    static int get_bucket(int pos) { return pos / BITMAP_WIDTH; }
+
+    static char get_bit(int pos) { return BITMAP_HIGHEST_BIT >> static_cast<char>(pos % BITMAP_WIDTH); }
+
+    // 读入从第byte个字节开始的8个字节，超出num_bytes的部分补0；返回的字中第i位对应位图中从第byte个字节起的第i位
+    static uint64_t load_word(const char *bm, int byte, int num_bytes) {
+        uint64_t word = 0;
+        if (byte + 8 <= num_bytes) {
+            memcpy(&word, bm + byte, 8);
+        } else {
+            memcpy(&word, bm + byte, num_bytes - byte);
+        }
+        static_assert(__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__, "Bitmap::load_word assumes a little-endian host");
+        // 反转每个字节内的位：字节内从最高位开始编号，反转后与字内从最低位开始编号一致
+        word = ((word >> 1) & 0x5555555555555555ULL) | ((word & 0x5555555555555555ULL) << 1);
+        word = ((word >> 2) & 0x3333333333333333ULL) | ((word & 0x3333333333333333ULL) << 2);
+        word = ((word >> 4) & 0x0f0f0f0f0f0f0f0fULL) | ((word & 0x0f0f0f0f0f0f0f0fULL) << 4);
+        return word;
+    }
+
+    // 从第byte个字节开始跳过全部不含目标位的16字节块（找1时跳过全0，找0时跳过全1），返回第一个可能含目标位的字节
+    static int skip_bytes(bool bit, const char *bm, int byte, int num_bytes) {
+#ifdef __SSE2__
+        const __m128i skip = _mm_set1_epi8(bit ? 0 : static_cast<char>(0xff));
+        while (byte + 16 <= num_bytes) {
+            __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i *>(bm + byte));
+            if (_mm_movemask_epi8(_mm_cmpeq_epi8(block, skip)) != 0xffff) {
+                break;
+            }
+            byte += 16;
+        }
+#endif
+        return byte;
+    }
+};
@@ -1,7 +1,42 @@
 #include "buffer_pool_manager.h"
 
+/**
+ * @description: 申请帧内存：所有帧的数据放在一整块按页（或按大页）对齐的内存中，
+ *               对齐后的帧可以直接作为O_DIRECT读写的缓冲区
+ *               按max_pool_size_用mmap预留地址空间，匿名映射在首次写入时才分配物理内存且初始为0，
+ *               因此预留的上限远大于pool_size_时也不会多占内存
+ * @param {bool} use_huge_pages 是否按2MB对齐并通过madvise建议内核使用透明大页
+ */
+void BufferPoolManager::init_frames(bool use_huge_pages) {
+    size_t align = use_huge_pages ? HUGE_PAGE_SIZE : PAGE_SIZE;
+    frame_data_size_ = (std::max<size_t>(max_pool_size_, 1) * PAGE_SIZE + align - 1) / align * align;
+    // 多映射align字节，截掉首尾未对齐的部分
+    size_t map_size = frame_data_size_ + align;
+    void *map = mmap(nullptr, map_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    if (map == MAP_FAILED) {
+        throw std::bad_alloc();
+    }
+    char *base = static_cast<char *>(map);
+    size_t head = (align - reinterpret_cast<uintptr_t>(base) % align) % align;
+    if (head > 0) {
+        munmap(base, head);
+    }
+    munmap(base + head + frame_data_size_, map_size - head - frame_data_size_);
+    frame_data_ = base + head;
+    if (use_huge_pages) {
+        // 内核未开启透明大页时madvise会失败，此时退化为普通页面，不影响正确性
+        madvise(frame_data_, frame_data_size_, MADV_HUGEPAGE);
+    }
+    pages_ = new Page[max_pool_size_];
+    for (size_t i = 0; i < max_pool_size_; ++i) {
+        pages_[i].data_ = frame_data_ + i * PAGE_SIZE;
+        pages_[i].pin_count_ = Page::PIN_COUNT_EVICTING;    // 空闲帧不能被无锁路径固定
+    }
+}
+
 /**
  * @description: 从free_list或replacer中得到可淘汰帧页的 *frame_id
+ *               返回的帧pin_count_为PIN_COUNT_EVICTING，调用方更新页面后再设置实际的固定计数
  * @return {bool} true: 可替换帧查找成功 , false: 可替换帧查找失败
  * @param {frame_id_t*} frame_id 帧页id指针,返回成功找到的可替换帧id
  */
@@ -13,10 +48,40 @@ bool BufferPoolManager::find_victim_page(frame_id_t* frame_id) {
         free_list_.pop_front();
         return true;
     }
-    else
-    {
-        return replacer_->victim(frame_id);
+    // 后台线程正在写回的帧不能淘汰，先跳过，选出victim后再放回replacer的冷端
+    std::vector<frame_id_t> skipped;
+    bool found = false;
+    while (replacer_->victim(frame_id)) {
+        if (flushing_frames_[*frame_id]) {
+            skipped.push_back(*frame_id);
+            continue;
+        }
+        if (static_cast<size_t>(*frame_id) >= pool_size_) {
+            // 缩容中等待回收的帧不再装入新页面，顺便回收；回收失败说明它已被重新固定，unpin后会再回到replacer
+            if (retire_frame(*frame_id)) {
+                madvise(pages_[*frame_id].get_data(), PAGE_SIZE, MADV_DONTNEED);
+            }
+            continue;
+        }
+        int expected = 0;
+        if (pages_[*frame_id].pin_count_.compare_exchange_strong(expected, Page::PIN_COUNT_EVICTING)) {
+            found = true;
+            break;
+        }
+        // 帧已被无锁命中路径固定，不放回replacer，等它的pin_count_减到0时再由release_frame放回
+    }
+    for (frame_id_t skipped_id : skipped) {
+        replacer_->unpin_cold(skipped_id);
+    }
+    if (found) {
+        num_evictions_++;
+        if (pages_[*frame_id].is_dirty()) {
+            // 前台淘汰仍需写盘，说明干净帧不足，唤醒后台线程
+            num_dirty_evictions_++;
+            flusher_cv_.notify_one();
+        }
     }
+    return found;
 
     // Todo:
     // 1 使用BufferPoolManager::free_list_判断缓冲池是否已满需要淘汰页面
@@ -24,31 +89,79 @@ bool BufferPoolManager::find_victim_page(frame_id_t* frame_id) {
     // 1.2 已满使用lru_replacer中的方法选择淘汰页面
 }
 
+/**
+ * @description: 回收缩容时编号不小于pool_size_的帧：脏页写回，把页面移出缓冲池，此后该帧不再使用
+ *               调用前需持有latch_
+ * @return {bool} 帧已空闲或回收成功则返回true；帧仍被固定或正在被后台线程写回则返回false
+ * @param {frame_id_t} frame_id 需要回收的帧
+ */
+bool BufferPoolManager::retire_frame(frame_id_t frame_id) {
+    Page *page = &pages_[frame_id];
+    if (page->id_.page_no == INVALID_PAGE_ID) {
+        return true;
+    }
+    int expected = 0;
+    if (flushing_frames_[frame_id] || !page->pin_count_.compare_exchange_strong(expected, Page::PIN_COUNT_EVICTING)) {
+        return false;
+    }
+    replacer_->pin(frame_id);   // 从replacer中移除
+    PageId invalid_id = page->id_;
+    invalid_id.page_no = INVALID_PAGE_ID;
+    update_page(page, invalid_id, frame_id);
+    cold_frames_[frame_id] = 0;
+    return true;
+}
+
 /**
  * @description: 更新页面数据, 如果为脏页则需写入磁盘，再更新为新页面，更新page元数据(data, is_dirty, page_id)和page table
  * @param {Page*} page 写回页指针
  * @param {PageId} new_page_id 新的page_id
  * @param {frame_id_t} new_frame_id 新的帧frame_id
+ * @param {char*} data 若不为nullptr，则新页面的内容直接从data复制（预读时已经读好），不再读磁盘
+ * @param {bool} is_new 新页面是new_page刚分配的页号，其磁盘内容无效（可能是已释放页面的旧数据），保持全0，不读磁盘
+ * 写回脏页失败时帧中仍是原来的页面；读新页面失败时新页面的映射被撤销，帧变为空闲（页号为INVALID_PAGE_ID）
+ * 两种情况下异常都继续抛出，由调用者用return_victim归还帧
  */
-void BufferPoolManager::update_page(Page *page, PageId new_page_id, frame_id_t new_frame_id) {
+void BufferPoolManager::update_page(Page *page, PageId new_page_id, frame_id_t new_frame_id, const char* data,
+                                    bool is_new) {
     if(page->is_dirty()) {  //脏位处理
         this->disk_manager_->write_page(page->get_page_id().fd, page->get_page_id().page_no, page->get_data(), PAGE_SIZE);
         page->is_dirty_ = false;
+        this->write_epoch_++;
     }
 
     page->reset_memory();
 
-    for(auto position = this->page_table_.begin(); position != this->page_table_.end(); position++) {  //更新table
-        if(position->first == page->id_) {
-            this->page_table_.erase(position);
-            break;
+    this->page_table_.erase(page->id_);  //更新table
+    if(page->id_.page_no != INVALID_PAGE_ID) {
+        auto it = this->file_frames_.find(page->id_.fd);
+        it->second.erase(new_frame_id);
+        if(it->second.empty()) {
+            this->file_frames_.erase(it);
         }
     }
-    this->page_table_[new_page_id] = new_frame_id;
+    if(new_page_id.page_no != INVALID_PAGE_ID) {
+        this->page_table_.insert(new_page_id, new_frame_id);
+        this->file_frames_[new_page_id.fd].insert(new_frame_id);
+    }
 
     page->id_ = new_page_id;
-    if(page->id_.page_no != INVALID_PAGE_ID) {
-        this->disk_manager_->read_page(page->get_page_id().fd, page->get_page_id().page_no, page->get_data(), PAGE_SIZE);
+    if(data != nullptr) {
+        memcpy(page->get_data(), data, PAGE_SIZE);
+    } else if(page->id_.page_no != INVALID_PAGE_ID && !is_new) {
+        try {
+            this->disk_manager_->read_page(page->get_page_id().fd, page->get_page_id().page_no, page->get_data(), PAGE_SIZE);
+        } catch (...) {
+            this->page_table_.erase(new_page_id);
+            auto it = this->file_frames_.find(new_page_id.fd);
+            it->second.erase(new_frame_id);
+            if(it->second.empty()) {
+                this->file_frames_.erase(it);
+            }
+            page->id_.page_no = INVALID_PAGE_ID;
+            page->reset_memory();
+            throw;
+        }
     }
     // Todo:
     // 1 如果是脏页，写回磁盘，并且把dirty置为false
@@ -57,26 +170,71 @@ void BufferPoolManager::update_page(Page *page, PageId new_page_id, frame_id_t n
 
 }
 
+/**
+ * @description: 归还find_victim_page选出、但因update_page抛出异常而没能使用的帧，调用前需持有latch_
+ *               帧中仍是原来的页面（写回失败）则放回replacer，脏数据保留，之后可以重试写回；
+ *               帧已空闲（读盘失败，映射已撤销）则放回free_list_
+ * @param {frame_id_t} frame_id find_victim_page选出的帧
+ */
+void BufferPoolManager::return_victim(frame_id_t frame_id) {
+    Page *page = &this->pages_[frame_id];
+    if(page->id_.page_no == INVALID_PAGE_ID) {
+        this->cold_frames_[frame_id] = 0;
+        this->free_list_.push_back(frame_id);
+        return;
+    }
+    page->pin_count_ = 0;
+    if(this->cold_frames_[frame_id]) {
+        this->replacer_->unpin_cold(frame_id);
+    } else {
+        this->replacer_->unpin(frame_id);
+    }
+}
+
 /**
  * @description: 从buffer pool获取需要的页。
  *              如果页表中存在page_id（说明该page在缓冲池中），并且pin_count++。
  *              如果页表不存在page_id（说明该page在磁盘中），则找缓冲池victim page，将其替换为磁盘中读取的page，pin_count置1。
  * @return {Page*} 若获得了需要的页则将其返回，否则返回nullptr
  * @param {PageId} page_id 需要获取的页的PageId
+ * @param {AccessPattern} pattern 访问模式，SEQUENTIAL表示大范围顺序扫描
  */
-Page* BufferPoolManager::fetch_page(PageId page_id) {
+Page* BufferPoolManager::fetch_page(PageId page_id, AccessPattern pattern) {
+    if (disk_manager_->is_mapped(page_id.fd)) {
+        return fetch_mapped_page(page_id, pattern);
+    }
+    if (!shards_.empty()) {
+        return shard_of(page_id)->fetch_page(page_id, pattern);
+    }
+    // 绝大多数访问都命中，先尝试不加锁固定
+    if (Page *page = try_fetch_resident(page_id, pattern)) {
+        return page;
+    }
     std::scoped_lock lock{latch_};
     frame_id_t id;
     int flag=0;
-    if(this->page_table_.find(page_id) != this->page_table_.end()) { //是否在缓冲池
-        id = this->page_table_[page_id];
+    if(this->page_table_.find(page_id, &id)) { //是否在缓冲池
         flag=1;
+        this->num_hits_.fetch_add(1, std::memory_order_relaxed);
     }
     else {
+        this->num_misses_.fetch_add(1, std::memory_order_relaxed);
+        LatencyTimer timer(&this->miss_latency_);
         if(!this->find_victim_page(&id)) {  //找空闲帧或替换
+            this->num_pin_failures_.fetch_add(1, std::memory_order_relaxed);
             return nullptr;
         }
-        this->update_page(&this->pages_[id], page_id, id);
+        try {
+            this->update_page(&this->pages_[id], page_id, id);
+        } catch (...) {
+            this->return_victim(id);
+            throw;
+        }
+        this->cold_frames_[id] = 1;
+    }
+    // 只有顺序扫描读入且未被普通访问命中过的页面才是冷页面
+    if (pattern == AccessPattern::NORMAL) {
+        this->cold_frames_[id] = 0;
     }
 
     this->replacer_->pin(id);
@@ -101,31 +259,141 @@ Page* BufferPoolManager::fetch_page(PageId page_id) {
 }
 
 /**
- * @description: 取消固定pin_count>0的在缓冲池中的page
- * @return {bool} 如果目标页的pin_count<=0则返回false，否则返回true
- * @param {PageId} page_id 目标page的page_id
- * @param {bool} is_dirty 若目标page应该被标记为dirty则为true，否则为false
+ * @description: 只读映射文件的页面不复制到帧中，直接返回指向映射的页面视图，同一页面的多次固定共享一个视图
+ *               顺序扫描时提示内核按顺序预读该文件
+ * @return {Page*} 页面视图，页面超出文件末尾时返回nullptr
+ * @param {PageId} page_id 需要获取的页的PageId
+ * @param {AccessPattern} pattern 访问模式
  */
-bool BufferPoolManager::unpin_page(PageId page_id, bool is_dirty) {
-    if(this->page_table_.find(page_id) == this->page_table_.end()) {  //不存在
-        return false;
+Page* BufferPoolManager::fetch_mapped_page(PageId page_id, AccessPattern pattern) {
+    char *data = disk_manager_->get_mapped_page(page_id.fd, page_id.page_no);
+    if (data == nullptr) {
+        return nullptr;
     }
-    frame_id_t id = this->page_table_[page_id]; //获取id
-    Page* page = &this->pages_[id]; //通过id获取page
+    if (pattern == AccessPattern::SEQUENTIAL) {
+        disk_manager_->advise_sequential(page_id.fd);
+    }
+    MappedShard &shard = mapped_shard_of(page_id);
+    std::scoped_lock lock{shard.latch};
+    auto &page = shard.pages[page_id];
+    if (page == nullptr) {
+        page = std::make_unique<Page>();
+        page->id_ = page_id;
+        page->data_ = data;
+        page->is_mapped_ = true;
+    }
+    page->pin_count_++;
+    return page.get();
+}
 
-    if(page->pin_count_ <= 0) {
+/**
+ * @description: 取消固定一个页面视图，固定计数减到0时释放视图
+ * @return {bool} 视图不存在则返回false
+ */
+bool BufferPoolManager::unpin_mapped_page(PageId page_id) {
+    MappedShard &shard = mapped_shard_of(page_id);
+    std::scoped_lock lock{shard.latch};
+    auto it = shard.pages.find(page_id);
+    if (it == shard.pages.end()) {
         return false;
     }
-    else{
-        page->pin_count_-=1;
+    if (--it->second->pin_count_ == 0) {
+        shard.pages.erase(it);
+    }
+    return true;
+}
+
+/**
+ * @description: 无锁命中路径：不加latch_查页表，用CAS增加pin_count_，不调用replacer
+ *               帧在replacer中时仍留在其中，被选为victim时CAS失败即被丢弃，unpin到0时再放回
+ * @return {Page*} 页面在缓冲池中且固定成功则返回该页面，否则返回nullptr，由调用方走加锁路径
+ * @param {PageId} page_id 需要获取的页的PageId
+ * @param {AccessPattern} pattern 访问模式
+ */
+Page* BufferPoolManager::try_fetch_resident(PageId page_id, AccessPattern pattern) {
+    frame_id_t id;
+    if (!page_table_.find(page_id, &id)) {
+        return nullptr;
+    }
+    Page *page = &pages_[id];
+    int pin_count = page->pin_count_.load();
+    do {
+        if (pin_count == Page::PIN_COUNT_EVICTING) {
+            return nullptr;
+        }
+    } while (!page->pin_count_.compare_exchange_weak(pin_count, pin_count + 1));
+    // 固定之后帧不会再被替换；查表与固定之间帧可能已换成别的页面，需要校验
+    PageId resident_id = page->id_;
+    if (!(resident_id == page_id)) {
+        release_frame(id, resident_id, false);
+        return nullptr;
     }
-    if(page->pin_count_ == 0) {
-        this->replacer_->unpin(id);
+    if (pattern == AccessPattern::NORMAL) {
+        cold_frames_[id] = false;
     }
-    if (is_dirty){
-        page->is_dirty_ = is_dirty;
+    num_hits_.fetch_add(1, std::memory_order_relaxed);
+    return page;
+}
+
+/**
+ * @description: 减少帧的pin_count_，不加latch_；减到0时才加锁把帧交还给replacer
+ * @return {bool} pin_count_原本不大于0则返回false
+ * @param {frame_id_t} frame_id 页面所在的帧，调用方持有该帧的固定
+ * @param {PageId} page_id 帧中的页面
+ * @param {bool} is_dirty 是否把页面标记为脏页
+ */
+bool BufferPoolManager::release_frame(frame_id_t frame_id, PageId page_id, bool is_dirty) {
+    Page *page = &pages_[frame_id];
+    // 必须在减少计数之前置脏：淘汰者看到计数为0时一定能看到脏位
+    if (is_dirty) {
+        page->is_dirty_ = true;
+    }
+    int pin_count = page->pin_count_.load();
+    do {
+        if (pin_count <= 0) {
+            return false;
+        }
+    } while (!page->pin_count_.compare_exchange_weak(pin_count, pin_count - 1));
+    if (pin_count == 1) {
+        std::scoped_lock lock{latch_};
+        // 加锁前帧可能已被重新固定，或被淘汰后装入了别的页面，这两种情况都由新的持有者处理replacer
+        if (page->pin_count_ == 0 && page->id_ == page_id) {
+            if (static_cast<size_t>(frame_id) >= pool_size_ && retire_frame(frame_id)) {
+                // 缩容时仍被固定的帧在最后一次unpin时回收
+                madvise(page->get_data(), PAGE_SIZE, MADV_DONTNEED);
+            } else if (cold_frames_[frame_id]) {
+                replacer_->unpin_cold(frame_id);
+            } else {
+                replacer_->unpin(frame_id);
+            }
+        }
     }
     return true;
+}
+
+/**
+ * @description: 取消固定pin_count>0的在缓冲池中的page
+ * @return {bool} 如果目标页的pin_count<=0则返回false，否则返回true
+ * @param {PageId} page_id 目标page的page_id
+ * @param {bool} is_dirty 若目标page应该被标记为dirty则为true，否则为false
+ */
+bool BufferPoolManager::unpin_page(PageId page_id, bool is_dirty) {
+    if (disk_manager_->is_mapped(page_id.fd)) {
+        return unpin_mapped_page(page_id);
+    }
+    if (!shards_.empty()) {
+        return shard_of(page_id)->unpin_page(page_id, is_dirty);
+    }
+    // 无锁查表可能返回其他帧的帧号，因此按PageId unpin时在latch_下查表；已持有Page*时应使用无锁的重载
+    frame_id_t id;
+    {
+        std::scoped_lock lock{latch_};
+        if(!this->page_table_.find(page_id, &id)) {  //不存在
+            return false;
+        }
+    }
+    // 调用方持有固定，释放latch_后帧也不会被替换
+    return this->release_frame(id, page_id, is_dirty);
     // Todo:
     // 0. lock latch
     // 1. 尝试在page_table_中搜寻page_id对应的页P
@@ -137,22 +405,49 @@ bool BufferPoolManager::unpin_page(PageId page_id, bool is_dirty) {
     // 3 根据参数is_dirty，更改P的is_dirty_
 }
 
+/**
+ * @description: 取消固定调用方持有的页面，直接由Page*得到帧号，整个过程不查页表，只有计数减到0时才加锁
+ * @return {bool} 如果目标页的pin_count<=0则返回false，否则返回true
+ * @param {Page*} page 调用方固定的页面，由fetch_page/new_page返回
+ * @param {bool} is_dirty 若目标page应该被标记为dirty则为true，否则为false
+ */
+bool BufferPoolManager::unpin_page(Page* page, bool is_dirty) {
+    if (page->is_mapped()) {
+        return unpin_mapped_page(page->get_page_id());
+    }
+    if (!shards_.empty()) {
+        return shard_of(page->get_page_id())->unpin_page(page, is_dirty);
+    }
+    return release_frame(static_cast<frame_id_t>(page - pages_), page->get_page_id(), is_dirty);
+}
+
 /**
  * @description: 将目标页写回磁盘，不考虑当前页面是否正在被使用
  * @return {bool} 成功则返回true，否则返回false(只有page_table_中没有目标页时)
  * @param {PageId} page_id 目标页的page_id，不能为INVALID_PAGE_ID
  */
 bool BufferPoolManager::flush_page(PageId page_id) {
-    std::scoped_lock lock{latch_};
+    if (!shards_.empty()) {
+        return shard_of(page_id)->flush_page(page_id);
+    }
+    std::unique_lock lock{latch_};
 
-    if(this->page_table_.find(page_id) == this->page_table_.end()) {
-        return false;
+    frame_id_t id;
+    while (true) {
+        if(!this->page_table_.find(page_id, &id)) {
+            return false;
+        }
+        if (!this->flushing_frames_[id]) {
+            break;
+        }
+        // 后台线程写回的是较早的副本，须等它完成再写，否则它可能晚于本次写入落盘，覆盖较新的内容
+        this->io_cv_.wait(lock);
     }
-    frame_id_t id = this->page_table_[page_id]; //获取id
     Page* page = &this->pages_[id]; //通过id获取page
 
     this->disk_manager_->write_page(page->get_page_id().fd, page->get_page_id().page_no, page->get_data(), PAGE_SIZE);
     page->is_dirty_ = false;
+    this->write_epoch_++;
     return true;
     // Todo:
     // 0. lock latch
@@ -168,19 +463,38 @@ bool BufferPoolManager::flush_page(PageId page_id) {
  * @param {PageId*} page_id 当成功创建一个新的page时存储其page_id
  */
 Page* BufferPoolManager::new_page(PageId* page_id) {
+    if (disk_manager_->is_mapped(page_id->fd)) {
+        throw InternalError("BufferPoolManager::new_page: file is opened read-only");
+    }
+    if (!shards_.empty()) {
+        // 分片由PageId决定，因此先分配页号再交给对应分片
+        page_id->page_no = disk_manager_->allocate_page(page_id->fd);
+        Page *page = nullptr;
+        try {
+            page = shard_of(*page_id)->create_page(*page_id);
+        } catch (...) {
+            disk_manager_->deallocate_page(page_id->fd, page_id->page_no);  // 写回victim失败，归还刚分配的页号
+            throw;
+        }
+        if (page == nullptr) {
+            disk_manager_->deallocate_page(page_id->fd, page_id->page_no);  // 没有可用帧，归还刚分配的页号
+        }
+        return page;
+    }
     std::scoped_lock lock{latch_};
 
     frame_id_t id;
-    if(this->find_victim_page(&id)) {  //找到一个位置
-        page_id->page_no = this->disk_manager_->allocate_page(page_id->fd); //获取编号
-        this->update_page(&this->pages_[id], *page_id, id);  //更新page
-        this->replacer_->pin(id);
-        this->pages_[id].pin_count_ = 1;
-
-    } else {
+    if(!this->find_victim_page(&id)) {  //没有可用帧时不分配页号
+        this->num_pin_failures_.fetch_add(1, std::memory_order_relaxed);
         return nullptr;
     }
-    return &this->pages_[id];
+    page_id->page_no = this->disk_manager_->allocate_page(page_id->fd); //获取编号
+    try {
+        return this->install_new_page(id, *page_id);
+    } catch (...) {
+        this->disk_manager_->deallocate_page(page_id->fd, page_id->page_no);
+        throw;
+    }
 
     // 1.   获得一个可用的frame，若无法获得则返回nullptr
     // 2.   在fd对应的文件分配一个新的page_id
@@ -190,22 +504,125 @@ Page* BufferPoolManager::new_page(PageId* page_id) {
 }
 
 /**
- * @description: 从buffer_pool删除目标页
+ * @description: 获取页面并返回只负责unpin的守卫，不加页面锁
+ * @return {BasicPageGuard} 没有可用帧时返回无效的守卫
+ */
+BasicPageGuard BufferPoolManager::fetch_page_basic(PageId page_id, AccessPattern pattern) {
+    return BasicPageGuard(this, fetch_page(page_id, pattern));
+}
+
+/**
+ * @description: 获取页面并加读锁。等待页面锁时不持有latch_，避免持有写锁的线程无法访问缓冲池
+ * @return {ReadPageGuard} 没有可用帧时返回无效的守卫
+ */
+ReadPageGuard BufferPoolManager::fetch_page_read(PageId page_id, AccessPattern pattern) {
+    Page *page = fetch_page(page_id, pattern);
+    if (page == nullptr) {
+        return ReadPageGuard();
+    }
+    page->rlatch();
+    return ReadPageGuard(this, page);
+}
+
+/**
+ * @description: 获取页面并加写锁，守卫释放时页面被标记为脏页
+ * @return {WritePageGuard} 没有可用帧时返回无效的守卫
+ */
+WritePageGuard BufferPoolManager::fetch_page_write(PageId page_id, AccessPattern pattern) {
+    if (disk_manager_->is_mapped(page_id.fd)) {
+        throw InternalError("BufferPoolManager::fetch_page_write: file is opened read-only");
+    }
+    Page *page = fetch_page(page_id, pattern);
+    if (page == nullptr) {
+        return WritePageGuard();
+    }
+    page->wlatch();
+    return WritePageGuard(this, page);
+}
+
+/**
+ * @description: 创建新页面并返回只负责unpin的守卫
+ */
+BasicPageGuard BufferPoolManager::new_page_basic(PageId* page_id) {
+    BasicPageGuard guard(this, new_page(page_id));
+    guard.mark_dirty();
+    return guard;
+}
+
+/**
+ * @description: 创建新页面并加写锁
+ */
+WritePageGuard BufferPoolManager::new_page_write(PageId* page_id) {
+    Page *page = new_page(page_id);
+    if (page == nullptr) {
+        return WritePageGuard();
+    }
+    page->wlatch();
+    return WritePageGuard(this, page);
+}
+
+/**
+ * @description: 分片模式下使用，在本分片中为已分配好页号的新页面找到一个帧并固定
+ * @return {Page*} 返回新创建的page，若没有可用帧则返回nullptr
+ * @param {PageId} page_id 已由disk_manager_分配好页号的PageId
+ */
+Page* BufferPoolManager::create_page(PageId page_id) {
+    std::scoped_lock lock{latch_};
+
+    frame_id_t id;
+    if(!this->find_victim_page(&id)) {
+        this->num_pin_failures_.fetch_add(1, std::memory_order_relaxed);
+        return nullptr;
+    }
+    return this->install_new_page(id, page_id);
+}
+
+/**
+ * @description: 把find_victim_page选出的帧装入一个新页面并固定，调用前需持有latch_
+ *               update_page失败时帧由return_victim归还，异常继续抛给调用者，由调用者归还页号
+ * @return {Page*} 装入新页面的帧
+ * @param {frame_id_t} frame_id find_victim_page选出的帧
+ * @param {PageId} page_id 已分配好页号的PageId
+ */
+Page* BufferPoolManager::install_new_page(frame_id_t frame_id, PageId page_id) {
+    Page *page = &this->pages_[frame_id];
+    try {
+        this->update_page(page, page_id, frame_id, nullptr, true);  //更新page，新页面内容全0
+    } catch (...) {
+        this->return_victim(frame_id);
+        throw;
+    }
+    page->is_dirty_ = true;  //新页面在磁盘上还不存在，必须写回
+    this->cold_frames_[frame_id] = 0;
+    this->replacer_->pin(frame_id);
+    page->pin_count_ = 1;
+    return page;
+}
+
+/**
+ * @description: 从buffer_pool删除目标页，并在磁盘文件中释放该页面，之后new_page可以复用其页号
  * @return {bool} 如果目标页不存在于buffer_pool或者成功被删除则返回true，若其存在于buffer_pool但无法删除则返回false
  * @param {PageId} page_id 目标页
  */
 bool BufferPoolManager::delete_page(PageId page_id) {
+    if (!shards_.empty()) {
+        return shard_of(page_id)->delete_page(page_id);
+    }
     std::scoped_lock lock{latch_};
 
-    if(this->page_table_.find(page_id) == this->page_table_.end()) {
+    frame_id_t id;
+    if(!this->page_table_.find(page_id, &id)) {
+        this->disk_manager_->deallocate_page(page_id.fd, page_id.page_no);
         return true;
     }
-    frame_id_t id = this->page_table_[page_id];
     Page* page = &this->pages_[id];
-    if(page->pin_count_ != 0) {  //还在被使用，不能删除
-        return false;
+    int expected = 0;
+    if(flushing_frames_[id] || !page->pin_count_.compare_exchange_strong(expected, Page::PIN_COUNT_EVICTING)) {
+        return false;  //还在被使用或正在写回，不能删除
     }
-    this->disk_manager_->deallocate_page(page->get_page_id().page_no);
+    this->disk_manager_->deallocate_page(page_id.fd, page_id.page_no);
+    this->replacer_->pin(id);  //帧进入free_list_，从replacer中移除，否则之后可能被当作victim重复选中
+    page->is_dirty_ = false;  //页面已被释放，不需要写回
     page_id.page_no = INVALID_PAGE_ID;
     this->update_page(page, page_id, id); //包含page table处理
     this->free_list_.push_back(id);
@@ -217,16 +634,611 @@ bool BufferPoolManager::delete_page(PageId page_id) {
 }
 
 /**
- * @description: 将buffer_pool中的所有页写回到磁盘
+ * @description: 将buffer_pool中属于指定文件的脏页写回到磁盘
+ *              只检查file_frames_中该文件的帧，按页号排序后把页号连续的页面合并为一次写盘
+ *              仍被固定的页面可能正在被修改且尚未unpin标脏，因此也一并写回
  * @param {int} fd 文件句柄
  */
 void BufferPoolManager::flush_all_pages(int fd) {
-std::scoped_lock lock{latch_};
-    for (size_t i = 0; i < pool_size_; i++) {
-        Page *page = &this->pages_[i];
-        if (page->get_page_id().fd == fd && page->get_page_id().page_no != INVALID_PAGE_ID) {
-            disk_manager_->write_page(page->get_page_id().fd, page->get_page_id().page_no, page->get_data(), PAGE_SIZE);
-            page->is_dirty_ = false;
+    std::vector<Page*> pages;
+    std::vector<std::unique_lock<std::mutex>> locks;
+    std::vector<BufferPoolManager*> parts;
+    if (!shards_.empty()) {
+        for (auto &shard : shards_) {
+            parts.push_back(shard.get());
+        }
+    } else {
+        parts.push_back(this);
+    }
+    // 后台线程写回的是较早的副本，须等它们完成再写，否则它们可能晚于本次写入落盘
+    // 相邻页号分散在不同分片中，需要同时持有所有分片的latch_，合并后统一排序写盘；
+    // 等待时只持有一个分片的latch_（异步写回的回调需要获取其所在分片的latch_），全部加锁后若又有新的写回则重试
+    while (true) {
+        for (auto *part : parts) {
+            std::unique_lock lock{part->latch_};
+            part->io_cv_.wait(lock, [part, fd] { return !part->has_flushing_frames(fd); });
+        }
+        bool flushing = false;
+        for (auto *part : parts) {
+            locks.emplace_back(part->latch_);
+            flushing = flushing || part->has_flushing_frames(fd);
+        }
+        if (!flushing) {
+            break;
+        }
+        locks.clear();
+    }
+    for (auto *part : parts) {
+        part->collect_flush_pages(fd, &pages);
+    }
+    if (pages.empty()) {
+        return;
+    }
+    std::sort(pages.begin(), pages.end(),
+              [](Page *a, Page *b) { return a->get_page_id().page_no < b->get_page_id().page_no; });
+    std::vector<std::pair<page_id_t, const char*>> batch;
+    batch.reserve(pages.size());
+    for (Page *page : pages) {
+        batch.emplace_back(page->get_page_id().page_no, page->get_data());
+    }
+    disk_manager_->write_pages(fd, batch);
+    for (Page *page : pages) {
+        page->is_dirty_ = false;
+    }
+    if (!shards_.empty()) {
+        for (auto &shard : shards_) {
+            shard->write_epoch_++;
         }
+    } else {
+        write_epoch_++;
     }
-}
\ No newline at end of file
+}
+
+/**
+ * @description: 收集本分片中属于指定文件、需要写回的页面（脏页或仍被固定的页面），调用前需持有latch_
+ * @param {int} fd 文件句柄
+ * @param {vector<Page*>*} pages 收集结果追加到pages中
+ */
+void BufferPoolManager::collect_flush_pages(int fd, std::vector<Page*>* pages) {
+    auto it = file_frames_.find(fd);
+    if (it == file_frames_.end()) {
+        return;
+    }
+    for (frame_id_t id : it->second) {
+        Page *page = &pages_[id];
+        if (page->is_dirty() || page->pin_count_ > 0) {
+            pages->push_back(page);
+        }
+    }
+}
+
+/**
+ * @description: 启动后台刷脏线程
+ * @param {size_t} clean_watermark 希望保持的干净可淘汰帧数量，分片模式下平均分给各个分片
+ * @param {milliseconds} interval 后台线程两次检查之间的间隔
+ */
+void BufferPoolManager::start_flusher(size_t clean_watermark, std::chrono::milliseconds interval) {
+    if (!shards_.empty()) {
+        for (auto &shard : shards_) {
+            shard->start_flusher((clean_watermark + shards_.size() - 1) / shards_.size(), interval);
+        }
+        return;
+    }
+    if (flusher_running_.exchange(true)) {
+        return;
+    }
+    {
+        std::scoped_lock lock{latch_};
+        clean_watermark_ = clean_watermark;
+        flush_interval_ = interval;
+    }
+    flusher_ = std::thread(&BufferPoolManager::flusher_loop, this);
+}
+
+/**
+ * @description: 停止后台刷脏线程，等待其退出
+ */
+void BufferPoolManager::stop_flusher() {
+    if (!shards_.empty()) {
+        for (auto &shard : shards_) {
+            shard->stop_flusher();
+        }
+        return;
+    }
+    if (!flusher_running_.exchange(false)) {
+        return;
+    }
+    flusher_cv_.notify_all();
+    flusher_.join();
+}
+
+/**
+ * @description: 调整干净帧水位线
+ * @param {size_t} clean_watermark 希望保持的干净可淘汰帧数量
+ */
+void BufferPoolManager::set_clean_watermark(size_t clean_watermark) {
+    if (!shards_.empty()) {
+        for (auto &shard : shards_) {
+            shard->set_clean_watermark((clean_watermark + shards_.size() - 1) / shards_.size());
+        }
+        return;
+    }
+    std::scoped_lock lock{latch_};
+    clean_watermark_ = clean_watermark;
+}
+
+size_t BufferPoolManager::get_num_evictions() {
+    size_t total = num_evictions_;
+    for (auto &shard : shards_) {
+        total += shard->get_num_evictions();
+    }
+    return total;
+}
+
+size_t BufferPoolManager::get_num_dirty_evictions() {
+    size_t total = num_dirty_evictions_;
+    for (auto &shard : shards_) {
+        total += shard->get_num_dirty_evictions();
+    }
+    return total;
+}
+
+size_t BufferPoolManager::get_num_background_writes() {
+    size_t total = num_background_writes_;
+    for (auto &shard : shards_) {
+        total += shard->get_num_background_writes();
+    }
+    return total;
+}
+
+/**
+ * @description: 在线调整缓冲池的帧数，不超过构造时指定的max_pool_size
+ *               扩容把新范围内空闲的帧加入free_list_，尚未回收、仍存放着页面的帧直接恢复为普通帧；
+ *               缩容先禁止编号不小于新大小的帧装入新页面，再逐帧回收一遍（每帧只短暂持有latch_），不等待：
+ *               仍被固定的帧在最后一次unpin时由release_frame回收，正在被后台写回的帧在之后被选为victim时回收，
+ *               被固定的页面不会丢失；已回收帧的物理内存立即归还给操作系统
+ *               分片模式下新大小平均分给各个分片
+ * @return {bool} 新大小为0、小于分片数或超过上限时返回false
+ * @param {size_t} pool_size 新的帧数
+ */
+bool BufferPoolManager::resize(size_t pool_size) {
+    std::scoped_lock resize_lock{resize_latch_};
+    if (pool_size == 0 || pool_size > max_pool_size_ || pool_size < get_num_shards()) {
+        return false;
+    }
+    if (!shards_.empty()) {
+        for (size_t i = 0; i < shards_.size(); i++) {
+            shards_[i]->resize(shard_share(pool_size, shards_.size(), i));
+        }
+        pool_size_ = pool_size;
+        return true;
+    }
+    size_t old_size;
+    {
+        std::scoped_lock lock{latch_};
+        old_size = pool_size_;
+        if (pool_size >= old_size) {
+            for (size_t i = old_size; i < pool_size; i++) {
+                if (pages_[i].id_.page_no == INVALID_PAGE_ID) {
+                    free_list_.emplace_back(static_cast<frame_id_t>(i));
+                }
+            }
+            pool_size_ = pool_size;
+            return true;
+        }
+        // 此后find_victim_page不会把编号不小于pool_size的帧交给新页面
+        pool_size_ = pool_size;
+        free_list_.remove_if([pool_size](frame_id_t id) { return static_cast<size_t>(id) >= pool_size; });
+    }
+    // 连续回收成功的帧一起归还物理内存
+    size_t run_start = pool_size;
+    for (size_t i = pool_size; i <= old_size; i++) {
+        bool retired = false;
+        if (i < old_size) {
+            std::scoped_lock lock{latch_};
+            // 期间又扩容时，这些帧已恢复为普通帧，不能再回收
+            retired = i >= pool_size_ && retire_frame(static_cast<frame_id_t>(i));
+        }
+        if (!retired) {
+            if (i > run_start) {
+                madvise(frame_data_ + run_start * PAGE_SIZE, (i - run_start) * PAGE_SIZE, MADV_DONTNEED);
+            }
+            run_start = i + 1;
+        }
+    }
+    return true;
+}
+
+/**
+ * @description: 获取当前的帧数
+ */
+size_t BufferPoolManager::get_pool_size() {
+    if (!shards_.empty()) {
+        size_t total = 0;
+        for (auto &shard : shards_) {
+            total += shard->get_pool_size();
+        }
+        return total;
+    }
+    std::scoped_lock lock{latch_};
+    return pool_size_;
+}
+
+/**
+ * @description: 后台刷脏线程主循环，定期或在前台淘汰脏页时被唤醒
+ */
+void BufferPoolManager::flusher_loop() {
+    while (flusher_running_) {
+        {
+            std::unique_lock lock{latch_};
+            flusher_cv_.wait_for(lock, flush_interval_);
+        }
+        if (!flusher_running_) {
+            break;
+        }
+        flush_victim_candidates();
+    }
+}
+
+/**
+ * @description: 若干净的可淘汰帧少于水位线，则按(fd, page_no)顺序写回一批未固定的脏页
+ *               写盘时不持有latch_，写回期间的帧标记在flushing_frames_中，不会被淘汰或删除
+ *               DiskManager启用了异步后端时只提交写请求，写完成后在回调中清除flushing_frames_
+ */
+void BufferPoolManager::flush_victim_candidates() {
+    std::vector<frame_id_t> batch;
+    {
+        std::scoped_lock lock{latch_};
+        size_t clean = free_list_.size();
+        for (size_t i = 0; i < pool_size_; i++) {
+            Page *page = &pages_[i];
+            if (page->pin_count_ != 0 || page->id_.page_no == INVALID_PAGE_ID || flushing_frames_[i]) {
+                continue;
+            }
+            if (page->is_dirty()) {
+                batch.push_back(static_cast<frame_id_t>(i));
+            } else {
+                clean++;
+            }
+        }
+        if (clean >= clean_watermark_ || batch.empty()) {
+            return;
+        }
+        // 同一文件按页号递增写回，使写盘尽量顺序
+        std::sort(batch.begin(), batch.end(), [this](frame_id_t a, frame_id_t b) {
+            const PageId &x = pages_[a].id_;
+            const PageId &y = pages_[b].id_;
+            return x.fd != y.fd ? x.fd < y.fd : x.page_no < y.page_no;
+        });
+        if (batch.size() > clean_watermark_ - clean) {
+            batch.resize(clean_watermark_ - clean);
+        }
+        // 先清除脏位：写盘期间若页面又被修改，unpin时会重新置脏
+        for (frame_id_t id : batch) {
+            flushing_frames_[id] = 1;
+            pages_[id].is_dirty_ = false;
+        }
+    }
+
+    // 在页面读锁下把页面复制到按页对齐的暂存区，避免写出持有写锁的线程修改到一半的页面；
+    // 一次只持有一个页面锁，再按文件批量写回，页号连续的页面合并为一次写盘
+    auto buf = std::make_shared<std::vector<char>>((batch.size() + 1) * PAGE_SIZE);
+    char *staging = buf->data() + (PAGE_SIZE - reinterpret_cast<uintptr_t>(buf->data()) % PAGE_SIZE) % PAGE_SIZE;
+    std::vector<std::pair<page_id_t, const char *>> file_batch;
+    std::vector<frame_id_t> file_frames;
+    for (size_t i = 0; i < batch.size(); i++) {
+        Page *page = &pages_[batch[i]];
+        char *copy = staging + i * PAGE_SIZE;
+        page->rlatch();
+        memcpy(copy, page->get_data(), PAGE_SIZE);
+        page->runlatch();
+        file_batch.emplace_back(page->id_.page_no, copy);
+        file_frames.push_back(batch[i]);
+        if (i + 1 < batch.size() && pages_[batch[i + 1]].id_.fd == page->id_.fd) {
+            continue;
+        }
+        {
+            std::scoped_lock lock{latch_};
+            num_async_ios_++;
+        }
+        disk_manager_->async_write_pages(page->id_.fd, file_batch, [this, buf, file_frames](bool ok) {
+            std::scoped_lock lock{latch_};
+            for (frame_id_t id : file_frames) {
+                flushing_frames_[id] = 0;
+                if (!ok) {
+                    pages_[id].is_dirty_ = true;    // 写盘失败，留给之后的刷盘或淘汰重试
+                }
+            }
+            if (ok) {
+                num_background_writes_ += file_frames.size();
+            }
+            write_epoch_++;
+            num_async_ios_--;
+            io_cv_.notify_all();
+        });
+        file_batch.clear();
+        file_frames.clear();
+    }
+}
+
+/**
+ * @description: 本分片中是否有属于指定文件、正在被后台线程写回的帧，调用前需持有latch_
+ */
+bool BufferPoolManager::has_flushing_frames(int fd) {
+    auto it = file_frames_.find(fd);
+    if (it == file_frames_.end()) {
+        return false;
+    }
+    for (frame_id_t id : it->second) {
+        if (flushing_frames_[id]) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @description: 等待已提交的异步预读和写回全部完成，析构前调用，因为它们的回调会访问本对象
+ */
+void BufferPoolManager::wait_async_ios() {
+    std::unique_lock lock{latch_};
+    io_cv_.wait(lock, [this] { return num_async_ios_ == 0; });
+}
+
+/**
+ * @description: 异步预读fd对应文件中的一段连续页面，调用立即返回
+ * @param {int} fd 文件句柄
+ * @param {page_id_t} start_page_no 预读的起始页号
+ * @param {int} num_pages 预读的页面数量
+ */
+void BufferPoolManager::prefetch(int fd, page_id_t start_page_no, int num_pages) {
+    if (start_page_no == INVALID_PAGE_ID || num_pages <= 0) {
+        return;
+    }
+    if (disk_manager_->is_mapped(fd)) {
+        // 映射文件的页面不进入缓冲池，改为提示内核把这段页面读入页缓存
+        disk_manager_->advise_willneed(fd, start_page_no, num_pages);
+        return;
+    }
+    std::scoped_lock lock{prefetch_latch_};
+    if (!prefetcher_running_) {
+        prefetcher_running_ = true;
+        prefetcher_ = std::thread(&BufferPoolManager::prefetcher_loop, this);
+    }
+    prefetch_queue_.push_back({fd, start_page_no, num_pages});
+    prefetch_cv_.notify_one();
+}
+
+/**
+ * @description: 异步预读fd对应文件中的一组页面，页号排序去重后把连续的页面合并为一个预读请求，调用立即返回
+ * @param {int} fd 文件句柄
+ * @param {vector<page_id_t>} page_nos 需要预读的页号，不要求有序
+ */
+void BufferPoolManager::prefetch_pages(int fd, std::vector<page_id_t> page_nos) {
+    std::sort(page_nos.begin(), page_nos.end());
+    page_nos.erase(std::unique(page_nos.begin(), page_nos.end()), page_nos.end());
+    size_t run_start = 0;
+    while (run_start < page_nos.size()) {
+        size_t run_end = run_start + 1;
+        while (run_end < page_nos.size() && page_nos[run_end] == page_nos[run_end - 1] + 1) {
+            run_end++;
+        }
+        if (page_nos[run_start] >= 0) {
+            prefetch(fd, page_nos[run_start], static_cast<int>(run_end - run_start));
+        }
+        run_start = run_end;
+    }
+}
+
+/**
+ * @description: 获取当前缓冲池中所有页面的PageId，关闭数据库时据此记录需要在重启后预热的页面
+ * @return {vector<PageId>} 缓冲池中的页面，顺序不确定
+ */
+std::vector<PageId> BufferPoolManager::get_resident_pages() {
+    std::vector<PageId> result;
+    if (!shards_.empty()) {
+        for (auto &shard : shards_) {
+            std::vector<PageId> pages = shard->get_resident_pages();
+            result.insert(result.end(), pages.begin(), pages.end());
+        }
+        return result;
+    }
+    std::scoped_lock lock{latch_};
+    for (size_t i = 0; i < max_pool_size_; i++) {
+        frame_id_t id;
+        if (pages_[i].id_.page_no != INVALID_PAGE_ID && page_table_.find(pages_[i].id_, &id) &&
+            id == static_cast<frame_id_t>(i)) {
+            result.push_back(pages_[i].id_);
+        }
+    }
+    return result;
+}
+
+/**
+ * @description: 停止预读线程，未处理的预读请求直接丢弃
+ */
+void BufferPoolManager::stop_prefetcher() {
+    {
+        std::scoped_lock lock{prefetch_latch_};
+        if (!prefetcher_running_) {
+            return;
+        }
+        prefetcher_running_ = false;
+        prefetch_queue_.clear();
+    }
+    prefetch_cv_.notify_all();
+    prefetcher_.join();
+}
+
+/**
+ * @description: 预读线程主循环，请求范围内不在缓冲池中的页面交给async_read_pages批量读取，连续的页面合并为一次读盘
+ *               DiskManager启用了异步后端时提交后即处理下一个请求，多个预读请求的读盘可以重叠，读完后在回调中放入缓冲池
+ */
+void BufferPoolManager::prefetcher_loop() {
+    while (true) {
+        PrefetchRequest req;
+        {
+            std::unique_lock lock{prefetch_latch_};
+            prefetch_cv_.wait(lock, [this] { return !prefetcher_running_ || !prefetch_queue_.empty(); });
+            if (!prefetcher_running_) {
+                return;
+            }
+            req = prefetch_queue_.front();
+            prefetch_queue_.pop_front();
+        }
+        // 多申请一页用于把读缓冲区按页对齐，满足O_DIRECT的要求
+        auto buf = std::make_shared<std::vector<char>>(static_cast<size_t>(req.num_pages + 1) * PAGE_SIZE);
+        char *data = buf->data() + (PAGE_SIZE - reinterpret_cast<uintptr_t>(buf->data()) % PAGE_SIZE) % PAGE_SIZE;
+        std::vector<std::pair<page_id_t, char *>> batch;
+        std::vector<uint64_t> epochs;
+        for (page_id_t page_no = req.start_page_no; page_no < req.start_page_no + req.num_pages; page_no++) {
+            if (!is_resident({req.fd, page_no})) {
+                batch.emplace_back(page_no, data + batch.size() * PAGE_SIZE);
+                epochs.push_back(get_write_epoch({req.fd, page_no}));
+            }
+        }
+        if (batch.empty()) {
+            continue;
+        }
+        {
+            std::scoped_lock lock{latch_};
+            num_async_ios_++;
+        }
+        int fd = req.fd;
+        disk_manager_->async_read_pages(fd, batch, [this, fd, buf, batch, epochs = std::move(epochs)](bool ok) {
+            for (size_t i = 0; ok && i < batch.size(); i++) {
+                install_page({fd, batch[i].first}, batch[i].second, epochs[i]);
+            }
+            std::scoped_lock lock{latch_};
+            num_async_ios_--;
+            io_cv_.notify_all();
+        });
+    }
+}
+
+/**
+ * @description: 判断目标页是否已在缓冲池中
+ */
+bool BufferPoolManager::is_resident(PageId page_id) {
+    if (!shards_.empty()) {
+        return shard_of(page_id)->is_resident(page_id);
+    }
+    std::scoped_lock lock{latch_};
+    frame_id_t id;
+    return page_table_.find(page_id, &id);
+}
+
+/**
+ * @description: 获取目标页所属分片的写回计数
+ */
+uint64_t BufferPoolManager::get_write_epoch(PageId page_id) {
+    if (!shards_.empty()) {
+        return shard_of(page_id)->get_write_epoch(page_id);
+    }
+    return write_epoch_;
+}
+
+/**
+ * @description: 把预读好的页面放入缓冲池，不固定该页面
+ *               预读的页面标记为冷页面并直接放到replacer的冷端，被访问前先于已有页面淘汰；消费者用完unpin后仍放到冷端
+ * @param {PageId} page_id 预读的页面
+ * @param {char*} data 页面内容
+ * @param {uint64_t} write_epoch 读盘前的写回计数，读盘期间有页面写回则放弃本页，避免放入过期内容
+ */
+void BufferPoolManager::install_page(PageId page_id, const char* data, uint64_t write_epoch) {
+    if (!shards_.empty()) {
+        shard_of(page_id)->install_page(page_id, data, write_epoch);
+        return;
+    }
+    std::scoped_lock lock{latch_};
+    frame_id_t id;
+    if (page_table_.find(page_id, &id) || write_epoch_ != write_epoch) {
+        return;
+    }
+    if (!find_victim_page(&id)) {
+        return;
+    }
+    try {
+        update_page(&pages_[id], page_id, id, data);
+    } catch (...) {
+        return_victim(id);  // 预读只是优化，写回victim失败时放弃本页
+        return;
+    }
+    cold_frames_[id] = 1;
+    pages_[id].pin_count_ = 0;
+    replacer_->unpin_cold(id);  // 预读的页面还没有被访问过，放在冷端，预读过多时先淘汰它们
+    num_prefetched_.fetch_add(1, std::memory_order_relaxed);
+}
+
+/**
+ * @description: 把另一个分片的统计信息累加到本统计中
+ */
+void BufferPoolStats::merge(const BufferPoolStats &other) {
+    pool_size += other.pool_size;
+    free_frames += other.free_frames;
+    dirty_frames += other.dirty_frames;
+    pinned_frames += other.pinned_frames;
+    hits += other.hits;
+    misses += other.misses;
+    pin_failures += other.pin_failures;
+    evictions += other.evictions;
+    dirty_evictions += other.dirty_evictions;
+    background_writes += other.background_writes;
+    prefetched_pages += other.prefetched_pages;
+    for (size_t i = 0; i < LatencyHistogram::NUM_BUCKETS; i++) {
+        miss_latency[i] += other.miss_latency[i];
+    }
+}
+
+/**
+ * @description: 获取整个缓冲池的统计信息，分片模式下为所有分片之和
+ */
+BufferPoolStats BufferPoolManager::get_stats() {
+    BufferPoolStats total;
+    for (auto &stats : get_shard_stats()) {
+        total.merge(stats);
+    }
+    return total;
+}
+
+/**
+ * @description: 获取每个分片的统计信息，非分片模式下只有一项，用于观察负载是否在分片间倾斜
+ */
+std::vector<BufferPoolStats> BufferPoolManager::get_shard_stats() {
+    std::vector<BufferPoolStats> result;
+    if (shards_.empty()) {
+        result.push_back(collect_stats());
+    }
+    for (auto &shard : shards_) {
+        result.push_back(shard->collect_stats());
+    }
+    return result;
+}
+
+/**
+ * @description: 读取本分片的计数器；帧的状态需要短暂持有latch_统计
+ */
+BufferPoolStats BufferPoolManager::collect_stats() {
+    BufferPoolStats stats;
+    stats.hits = num_hits_.load(std::memory_order_relaxed);
+    stats.misses = num_misses_.load(std::memory_order_relaxed);
+    stats.pin_failures = num_pin_failures_.load(std::memory_order_relaxed);
+    stats.evictions = num_evictions_.load(std::memory_order_relaxed);
+    stats.dirty_evictions = num_dirty_evictions_.load(std::memory_order_relaxed);
+    stats.background_writes = num_background_writes_.load(std::memory_order_relaxed);
+    stats.prefetched_pages = num_prefetched_.load(std::memory_order_relaxed);
+    miss_latency_.add_to(&stats.miss_latency);
+
+    std::scoped_lock lock{latch_};
+    stats.pool_size = pool_size_;
+    stats.free_frames = free_list_.size();
+    for (size_t i = 0; i < max_pool_size_; i++) {
+        if (pages_[i].is_dirty()) {
+            stats.dirty_frames++;
+        }
+        if (pages_[i].pin_count_ > 0) {
+            stats.pinned_frames++;
+        }
+    }
+    return stats;
+}
@@ -0,0 +1,295 @@
+#pragma once
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "disk_manager.h"
+#include "errors.h"
+#include "latency_histogram.h"
+#include "page.h"
+#include "page_guard.h"
+#include "page_table.h"
+#include "replacer/clock_replacer.h"
+#include "replacer/lru_k_replacer.h"
+#include "replacer/lru_replacer.h"
+#include "replacer/replacer.h"
+
+/* 页面访问模式，顺序扫描使用SEQUENTIAL，扫描新读入的页面在unpin后最先被淘汰 */
+enum class AccessPattern { NORMAL, SEQUENTIAL };
+
+/* 一次预读请求：读入fd对应文件中[start_page_no, start_page_no + num_pages)范围内不在缓冲池中的页面 */
+struct PrefetchRequest {
+    int fd;
+    page_id_t start_page_no;
+    int num_pages;
+};
+
+/* 缓冲池（或其中一个分片）的统计信息，由get_stats()/get_shard_stats()生成 */
+struct BufferPoolStats {
+    size_t pool_size = 0;
+    size_t free_frames = 0;         // free_list_中的帧数
+    size_t dirty_frames = 0;
+    size_t pinned_frames = 0;
+    uint64_t hits = 0;              // fetch_page时页面已在缓冲池中
+    uint64_t misses = 0;            // fetch_page时需要读盘
+    uint64_t pin_failures = 0;      // 所有帧都被固定，fetch_page/new_page返回nullptr
+    uint64_t evictions = 0;
+    uint64_t dirty_evictions = 0;
+    uint64_t background_writes = 0;
+    uint64_t prefetched_pages = 0;  // 预读线程放入缓冲池的页面数
+    LatencyHistogram::Snapshot miss_latency{};  // 未命中时从选帧到读盘完成的耗时
+
+    double hit_ratio() const { return hits + misses == 0 ? 0 : static_cast<double>(hits) / (hits + misses); }
+
+    void merge(const BufferPoolStats &other);
+};
+
+class BufferPoolManager {
+   private:
+    size_t pool_size_;      // buffer_pool中可容纳页面的个数，即帧的个数；可通过resize()在线调整
+    size_t max_pool_size_;  // 构造时预留的帧数上限，pages_和帧内存按此大小分配，编号不小于pool_size_的帧不再使用
+    std::mutex resize_latch_;   // 串行化resize()
+    Page *pages_;           // buffer_pool中的Page对象数组，在构造空间中申请内存空间，在析构函数中释放，大小为max_pool_size_
+    // 所有帧的页面数据所在的一整块对齐内存（arena），第i帧的数据位于frame_data_ + i * PAGE_SIZE
+    // 按max_pool_size_预留地址空间，物理内存在帧首次使用时才分配，缩容时归还给操作系统
+    char *frame_data_ = nullptr;
+    size_t frame_data_size_ = 0;
+    PageTable page_table_;  // 帧号和页面号的映射哈希表（定长开放寻址），用于根据页面的PageId定位该页面的帧编号
+    std::list<frame_id_t> free_list_;   // 空闲帧编号的链表
+    DiskManager *disk_manager_;
+    Replacer *replacer_;    // buffer_pool的置换策略，构造时通过ReplacerType选择
+    std::mutex latch_;      // 用于共享数据结构的并发控制
+    std::unique_ptr<std::atomic<bool>[]> cold_frames_;  // 帧中的页面是否只被顺序扫描读入过，这样的帧unpin时放到replacer的冷端
+    std::unordered_map<int, std::unordered_set<frame_id_t>> file_frames_;  // fd -> 缓冲池中属于该文件的帧，刷盘时只检查这些帧
+
+    // 后台刷脏线程：持续把未被固定的脏页写回磁盘，使淘汰时尽量不需要同步写盘
+    std::thread flusher_;
+    std::atomic<bool> flusher_running_{false};
+    std::condition_variable flusher_cv_;
+    std::chrono::milliseconds flush_interval_{10};
+    size_t clean_watermark_ = 0;            // 目标：可直接淘汰的干净帧（含空闲帧）数量不低于该值
+    std::vector<char> flushing_frames_;     // 正在被后台线程写回的帧，写回期间不能被淘汰
+    size_t num_async_ios_ = 0;              // 已提交未完成的预读和后台写回，受latch_保护
+    std::condition_variable io_cv_;         // 预读或后台写回完成时通知
+
+    std::atomic<size_t> num_evictions_{0};          // 从replacer中淘汰页面的次数
+    std::atomic<size_t> num_dirty_evictions_{0};    // 淘汰时仍需前台同步写回脏页的次数
+    std::atomic<size_t> num_background_writes_{0};  // 后台线程写回的页面数
+    std::atomic<size_t> num_hits_{0};
+    std::atomic<size_t> num_misses_{0};
+    std::atomic<size_t> num_pin_failures_{0};       // 没有可用帧导致fetch_page/new_page失败的次数
+    std::atomic<size_t> num_prefetched_{0};
+    LatencyHistogram miss_latency_;
+
+    // 异步预读线程：按请求把连续页面一次读入，再放入各自所属分片的空闲或可淘汰帧
+    std::thread prefetcher_;
+    bool prefetcher_running_ = false;
+    std::mutex prefetch_latch_;             // 保护prefetch_queue_和prefetcher_running_
+    std::condition_variable prefetch_cv_;
+    std::deque<PrefetchRequest> prefetch_queue_;
+    // 每次本分片有页面写回磁盘后自增；预读读盘前后该值变化，说明读到的内容可能已经过期
+    std::atomic<uint64_t> write_epoch_{0};
+
+    // 只读映射文件的页面视图，由顶层对象管理，不占用帧；固定计数减到0时释放
+    // 视图表按PageId哈希分成多段，各段有独立的锁，并发扫描不同页面时不争用同一把锁
+    struct alignas(64) MappedShard {
+        std::mutex latch;
+        std::unordered_map<PageId, std::unique_ptr<Page>, PageIdHash> pages;
+    };
+    static constexpr size_t NUM_MAPPED_SHARDS = 16;
+    std::array<MappedShard, NUM_MAPPED_SHARDS> mapped_shards_;
+
+    // 分片模式：PageId按哈希分配到各个分片，每个分片有独立的page_table_、free_list_、replacer_和latch_
+    // 非分片模式下shards_为空，由本对象直接管理帧
+    std::vector<std::unique_ptr<BufferPoolManager>> shards_;
+
+   public:
+    static constexpr size_t HUGE_PAGE_SIZE = 2 * 1024 * 1024;
+
+    /**
+     * @param pool_size 帧的个数
+     * @param num_shards 分片个数，大于1时启用分片模式
+     * @param replacer_type 置换策略
+     * @param use_huge_pages 帧内存按2MB对齐并建议内核使用透明大页，降低大缓冲池的TLB压力
+     * @param max_pool_size resize()可扩容到的最大帧数，为0时等于pool_size，即不能扩容
+     */
+    BufferPoolManager(size_t pool_size, DiskManager *disk_manager, size_t num_shards = 1,
+                      ReplacerType replacer_type = ReplacerType::LRU, bool use_huge_pages = false,
+                      size_t max_pool_size = 0)
+        : pool_size_(pool_size),
+          max_pool_size_(std::max(pool_size, max_pool_size)),
+          page_table_(num_shards > 1 ? 0 : std::max(pool_size, max_pool_size)),
+          disk_manager_(disk_manager) {
+        if (num_shards > 1) {
+            // 分片模式下本对象只负责转发请求，帧均匀分给各个分片
+            pages_ = nullptr;
+            replacer_ = nullptr;
+            for (size_t i = 0; i < num_shards; ++i) {
+                shards_.emplace_back(std::make_unique<BufferPoolManager>(
+                    shard_share(pool_size_, num_shards, i), disk_manager_, 1, replacer_type, use_huge_pages,
+                    shard_share(max_pool_size_, num_shards, i)));
+            }
+            return;
+        }
+        // 为buffer pool分配一块连续的内存空间
+        init_frames(use_huge_pages);
+        switch (replacer_type) {
+            case ReplacerType::CLOCK:
+                replacer_ = new ClockReplacer(max_pool_size_);
+                break;
+            case ReplacerType::LRU_K:
+                replacer_ = new LRUKReplacer(max_pool_size_);
+                break;
+            default:
+                replacer_ = new LRUReplacer(max_pool_size_);
+                break;
+        }
+        cold_frames_.reset(new std::atomic<bool>[max_pool_size_]());
+        flushing_frames_.assign(max_pool_size_, 0);
+        // 初始化时，所有的page都在free_list_中
+        for (size_t i = 0; i < pool_size_; ++i) {
+            free_list_.emplace_back(static_cast<frame_id_t>(i));  // static_cast转换数据类型
+        }
+    }
+
+    ~BufferPoolManager() {
+        stop_flusher();
+        stop_prefetcher();
+        wait_async_ios();
+        delete[] pages_;
+        if (frame_data_ != nullptr) {
+            munmap(frame_data_, frame_data_size_);
+        }
+        delete replacer_;
+    }
+
+    /**
+     * @description: 将目标页面标记为脏页
+     * @param {Page*} page 脏页
+     */
+    static void mark_dirty(Page* page) { page->is_dirty_ = true; }
+
+    size_t get_num_shards() const { return shards_.empty() ? 1 : shards_.size(); }
+
+    // 把total个帧均分给num_shards个分片时第i个分片分到的帧数
+    static size_t shard_share(size_t total, size_t num_shards, size_t i) {
+        return total / num_shards + (i < total % num_shards ? 1 : 0);
+    }
+
+   public:
+    Page* fetch_page(PageId page_id, AccessPattern pattern = AccessPattern::NORMAL);
+
+    bool unpin_page(PageId page_id, bool is_dirty);
+
+    bool unpin_page(Page* page, bool is_dirty);
+
+    bool flush_page(PageId page_id);
+
+    Page* new_page(PageId* page_id);
+
+    BasicPageGuard fetch_page_basic(PageId page_id, AccessPattern pattern = AccessPattern::NORMAL);
+
+    ReadPageGuard fetch_page_read(PageId page_id, AccessPattern pattern = AccessPattern::NORMAL);
+
+    WritePageGuard fetch_page_write(PageId page_id, AccessPattern pattern = AccessPattern::NORMAL);
+
+    BasicPageGuard new_page_basic(PageId* page_id);
+
+    WritePageGuard new_page_write(PageId* page_id);
+
+    bool delete_page(PageId page_id);
+
+    void flush_all_pages(int fd);
+
+    void prefetch(int fd, page_id_t start_page_no, int num_pages);
+
+    void prefetch_pages(int fd, std::vector<page_id_t> page_nos);
+
+    std::vector<PageId> get_resident_pages();
+
+    void start_flusher(size_t clean_watermark, std::chrono::milliseconds interval = std::chrono::milliseconds(10));
+
+    void stop_flusher();
+
+    void set_clean_watermark(size_t clean_watermark);
+
+    bool resize(size_t pool_size);
+
+    size_t get_pool_size();
+
+    size_t get_num_evictions();
+
+    size_t get_num_dirty_evictions();
+
+    size_t get_num_background_writes();
+
+    BufferPoolStats get_stats();
+
+    std::vector<BufferPoolStats> get_shard_stats();
+
+   private:
+    void init_frames(bool use_huge_pages);
+
+    Page* try_fetch_resident(PageId page_id, AccessPattern pattern);
+
+    Page* fetch_mapped_page(PageId page_id, AccessPattern pattern);
+
+    bool unpin_mapped_page(PageId page_id);
+
+    bool release_frame(frame_id_t frame_id, PageId page_id, bool is_dirty);
+
+    bool find_victim_page(frame_id_t* frame_id);
+
+    bool retire_frame(frame_id_t frame_id);
+
+    void update_page(Page* page, PageId new_page_id, frame_id_t new_frame_id, const char* data = nullptr,
+                     bool is_new = false);
+
+    void return_victim(frame_id_t frame_id);
+
+    BufferPoolManager* shard_of(PageId page_id) { return shards_[PageIdHash()(page_id) % shards_.size()].get(); }
+
+    MappedShard& mapped_shard_of(PageId page_id) { return mapped_shards_[PageIdHash()(page_id) % NUM_MAPPED_SHARDS]; }
+
+    Page* create_page(PageId page_id);
+
+    Page* install_new_page(frame_id_t frame_id, PageId page_id);
+
+    void collect_flush_pages(int fd, std::vector<Page*>* pages);
+
+    void flusher_loop();
+
+    void prefetcher_loop();
+
+    void stop_prefetcher();
+
+    bool is_resident(PageId page_id);
+
+    uint64_t get_write_epoch(PageId page_id);
+
+    void install_page(PageId page_id, const char* data, uint64_t write_epoch);
+
+    void flush_victim_candidates();
+
+    bool has_flushing_frames(int fd);
+
+    void wait_async_ios();
+
+    BufferPoolStats collect_stats();
+};
@@ -0,0 +1,120 @@
+#include "clock_replacer.h"
+
+ClockReplacer::ClockReplacer(size_t num_pages)
+    : in_replacer_(num_pages, 0),
+      ref_bits_(num_pages, 0),
+      in_cold_(num_pages, 0),
+      cold_prev_(num_pages, -1),
+      cold_next_(num_pages, -1) {}
+
+/**
+ * @description: 使用CLOCK策略选择一个victim frame，并返回该frame的id
+ * @param {frame_id_t*} frame_id 被移除的frame的id
+ * @return {bool} 如果成功淘汰了一个页面则返回true，否则返回false
+ */
+bool ClockReplacer::victim(frame_id_t* frame_id) {
+    if (size_ == 0) {
+        return false;
+    }
+    if (cold_head_ != -1) {
+        *frame_id = cold_head_;
+        remove_cold(cold_head_);
+        in_replacer_[*frame_id] = 0;
+        size_--;
+        return true;
+    }
+    // 最多转两圈：第一圈清除所有引用位，第二圈一定能找到引用位为0的帧
+    size_t num_pages = in_replacer_.size();
+    for (size_t step = 0; step < 2 * num_pages; ++step) {
+        size_t curr = hand_;
+        hand_ = (hand_ + 1) % num_pages;
+        if (!in_replacer_[curr]) {
+            continue;
+        }
+        if (ref_bits_[curr]) {
+            ref_bits_[curr] = 0;
+            continue;
+        }
+        in_replacer_[curr] = 0;
+        size_--;
+        *frame_id = static_cast<frame_id_t>(curr);
+        return true;
+    }
+    return false;
+}
+
+/**
+ * @description: 固定指定的frame，即该页面无法被淘汰
+ * @param {frame_id_t} 需要固定的frame的id
+ */
+void ClockReplacer::pin(frame_id_t frame_id) {
+    if (in_replacer_[frame_id]) {
+        in_replacer_[frame_id] = 0;
+        size_--;
+    }
+    remove_cold(frame_id);
+}
+
+/**
+ * @description: 取消固定一个frame，代表该页面可以被淘汰，同时设置引用位
+ * @param {frame_id_t} frame_id 取消固定的frame的id
+ */
+void ClockReplacer::unpin(frame_id_t frame_id) {
+    if (!in_replacer_[frame_id]) {
+        in_replacer_[frame_id] = 1;
+        size_++;
+    }
+    ref_bits_[frame_id] = 1;
+    remove_cold(frame_id);
+}
+
+/**
+ * @description: 取消固定一个冷帧，不设置引用位，并放入冷帧链表尾部，先于时钟上的帧被淘汰
+ * @param {frame_id_t} frame_id 取消固定的frame的id
+ */
+void ClockReplacer::unpin_cold(frame_id_t frame_id) {
+    if (!in_replacer_[frame_id]) {
+        in_replacer_[frame_id] = 1;
+        size_++;
+    }
+    ref_bits_[frame_id] = 0;
+    if (in_cold_[frame_id]) {
+        return;
+    }
+    in_cold_[frame_id] = 1;
+    cold_prev_[frame_id] = cold_tail_;
+    cold_next_[frame_id] = -1;
+    if (cold_tail_ != -1) {
+        cold_next_[cold_tail_] = frame_id;
+    } else {
+        cold_head_ = frame_id;
+    }
+    cold_tail_ = frame_id;
+}
+
+/**
+ * @description: 把frame从冷帧链表中摘除，不在链表中时什么也不做
+ */
+void ClockReplacer::remove_cold(frame_id_t frame_id) {
+    if (!in_cold_[frame_id]) {
+        return;
+    }
+    in_cold_[frame_id] = 0;
+    frame_id_t prev = cold_prev_[frame_id];
+    frame_id_t next = cold_next_[frame_id];
+    if (prev != -1) {
+        cold_next_[prev] = next;
+    } else {
+        cold_head_ = next;
+    }
+    if (next != -1) {
+        cold_prev_[next] = prev;
+    } else {
+        cold_tail_ = prev;
+    }
+}
+
+/**
+ * @description: 获取当前replacer中可以被淘汰的页面数量
+ */
+size_t ClockReplacer::Size() { return size_; }
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <vector>
+
+#include "common/config.h"
+#include "replacer/replacer.h"
+
+/**
+ * ClockReplacer implements the CLOCK (second chance) replacement policy.
+ * 所有状态都是构造时分配好的定长数组，pin/unpin/victim过程中不再申请内存。
+ * 本类不持有自己的锁，调用方（BufferPoolManager）需要在持有latch_时调用。
+ */
+class ClockReplacer : public Replacer {
+   public:
+    explicit ClockReplacer(size_t num_pages);
+
+    ~ClockReplacer() = default;
+
+    bool victim(frame_id_t *frame_id);
+
+    void pin(frame_id_t frame_id);
+
+    void unpin(frame_id_t frame_id);
+
+    void unpin_cold(frame_id_t frame_id);
+
+    size_t Size();
+
+   private:
+    void remove_cold(frame_id_t frame_id);
+
+    std::vector<char> in_replacer_;     // frame是否处于可淘汰状态
+    std::vector<char> ref_bits_;        // 引用位，被扫描到时置0，给予第二次机会
+    size_t hand_ = 0;                   // 时钟指针
+    size_t size_ = 0;                   // 当前可淘汰的帧数量
+
+    // 冷帧链表：unpin_cold放入的帧按先后顺序串成双向链表，victim优先从表头淘汰，不转动时钟指针
+    // 只清引用位不够：指针每转一圈都会清掉热点帧的引用位，扫描足够长时热点帧仍会被换出
+    std::vector<char> in_cold_;
+    std::vector<frame_id_t> cold_prev_;
+    std::vector<frame_id_t> cold_next_;
+    frame_id_t cold_head_ = -1;
+    frame_id_t cold_tail_ = -1;
+};
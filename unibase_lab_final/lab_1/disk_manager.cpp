@@ -1,66 +1,781 @@
 #include "storage/disk_manager.h"
 
 #include <assert.h>    // for assert
+#include <errno.h>     // for errno
+#include <stdlib.h>    // for posix_memalign
 #include <string.h>    // for memset
+#include <limits.h>    // for IOV_MAX
 #include <sys/stat.h>  // for stat
-#include <unistd.h>    // for lseek
+#include <sys/uio.h>   // for preadv, pwritev
+#include <unistd.h>    // for pread, pwrite, ftruncate
+
+#include <algorithm>
 
 #include "defs.h"
+#include "page_codec.h"
 
 DiskManager::DiskManager() { memset(fd2pageno_, 0, MAX_FD * (sizeof(std::atomic<page_id_t>) / sizeof(char))); }
 
+namespace {
+
+// O_DIRECT要求的对齐粒度，按页对齐可以满足常见的512B/4KB逻辑块大小
+constexpr size_t DIRECT_IO_ALIGN = PAGE_SIZE;
+
+bool is_direct_aligned(const void *buf, size_t num_bytes) {
+    return reinterpret_cast<uintptr_t>(buf) % DIRECT_IO_ALIGN == 0 && num_bytes % DIRECT_IO_ALIGN == 0;
+}
+
+// 申请按DIRECT_IO_ALIGN对齐、长度向上取整的临时缓冲区
+std::unique_ptr<char, decltype(&free)> alloc_direct_buffer(size_t *num_bytes) {
+    *num_bytes = (*num_bytes + DIRECT_IO_ALIGN - 1) / DIRECT_IO_ALIGN * DIRECT_IO_ALIGN;
+    void *buf = nullptr;
+    if (posix_memalign(&buf, DIRECT_IO_ALIGN, *num_bytes) != 0) {
+        throw std::bad_alloc();
+    }
+    memset(buf, 0, *num_bytes);
+    return std::unique_ptr<char, decltype(&free)>(static_cast<char *>(buf), &free);
+}
+
+}  // namespace
+
 /**
  * @description: 将数据写入文件的指定磁盘页面中
+ *               使用pwrite按偏移写入，不修改文件的读写指针，多个线程可以同时读写同一个fd
  * @param {int} fd 磁盘文件的文件句柄
  * @param {page_id_t} page_no 写入目标页面的page_id
  * @param {char} *offset 要写入磁盘的数据
  * @param {int} num_bytes 要写入磁盘的数据大小
  */
 void DiskManager::write_page(int fd, page_id_t page_no, const char *offset, int num_bytes) {
-    if(lseek(fd, page_no * PAGE_SIZE, SEEK_SET) == -1) {  //定位读写指针
-        throw InternalError("diskmanager::write_page Error");
+    if(compressed_[fd] != nullptr) {
+        write_compressed_page(fd, page_no, offset, num_bytes);
+        return;
     }
-    if(write(fd, offset, num_bytes) != num_bytes) { //写文件
+    LatencyTimer timer(&write_latency_);
+    num_writes_.fetch_add(1, std::memory_order_relaxed);
+    bytes_written_.fetch_add(num_bytes, std::memory_order_relaxed);
+    if(direct_fds_[fd] && !is_direct_aligned(offset, num_bytes)) {
+        direct_write_unaligned(fd, page_no, offset, num_bytes);
+        return;
+    }
+    if(pwrite(fd, offset, num_bytes, static_cast<off_t>(page_no) * PAGE_SIZE) != num_bytes) { //按偏移写文件
         throw InternalError("diskmanager::write_page Error");
     }
-    // Todo:
-    // 1.lseek()定位到文件头，通过(fd,page_no)可以定位指定页面及其在磁盘文件中的偏移量
-    // 2.调用write()函数
-    // 注意write返回值与num_bytes不等时 throw InternalError("DiskManager::write_page Error");
 }
 
 /**
  * @description: 读取文件中指定编号的页面中的部分数据到内存中
+ *               使用pread按偏移读取，不修改文件的读写指针，多个线程可以同时读写同一个fd
  * @param {int} fd 磁盘文件的文件句柄
  * @param {page_id_t} page_no 指定的页面编号
  * @param {char} *offset 读取的内容写入到offset中
  * @param {int} num_bytes 读取的数据量大小
  */
 void DiskManager::read_page(int fd, page_id_t page_no, char *offset, int num_bytes) {
-    if(lseek(fd, page_no * PAGE_SIZE, SEEK_SET) == -1) {  //定位读写指针
-        throw InternalError("diskmanager::read_page Error");
+    if(compressed_[fd] != nullptr) {
+        char page[PAGE_SIZE];
+        read_compressed_pages(fd, {{page_no, page}});
+        memcpy(offset, page, num_bytes);
+        return;
+    }
+    LatencyTimer timer(&read_latency_);
+    num_reads_.fetch_add(1, std::memory_order_relaxed);
+    bytes_read_.fetch_add(num_bytes, std::memory_order_relaxed);
+    if(direct_fds_[fd] && !is_direct_aligned(offset, num_bytes)) {
+        direct_read_unaligned(fd, page_no, offset, num_bytes);
+        return;
     }
-    if(read(fd, offset, num_bytes) == -1) { //读文件
+    if(pread(fd, offset, num_bytes, static_cast<off_t>(page_no) * PAGE_SIZE) == -1) { //按偏移读文件
         throw InternalError("diskmanager::read_page Error");
     }
-    // Todo:
-    // 1.lseek()定位到文件头，通过(fd,page_no)可以定位指定页面及其在磁盘文件中的偏移量
-    // 2.调用read()函数
-    // 注意read返回值与num_bytes不等时，throw InternalError("DiskManager::read_page Error");
 }
 
 /**
- * @description: 分配一个新的页号
+ * @description: 批量读取文件中的多个页面，页号连续的页面合并为一次preadv
+ *               超出文件末尾的部分读不到数据，对应的缓冲区填0
+ * @param {int} fd 磁盘文件的文件句柄
+ * @param {vector<pair<page_id_t, char*>>&} pages 要读取的(页号, 缓冲区)，应按页号递增排列，每个页面读取PAGE_SIZE字节
+ */
+void DiskManager::read_pages(int fd, const std::vector<std::pair<page_id_t, char *>> &pages) {
+    if(compressed_[fd] != nullptr) {
+        read_compressed_pages(fd, pages);
+        return;
+    }
+    if(direct_fds_[fd]) {
+        for(auto &page : pages) {
+            if(!is_direct_aligned(page.second, PAGE_SIZE)) {
+                // 有未对齐的缓冲区时逐页读取，由read_page处理对齐
+                for(auto &p : pages) {
+                    memset(p.second, 0, PAGE_SIZE);
+                    read_page(fd, p.first, p.second, PAGE_SIZE);
+                }
+                return;
+            }
+        }
+    }
+    std::vector<struct iovec> iov;
+    size_t i = 0;
+    while (i < pages.size()) {
+        page_id_t run_start = pages[i].first;
+        iov.clear();
+        while (i < pages.size() && pages[i].first == run_start + static_cast<page_id_t>(iov.size()) &&
+               iov.size() < IOV_MAX) {
+            iov.push_back({pages[i].second, PAGE_SIZE});
+            i++;
+        }
+        ssize_t expected = static_cast<ssize_t>(iov.size()) * PAGE_SIZE;
+        ssize_t bytes;
+        {
+            LatencyTimer timer(&read_latency_);
+            bytes = preadv(fd, iov.data(), static_cast<int>(iov.size()), static_cast<off_t>(run_start) * PAGE_SIZE);
+        }
+        if(bytes == -1) {
+            throw InternalError("DiskManager::read_pages Error");
+        }
+        num_reads_.fetch_add(1, std::memory_order_relaxed);
+        bytes_read_.fetch_add(bytes, std::memory_order_relaxed);
+        // 把文件末尾之后的部分清零
+        for (ssize_t pos = bytes; pos < expected; pos = (pos / PAGE_SIZE + 1) * PAGE_SIZE) {
+            char *page = static_cast<char *>(iov[pos / PAGE_SIZE].iov_base);
+            memset(page + pos % PAGE_SIZE, 0, PAGE_SIZE - pos % PAGE_SIZE);
+        }
+    }
+}
+
+/**
+ * @description: 批量写入文件中的多个页面，页号连续的页面合并为一次pwritev
+ * @param {int} fd 磁盘文件的文件句柄
+ * @param {vector<pair<page_id_t, char*>>&} pages 要写入的(页号, 页面数据)，应按页号递增排列，每个页面写入PAGE_SIZE字节
+ */
+void DiskManager::write_pages(int fd, const std::vector<std::pair<page_id_t, const char *>> &pages) {
+    if(compressed_[fd] != nullptr) {
+        for(auto &p : pages) {
+            write_compressed_page(fd, p.first, p.second, PAGE_SIZE);
+        }
+        return;
+    }
+    if(direct_fds_[fd]) {
+        for(auto &page : pages) {
+            if(!is_direct_aligned(page.second, PAGE_SIZE)) {
+                // 有未对齐的缓冲区时逐页写入，由write_page处理对齐
+                for(auto &p : pages) {
+                    write_page(fd, p.first, p.second, PAGE_SIZE);
+                }
+                return;
+            }
+        }
+    }
+    std::vector<struct iovec> iov;
+    size_t i = 0;
+    while (i < pages.size()) {
+        page_id_t run_start = pages[i].first;
+        iov.clear();
+        while (i < pages.size() && pages[i].first == run_start + static_cast<page_id_t>(iov.size()) &&
+               iov.size() < IOV_MAX) {
+            iov.push_back({const_cast<char *>(pages[i].second), PAGE_SIZE});
+            i++;
+        }
+        ssize_t expected = static_cast<ssize_t>(iov.size()) * PAGE_SIZE;
+        LatencyTimer timer(&write_latency_);
+        num_writes_.fetch_add(1, std::memory_order_relaxed);
+        bytes_written_.fetch_add(expected, std::memory_order_relaxed);
+        if(pwritev(fd, iov.data(), static_cast<int>(iov.size()), static_cast<off_t>(run_start) * PAGE_SIZE) != expected) {
+            throw InternalError("DiskManager::write_pages Error");
+        }
+    }
+}
+
+/**
+ * @description: 异步批量读取多个页面，页号连续的页面合并为一次请求，全部完成后调用callback
+ *               未启用异步后端、压缩文件，或O_DIRECT文件的缓冲区未对齐时同步读取，返回前调用callback
+ * @param {int} fd 磁盘文件的文件句柄
+ * @param {vector<pair<page_id_t, char*>>&} pages 要读取的(页号, 缓冲区)，应按页号递增排列；缓冲区在callback执行前必须保持有效
+ * @param {function<void(bool)>} callback 完成回调，参数表示是否全部读取成功；异步时在后端的完成线程中执行
+ */
+void DiskManager::async_read_pages(int fd, const std::vector<std::pair<page_id_t, char *>> &pages,
+                                   std::function<void(bool)> callback) {
+    submit_pages(fd, pages, false, std::move(callback));
+}
+
+/**
+ * @description: 异步批量写入多个页面，页号连续的页面合并为一次请求，全部完成后调用callback
+ *               未启用异步后端、压缩文件，或O_DIRECT文件的缓冲区未对齐时同步写入，返回前调用callback
+ * @param {int} fd 磁盘文件的文件句柄
+ * @param {vector<pair<page_id_t, char*>>&} pages 要写入的(页号, 页面数据)，应按页号递增排列；数据在callback执行前必须保持有效
+ * @param {function<void(bool)>} callback 完成回调，参数表示是否全部写入成功；异步时在后端的完成线程中执行
+ */
+void DiskManager::async_write_pages(int fd, const std::vector<std::pair<page_id_t, const char *>> &pages,
+                                    std::function<void(bool)> callback) {
+    std::vector<std::pair<page_id_t, char *>> buffers;
+    buffers.reserve(pages.size());
+    for (auto &page : pages) {
+        buffers.emplace_back(page.first, const_cast<char *>(page.second));
+    }
+    submit_pages(fd, buffers, true, std::move(callback));
+}
+
+/**
+ * @description: async_read_pages和async_write_pages的实现：先划分出所有连续的页号段，再逐段提交
+ */
+void DiskManager::submit_pages(int fd, const std::vector<std::pair<page_id_t, char *>> &pages, bool is_write,
+                               std::function<void(bool)> callback) {
+    bool aligned = true;
+    if (direct_fds_[fd]) {
+        for (auto &page : pages) {
+            aligned = aligned && is_direct_aligned(page.second, PAGE_SIZE);
+        }
+    }
+    if (async_io_ == nullptr || !aligned || pages.empty() || compressed_[fd] != nullptr) {
+        bool ok = true;
+        try {
+            if (is_write) {
+                std::vector<std::pair<page_id_t, const char *>> buffers(pages.begin(), pages.end());
+                write_pages(fd, buffers);
+            } else {
+                read_pages(fd, pages);
+            }
+        } catch (InternalError &) {
+            ok = false;
+        }
+        callback(ok);
+        return;
+    }
+
+    struct Batch {
+        std::atomic<size_t> remaining;
+        std::atomic<bool> ok{true};
+        std::function<void(bool)> callback;
+    };
+    std::vector<std::vector<struct iovec>> runs;
+    std::vector<page_id_t> run_starts;
+    size_t i = 0;
+    while (i < pages.size()) {
+        page_id_t run_start = pages[i].first;
+        std::vector<struct iovec> iov;
+        while (i < pages.size() && pages[i].first == run_start + static_cast<page_id_t>(iov.size()) &&
+               iov.size() < IOV_MAX) {
+            iov.push_back({pages[i].second, PAGE_SIZE});
+            i++;
+        }
+        runs.push_back(std::move(iov));
+        run_starts.push_back(run_start);
+    }
+    // 计数必须在提交第一段之前设好，否则先完成的段可能提前触发回调
+    auto batch = std::make_shared<Batch>();
+    batch->remaining = runs.size();
+    batch->callback = std::move(callback);
+    for (size_t r = 0; r < runs.size(); r++) {
+        std::vector<char *> buffers;
+        for (auto &io : runs[r]) {
+            buffers.push_back(static_cast<char *>(io.iov_base));
+        }
+        ssize_t expected = static_cast<ssize_t>(runs[r].size()) * PAGE_SIZE;
+        auto start = std::chrono::steady_clock::now();
+        (is_write ? num_writes_ : num_reads_).fetch_add(1, std::memory_order_relaxed);
+        async_io_->submit(
+            fd, static_cast<off_t>(run_starts[r]) * PAGE_SIZE, std::move(runs[r]), is_write,
+            [this, batch, buffers = std::move(buffers), expected, is_write, start](ssize_t bytes) {
+                (is_write ? write_latency_ : read_latency_).record(std::chrono::steady_clock::now() - start);
+                if (bytes < 0 || (is_write && bytes != expected)) {
+                    batch->ok = false;
+                } else {
+                    (is_write ? bytes_written_ : bytes_read_).fetch_add(bytes, std::memory_order_relaxed);
+                    // 读到文件末尾之后的部分清零
+                    for (ssize_t pos = bytes; pos < expected; pos = (pos / PAGE_SIZE + 1) * PAGE_SIZE) {
+                        memset(buffers[pos / PAGE_SIZE] + pos % PAGE_SIZE, 0, PAGE_SIZE - pos % PAGE_SIZE);
+                    }
+                }
+                if (batch->remaining.fetch_sub(1) == 1) {
+                    batch->callback(batch->ok);
+                }
+            });
+    }
+}
+
+/**
+ * @description: 压缩后写入一个页面。数据块总是写到新分配的位置，pwrite完成后才在位置表中替换，
+ *               并发的读者要么读到旧块、要么读到写完的新块；旧块放入released，下一次flush_page_map之后才会被复用
+ *               num_bytes不足PAGE_SIZE时先读出原页面，只覆盖前num_bytes字节，与普通文件的部分写入效果一致；
+ *               这样的读-改-写持有write_latch的独占锁，避免与同一文件的其他写入交错而丢失更新
+ */
+void DiskManager::write_compressed_page(int fd, page_id_t page_no, const char *offset, int num_bytes) {
+    CompressedFile &file = *compressed_[fd];
+    std::unique_lock<std::shared_mutex> exclusive_write(file.write_latch, std::defer_lock);
+    std::shared_lock<std::shared_mutex> shared_write(file.write_latch, std::defer_lock);
+    char page[PAGE_SIZE];
+    if(num_bytes < PAGE_SIZE) {
+        exclusive_write.lock();
+        read_compressed_pages(fd, {{page_no, page}});
+    } else {
+        shared_write.lock();
+    }
+    memcpy(page, offset, num_bytes);
+    char compressed[PAGE_SIZE];
+    int length = PageCodec::compress(page, PAGE_SIZE, compressed, PAGE_SIZE - 1);
+    const char *block = compressed;
+    if(length == 0) {  // 不可压缩，按原样存放
+        length = PAGE_SIZE;
+        block = page;
+    }
+    CompressedPage ref;
+    {
+        std::scoped_lock lock{file.latch};
+        ref = allocate_block(file, length);
+    }
+    {
+        LatencyTimer timer(&write_latency_);
+        num_writes_.fetch_add(1, std::memory_order_relaxed);
+        bytes_written_.fetch_add(length, std::memory_order_relaxed);
+        if(pwrite(fd, block, length, static_cast<off_t>(ref.offset)) != length) {
+            std::scoped_lock lock{file.latch};
+            file.released.push_back(ref);
+            throw InternalError("DiskManager::write_page Error");
+        }
+    }
+    std::scoped_lock lock{file.latch};
+    if(static_cast<size_t>(page_no) >= file.pages.size()) {
+        file.pages.resize(page_no + 1);
+    }
+    CompressedPage &old = file.pages[page_no];
+    if(old.length != 0) {
+        file.released.push_back(old);
+    }
+    old = ref;
+    file.dirty = true;
+}
+
+/**
+ * @description: 为长度为length的数据块分配位置，调用前需持有file.latch
+ *               优先复用能放下的最小空闲块（多出的部分拆分回空闲块），没有时在已使用空间末尾追加
+ */
+DiskManager::CompressedPage DiskManager::allocate_block(CompressedFile &file, int length) {
+    CompressedPage ref;
+    ref.length = length;
+    ref.capacity = (length + COMPRESSED_ALIGN - 1) / COMPRESSED_ALIGN * COMPRESSED_ALIGN;
+    auto it = file.free_blocks.lower_bound(ref.capacity);
+    if(it == file.free_blocks.end()) {
+        ref.offset = file.end;
+        file.end += ref.capacity;
+        return ref;
+    }
+    ref.offset = it->second;
+    uint32_t rest = it->first - ref.capacity;
+    file.free_blocks.erase(it);
+    if(rest > 0) {
+        file.free_blocks.emplace(rest, ref.offset + ref.capacity);
+    }
+    return ref;
+}
+
+/**
+ * @description: 读取并解压压缩文件中的多个页面，数据块在文件中相邻的页面（如顺序写入的页面）合并为一次pread
+ *               从未写入的页面填0
+ */
+void DiskManager::read_compressed_pages(int fd, const std::vector<std::pair<page_id_t, char *>> &pages) {
+    CompressedFile &file = *compressed_[fd];
+    // 读完数据块之前持有，期间被替换下来的块不会被回收复用
+    std::shared_lock read_lock{file.read_latch};
+    std::vector<CompressedPage> refs(pages.size());
+    {
+        std::scoped_lock lock{file.latch};
+        for(size_t i = 0; i < pages.size(); i++) {
+            if(pages[i].first >= 0 && static_cast<size_t>(pages[i].first) < file.pages.size()) {
+                refs[i] = file.pages[pages[i].first];
+            }
+        }
+    }
+    std::vector<char> buf;
+    size_t i = 0;
+    while(i < pages.size()) {
+        if(refs[i].length == 0) {
+            memset(pages[i].second, 0, PAGE_SIZE);
+            i++;
+            continue;
+        }
+        size_t j = i + 1;
+        while(j < pages.size() && refs[j].length != 0 && refs[j].offset == refs[j - 1].offset + refs[j - 1].capacity) {
+            j++;
+        }
+        uint64_t start = refs[i].offset;
+        size_t span = refs[j - 1].offset + refs[j - 1].length - start;
+        buf.resize(span);
+        ssize_t bytes;
+        {
+            LatencyTimer timer(&read_latency_);
+            bytes = pread(fd, buf.data(), span, static_cast<off_t>(start));
+        }
+        if(bytes != static_cast<ssize_t>(span)) {
+            throw InternalError("DiskManager::read_page Error");
+        }
+        num_reads_.fetch_add(1, std::memory_order_relaxed);
+        bytes_read_.fetch_add(bytes, std::memory_order_relaxed);
+        for(size_t k = i; k < j; k++) {
+            const char *block = buf.data() + (refs[k].offset - start);
+            if(refs[k].length == PAGE_SIZE) {
+                memcpy(pages[k].second, block, PAGE_SIZE);
+            } else if(PageCodec::decompress(block, refs[k].length, pages[k].second, PAGE_SIZE) != PAGE_SIZE) {
+                throw InternalError("DiskManager::read_page: corrupted compressed page");
+            }
+        }
+        i = j;
+    }
+}
+
+/**
+ * @description: 打开压缩文件时读入页面位置表，位置表没有引用的空间都作为空闲块
+ *               位置表文件格式：页面个数(uint64) | 已使用空间末尾(uint64) | 每个页面的CompressedPage
+ */
+void DiskManager::load_page_map(int fd, const std::string &path) {
+    auto file = std::make_unique<CompressedFile>();
+    std::ifstream in(path + PAGE_MAP_SUFFIX, std::ios::binary);
+    uint64_t num_pages = 0;
+    if(in.read(reinterpret_cast<char *>(&num_pages), sizeof(num_pages))) {
+        in.read(reinterpret_cast<char *>(&file->end), sizeof(file->end));
+        file->pages.resize(num_pages);
+        in.read(reinterpret_cast<char *>(file->pages.data()), num_pages * sizeof(CompressedPage));
+        if(!in) {
+            throw InternalError("DiskManager::open_file: corrupted page map " + path + PAGE_MAP_SUFFIX);
+        }
+    }
+    // 上次写回位置表之后写入的数据块不被表引用，和被替换下来的旧块一样可以复用
+    struct stat st;
+    if(fstat(fd, &st) == 0 && static_cast<uint64_t>(st.st_size) > file->end) {
+        file->end = (st.st_size + COMPRESSED_ALIGN - 1) / COMPRESSED_ALIGN * COMPRESSED_ALIGN;
+    }
+    std::vector<std::pair<uint64_t, uint32_t>> used;
+    for(auto &ref : file->pages) {
+        if(ref.length != 0) {
+            used.emplace_back(ref.offset, ref.capacity);
+        }
+    }
+    std::sort(used.begin(), used.end());
+    uint64_t pos = 0;
+    for(auto &[block_offset, capacity] : used) {
+        if(block_offset > pos) {
+            file->free_blocks.emplace(static_cast<uint32_t>(block_offset - pos), pos);
+        }
+        pos = std::max(pos, block_offset + capacity);
+    }
+    if(file->end > pos) {
+        file->free_blocks.emplace(static_cast<uint32_t>(file->end - pos), pos);
+    }
+    compressed_[fd] = std::move(file);
+}
+
+namespace {
+
+// 完整写入并fsync一个文件
+void write_file_durably(const std::string &path, const std::vector<char> &data) {
+    int fd = open(path.c_str(), O_CREAT | O_WRONLY | O_TRUNC, 0666);
+    if(fd < 0) {
+        throw UnixError();
+    }
+    size_t written = 0;
+    while(written < data.size()) {
+        ssize_t bytes = write(fd, data.data() + written, data.size() - written);
+        if(bytes < 0 && errno == EINTR) {
+            continue;
+        }
+        if(bytes <= 0) {
+            close(fd);
+            throw UnixError();
+        }
+        written += bytes;
+    }
+    if(fsync(fd) != 0) {
+        close(fd);
+        throw UnixError();
+    }
+    close(fd);
+}
+
+// fsync文件所在的目录，使rename持久化
+void sync_parent_dir(const std::string &path) {
+    size_t slash = path.rfind('/');
+    std::string dir = slash == std::string::npos ? "." : (slash == 0 ? "/" : path.substr(0, slash));
+    int fd = open(dir.c_str(), O_RDONLY | O_DIRECTORY);
+    if(fd < 0) {
+        throw UnixError();
+    }
+    int rc = fsync(fd);
+    close(fd);
+    if(rc != 0) {
+        throw UnixError();
+    }
+}
+
+}  // namespace
+
+/**
+ * @description: 把压缩文件的页面位置表持久化：先fdatasync数据文件，使表中引用的数据块都已落盘；
+ *               再写临时文件并fsync，rename替换原来的位置表后fsync目录。写回过程中崩溃时原来的位置表仍然完整
+ *               新的位置表持久化之后，此前被替换下来的数据块不再被任何位置表引用，放入空闲块等待复用
+ * @param {int} fd 压缩文件的文件句柄，不是压缩文件时直接返回
+ */
+void DiskManager::flush_page_map(int fd) {
+    CompressedFile *file = compressed_[fd].get();
+    if(file == nullptr) {
+        return;
+    }
+    std::scoped_lock flush_lock{file->flush_latch};
+    std::string path = get_file_name(fd) + PAGE_MAP_SUFFIX;
+    std::string tmp_path = path + ".tmp";
+    std::vector<char> data;
+    std::vector<CompressedPage> released;
+    {
+        std::scoped_lock lock{file->latch};
+        if(!file->dirty) {
+            return;
+        }
+        uint64_t num_pages = file->pages.size();
+        data.resize(2 * sizeof(uint64_t) + num_pages * sizeof(CompressedPage));
+        memcpy(data.data(), &num_pages, sizeof(num_pages));
+        memcpy(data.data() + sizeof(uint64_t), &file->end, sizeof(file->end));
+        memcpy(data.data() + 2 * sizeof(uint64_t), file->pages.data(), num_pages * sizeof(CompressedPage));
+        released.swap(file->released);  // 之后替换下来的块仍可能被这次写出的位置表引用，留到下一次
+        file->dirty = false;
+    }
+    try {
+        if(fdatasync(fd) != 0) {
+            throw UnixError();
+        }
+        write_file_durably(tmp_path, data);
+        if(rename(tmp_path.c_str(), path.c_str()) != 0) {
+            throw UnixError();
+        }
+        sync_parent_dir(path);
+    } catch (...) {
+        std::scoped_lock lock{file->latch};
+        file->released.insert(file->released.end(), released.begin(), released.end());
+        file->dirty = true;
+        throw;
+    }
+    // 等待正在读这些块的读者结束后再放入空闲块
+    std::scoped_lock lock{file->read_latch, file->latch};
+    for(auto &ref : released) {
+        file->free_blocks.emplace(ref.capacity, ref.offset);
+    }
+}
+
+/**
+ * @description: 获取只读映射文件中指定页面在映射中的地址
+ * @return {char*} 页面地址，文件未映射或页面超出文件末尾时返回nullptr；映射为PROT_READ，不能通过该地址写入
+ * @param {int} fd 磁盘文件的文件句柄
+ * @param {page_id_t} page_no 页面编号
+ */
+char *DiskManager::get_mapped_page(int fd, page_id_t page_no) const {
+    const FileMapping &mapping = mappings_[fd];
+    size_t offset = static_cast<size_t>(page_no) * PAGE_SIZE;
+    if(mapping.data == nullptr || page_no < 0 || offset + PAGE_SIZE > mapping.size) {
+        return nullptr;
+    }
+    return mapping.data + offset;
+}
+
+/**
+ * @description: 提示内核该映射文件将被顺序扫描，内核会加大预读并及时回收扫描过的页面；每个文件只设置一次
+ */
+void DiskManager::advise_sequential(int fd) {
+    FileMapping &mapping = mappings_[fd];
+    if(mapping.data != nullptr && !mapping.sequential.exchange(true)) {
+        madvise(mapping.data, mapping.size, MADV_SEQUENTIAL);
+    }
+}
+
+/**
+ * @description: 提示内核提前把映射文件中的一段页面读入页缓存，相当于映射文件的异步预读
+ */
+void DiskManager::advise_willneed(int fd, page_id_t start_page_no, int num_pages) {
+    const FileMapping &mapping = mappings_[fd];
+    size_t offset = static_cast<size_t>(start_page_no) * PAGE_SIZE;
+    if(mapping.data == nullptr || start_page_no < 0 || offset >= mapping.size) {
+        return;
+    }
+    size_t length = std::min(static_cast<size_t>(num_pages) * PAGE_SIZE, mapping.size - offset);
+    madvise(mapping.data + offset, length, MADV_WILLNEED);
+}
+
+/**
+ * @description: 获取读写次数、字节数和延迟分布
+ */
+DiskStats DiskManager::get_stats() const {
+    DiskStats stats;
+    stats.num_reads = num_reads_.load(std::memory_order_relaxed);
+    stats.num_writes = num_writes_.load(std::memory_order_relaxed);
+    stats.bytes_read = bytes_read_.load(std::memory_order_relaxed);
+    stats.bytes_written = bytes_written_.load(std::memory_order_relaxed);
+    read_latency_.add_to(&stats.read_latency);
+    write_latency_.add_to(&stats.write_latency);
+    return stats;
+}
+
+/**
+ * @description: O_DIRECT文件的缓冲区或长度未对齐时，经对齐的临时缓冲区写入
+ *               长度不足整块时先读出原有内容，避免覆盖块中其余的数据
+ */
+void DiskManager::direct_write_unaligned(int fd, page_id_t page_no, const char *offset, int num_bytes) {
+    size_t aligned_bytes = num_bytes;
+    auto buf = alloc_direct_buffer(&aligned_bytes);
+    off_t file_offset = static_cast<off_t>(page_no) * PAGE_SIZE;
+    if(aligned_bytes != static_cast<size_t>(num_bytes)) {
+        off_t tail = static_cast<off_t>(aligned_bytes - DIRECT_IO_ALIGN);
+        if(pread(fd, buf.get() + tail, DIRECT_IO_ALIGN, file_offset + tail) == -1) {
+            throw InternalError("DiskManager::write_page Error");
+        }
+    }
+    memcpy(buf.get(), offset, num_bytes);
+    if(pwrite(fd, buf.get(), aligned_bytes, file_offset) != static_cast<ssize_t>(aligned_bytes)) {
+        throw InternalError("DiskManager::write_page Error");
+    }
+}
+
+/**
+ * @description: O_DIRECT文件的缓冲区或长度未对齐时，经对齐的临时缓冲区读出
+ */
+void DiskManager::direct_read_unaligned(int fd, page_id_t page_no, char *offset, int num_bytes) {
+    size_t aligned_bytes = num_bytes;
+    auto buf = alloc_direct_buffer(&aligned_bytes);
+    if(pread(fd, buf.get(), aligned_bytes, static_cast<off_t>(page_no) * PAGE_SIZE) == -1) {
+        throw InternalError("DiskManager::read_page Error");
+    }
+    memcpy(offset, buf.get(), num_bytes);
+}
+
+/**
+ * @description: 分配一个新的页号，优先复用空闲页位图中页号最小的页面，没有空闲页时在文件末尾分配
  * @return {page_id_t} 分配的新页号
  * @param {int} fd 指定文件的文件句柄
  */
 page_id_t DiskManager::allocate_page(int fd) {
+    assert(fd >= 0 && fd < MAX_FD);
+    std::scoped_lock lock{free_latch_};
+    if (num_free_pages_[fd] > 0) {
+        auto &map = free_maps_[fd];
+        for (size_t i = 0; i < map.size(); ++i) {
+            if (map[i] == 0) {
+                continue;
+            }
+            int bit = __builtin_clz(static_cast<unsigned char>(map[i])) - 24;
+            map[i] &= static_cast<char>(~(0x80 >> bit));
+            num_free_pages_[fd]--;
+            return static_cast<page_id_t>(i * 8 + bit);
+        }
+    }
     // 简单的自增分配策略，指定文件的页面编号加1
+    page_id_t page_no = fd2pageno_[fd]++;
+    if (page_no >= fd2extent_[fd]) {
+        extend_file(fd, page_no);
+    }
+    return page_no;
+}
+
+/**
+ * @description: 从page_no开始为文件预分配extent_size_个页面的磁盘空间，调用前需持有free_latch_
+ *               使用FALLOC_FL_KEEP_SIZE，文件大小不变，读写和get_file_size的行为与预分配前一致；
+ *               文件系统不支持fallocate时同样推进fd2extent_，避免之后每次分配都重试
+ */
+void DiskManager::extend_file(int fd, page_id_t page_no) {
+    int extent_size = extent_size_;
+    if (extent_size <= 0 || compressed_[fd] != nullptr) {  // 压缩文件的数据块不按页号存放
+        return;
+    }
+    fallocate(fd, FALLOC_FL_KEEP_SIZE, static_cast<off_t>(page_no) * PAGE_SIZE,
+              static_cast<off_t>(extent_size) * PAGE_SIZE);
+    fd2extent_[fd] = page_no + extent_size;
+}
+
+/**
+ * @description: 释放指定文件中的一个页面，之后allocate_page可以复用该页号；页面的数据不再有效
+ *               调用者需保证该页面已不在缓冲池中（BufferPoolManager::delete_page会在删除帧后调用本函数）
+ * @param {int} fd 文件句柄
+ * @param {page_id_t} page_no 要释放的页号
+ */
+void DiskManager::deallocate_page(int fd, page_id_t page_no) {
+    assert(fd >= 0 && fd < MAX_FD);
+    std::scoped_lock lock{free_latch_};
+    if (page_no < 0 || page_no >= fd2pageno_[fd]) {
+        return;
+    }
+    auto &map = free_maps_[fd];
+    size_t byte = page_no / 8;
+    char mask = static_cast<char>(0x80 >> (page_no % 8));
+    if (byte >= map.size()) {
+        map.resize(byte + 1, 0);
+    }
+    if ((map[byte] & mask) == 0) {
+        map[byte] |= mask;
+        num_free_pages_[fd]++;
+    }
+}
+
+/**
+ * @description: 把文件末尾连续的空闲页截掉：降低已分配页面个数，并用ftruncate缩小磁盘文件
+ * @return {int} 截掉的页面个数
+ * @param {int} fd 文件句柄
+ */
+int DiskManager::truncate_free_pages(int fd) {
     assert(fd >= 0 && fd < MAX_FD);
-    return fd2pageno_[fd]++;
+    if (is_mapped(fd) || is_compressed(fd)) {
+        return 0;
+    }
+    std::scoped_lock lock{free_latch_};
+    auto &map = free_maps_[fd];
+    int removed = 0;
+    page_id_t num_pages = fd2pageno_[fd];
+    while (num_pages > 0) {
+        page_id_t last = num_pages - 1;
+        size_t byte = last / 8;
+        char mask = static_cast<char>(0x80 >> (last % 8));
+        if (byte >= map.size() || (map[byte] & mask) == 0) {
+            break;
+        }
+        map[byte] &= static_cast<char>(~mask);
+        num_pages--;
+        removed++;
+    }
+    if (removed == 0) {
+        return 0;
+    }
+    num_free_pages_[fd] -= removed;
+    fd2pageno_[fd] = num_pages;
+    map.resize((num_pages + 7) / 8);
+    // 已分配但从未写入的页面不占文件空间，文件可能本来就比截断后的长度短，此时不能用ftruncate扩展文件
+    struct stat st;
+    off_t new_size = static_cast<off_t>(num_pages) * PAGE_SIZE;
+    if (fstat(fd, &st) == 0 && st.st_size > new_size && ftruncate(fd, new_size) != 0) {
+        throw UnixError();
+    }
+    // ftruncate同时释放了新长度之后预分配的空间
+    fd2extent_[fd] = std::min(fd2extent_[fd], num_pages);
+    return removed;
 }
 
-void DiskManager::deallocate_page(__attribute__((unused)) page_id_t page_id) {}
+std::vector<char> DiskManager::get_free_page_map(int fd) {
+    std::scoped_lock lock{free_latch_};
+    std::vector<char> map = free_maps_[fd];
+    map.resize((fd2pageno_[fd] + 7) / 8, 0);
+    return map;
+}
+
+/**
+ * @description: 恢复文件的空闲页位图，需在set_fd2pageno之后调用，超出已分配页面范围的位被忽略
+ * @param {char*} map 位图，格式与get_free_page_map相同
+ * @param {int} num_bytes 位图的字节数
+ */
+void DiskManager::set_free_page_map(int fd, const char *map, int num_bytes) {
+    std::scoped_lock lock{free_latch_};
+    page_id_t num_pages = fd2pageno_[fd];
+    auto &free_map = free_maps_[fd];
+    free_map.assign(map, map + std::min(num_bytes, static_cast<int>((num_pages + 7) / 8)));
+    if (num_pages % 8 != 0 && free_map.size() == static_cast<size_t>((num_pages + 7) / 8)) {
+        free_map.back() &= static_cast<char>(0xff << (8 - num_pages % 8));
+    }
+    int count = 0;
+    for (char c : free_map) {
+        count += __builtin_popcount(static_cast<unsigned char>(c));
+    }
+    num_free_pages_[fd] = count;
+}
 
 bool DiskManager::is_dir(const std::string& path) {
     struct stat st;
@@ -97,8 +812,9 @@ bool DiskManager::is_file(const std::string &path) {
  * @description: 用于创建指定路径文件
  * @return {*}
  * @param {string} &path
+ * @param {bool} compressed 是否创建为压缩文件，此时同时创建空的页面位置表文件
  */
-void DiskManager::create_file(const std::string &path) {
+void DiskManager::create_file(const std::string &path, bool compressed) {
     if(this->is_file(path)) {  //判断文件是否已经存在，调用上方函数
         throw FileExistsError(path);
     }
@@ -107,6 +823,12 @@ void DiskManager::create_file(const std::string &path) {
         throw UnixError();
     }
     close(fd);
+    if(compressed) {
+        std::ofstream map(path + PAGE_MAP_SUFFIX, std::ios::binary | std::ios::trunc);
+        if(!map) {
+            throw UnixError();
+        }
+    }
     // Todo:
     // 调用open()函数，使用O_CREAT模式
     // 注意不能重复创建相同文件
@@ -126,6 +848,10 @@ void DiskManager::destroy_file(const std::string &path) {
     if(unlink(path.c_str()) < 0) {
         throw UnixError();
     }
+    std::string map_path = path + PAGE_MAP_SUFFIX;
+    if(this->is_file(map_path) && unlink(map_path.c_str()) < 0) {
+        throw UnixError();
+    }
     // Todo:
     // 调用unlink()函数
     // 注意不能删除未关闭的文件
@@ -137,17 +863,45 @@ void DiskManager::destroy_file(const std::string &path) {
  * @return {int} 返回打开的文件的文件句柄
  * @param {string} &path 文件所在路径
  */
-int DiskManager::open_file(const std::string &path) {
+int DiskManager::open_file(const std::string &path, bool read_only) {
     if(this->path2fd_.count(path)) {  // 已打开则不重复打开
         throw FileNotClosedError(path);
     }
     if(!this->is_file(path)) { // path是否正确
         throw FileNotFoundError(path);
     }
-    int fd = open(path.c_str(), O_RDWR);
+    // 存在页面位置表的文件是压缩文件，其数据块长度不定，不能使用O_DIRECT，也不映射到内存
+    bool compressed = this->is_file(path + PAGE_MAP_SUFFIX);
+    bool direct = this->direct_io_ && path != LOG_FILE_NAME && !read_only && !compressed;
+    int flags = read_only ? O_RDONLY : O_RDWR;
+    int fd = open(path.c_str(), flags | (direct ? O_DIRECT : 0));
+    if(fd < 0 && direct && errno == EINVAL) {  // 文件系统不支持O_DIRECT
+        direct = false;
+        fd = open(path.c_str(), flags);
+    }
     if(fd < 0) {
         throw UnixError();
     }
+    this->direct_fds_[fd] = direct;
+    if(compressed) {
+        try {
+            this->load_page_map(fd, path);
+        } catch (InternalError &) {
+            close(fd);
+            throw;
+        }
+    } else if(read_only) {
+        // 只读文件映射到内存，缓冲池直接返回指向映射的页面，不再复制到帧中；空文件无法映射，仍走普通读盘
+        struct stat st;
+        if(fstat(fd, &st) == 0 && st.st_size > 0) {
+            void *data = mmap(nullptr, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+            if(data != MAP_FAILED) {
+                this->mappings_[fd].data = static_cast<char *>(data);
+                this->mappings_[fd].size = st.st_size;
+                this->mappings_[fd].sequential = false;
+            }
+        }
+    }
     this->path2fd_[path] = fd;  //更新映射
     this->fd2path_[fd] = path;
     return fd;
@@ -165,10 +919,24 @@ void DiskManager::close_file(int fd) {
         throw FileNotOpenError(fd);
         return;
     }
+    this->flush_page_map(fd);
+    this->compressed_[fd].reset();
+    if(this->mappings_[fd].data != nullptr) {
+        munmap(this->mappings_[fd].data, this->mappings_[fd].size);
+        this->mappings_[fd].data = nullptr;
+        this->mappings_[fd].size = 0;
+    }
     if(close(fd) == -1) {
         throw UnixError();
         return;
     }
+    this->direct_fds_[fd] = false;
+    {
+        std::scoped_lock lock{free_latch_};
+        this->free_maps_[fd].clear();
+        this->num_free_pages_[fd] = 0;
+        this->fd2extent_[fd] = 0;
+    }
     auto it1 = path2fd_.find(this->get_file_name(fd)); //删除path2fd中相应的映射
     if (it1 != path2fd_.end()) {
         path2fd_.erase(it1);
@@ -195,6 +963,24 @@ int DiskManager::get_file_size(const std::string &file_name) {
     return rc == 0 ? stat_buf.st_size : -1;
 }
 
+/**
+ * @description: 获得文件中已写入的页面个数。普通文件按文件大小向上取整；
+ *               压缩文件的数据块不按页号存放，文件大小与页数无关，取页面位置表的长度
+ * @return {int} 页面个数
+ * @param {int} fd 文件句柄
+ */
+int DiskManager::get_file_num_pages(int fd) {
+    if (compressed_[fd] != nullptr) {
+        std::scoped_lock lock{compressed_[fd]->latch};
+        return static_cast<int>(compressed_[fd]->pages.size());
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        throw UnixError();
+    }
+    return static_cast<int>((st.st_size + PAGE_SIZE - 1) / PAGE_SIZE);
+}
+
 /**
  * @description: 根据文件句柄获得文件名
  * @return {string} 文件句柄对应文件的文件名
@@ -221,8 +1007,45 @@ int DiskManager::get_file_fd(const std::string &file_name) {
 
 
 /**
- * @description:  读取日志文件内容
- * @return {int} 返回读取的数据量，若为-1说明读取数据的起始位置超过了文件大小
+ * @description: 第一次读写日志时打开日志文件，并从文件大小初始化log_end_
+ */
+void DiskManager::open_log() {
+    std::scoped_lock lock{log_latch_};
+    if (log_fd_ != -1) {
+        return;
+    }
+    int fd = open_file(LOG_FILE_NAME);
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        throw UnixError();
+    }
+    log_end_ = st.st_size;
+    log_written_ = st.st_size;
+    log_fd_ = fd;
+}
+
+/**
+ * @description: write_log的pwrite完成后调用，把[begin, end)标记为已写入
+ *               多个线程预留的区间可能乱序写完，log_written_只在前面的日志都写完时连续前进
+ */
+void DiskManager::mark_log_written(int64_t begin, int64_t end) {
+    std::scoped_lock lock{log_latch_};
+    if (begin != log_written_) {
+        log_pending_.emplace(begin, end);
+        return;
+    }
+    int64_t written = end;
+    auto it = log_pending_.begin();
+    while (it != log_pending_.end() && it->first == written) {
+        written = it->second;
+        it = log_pending_.erase(it);
+    }
+    log_written_ = written;
+}
+
+/**
+ * @description:  读取日志文件内容，只读到已经写完的日志（log_written_），不会读到其他线程已预留但还没有写入的部分
+ * @return {int} 返回读取的数据量，若为-1说明读取数据的起始位置超过了已写入日志的长度
  * @param {char} *log_data 读取内容到log_data中
  * @param {int} size 读取的数据量大小
  * @param {int} offset 读取的内容在文件中的位置
@@ -230,36 +1053,75 @@ int DiskManager::get_file_fd(const std::string &file_name) {
 int DiskManager::read_log(char *log_data, int size, int offset) {
     // read log file from the previous end
     if (log_fd_ == -1) {
-        log_fd_ = open_file(LOG_FILE_NAME);
+        open_log();
     }
-    int file_size = get_file_size(LOG_FILE_NAME);
-    if (offset > file_size) {
+    int64_t written = log_written_;
+    if (offset > written) {
         return -1;
     }
 
-    size = std::min(size, file_size - offset);
-    if(size == 0) return 0;
-    lseek(log_fd_, offset, SEEK_SET);
-    ssize_t bytes_read = read(log_fd_, log_data, size);
-    assert(bytes_read == size);
+    size = static_cast<int>(std::min<int64_t>(size, written - offset));
+    int bytes_read = 0;
+    while (bytes_read < size) {
+        ssize_t bytes = pread(log_fd_, log_data + bytes_read, size - bytes_read, offset + bytes_read);
+        if (bytes < 0 && errno == EINTR) {
+            continue;
+        }
+        if (bytes < 0) {
+            throw UnixError();
+        }
+        if (bytes == 0) {  // 日志文件被外部截断
+            break;
+        }
+        bytes_read += bytes;
+    }
     return bytes_read;
 }
 
 
 /**
  * @description: 写日志内容
+ *               先原子地在log_end_上预留写入位置，再用pwrite写入，多个线程可以同时追加且不需要lseek；
+ *               写完后推进log_written_。pwrite只写入一部分时继续写剩余部分；出错时预留的区间无法补写，
+ *               之后的日志即使写成功也不会再对read_log可见，因此日志进入失败状态，之后的write_log直接抛出异常
  * @param {char} *log_data 要写入的日志内容
  * @param {int} size 要写入的内容大小
  */
 void DiskManager::write_log(char *log_data, int size) {
     if (log_fd_ == -1) {
-        log_fd_ = open_file(LOG_FILE_NAME);
+        open_log();
+    }
+    if (log_failed_) {
+        errno = EIO;
+        throw UnixError();
     }
 
     // write from the file_end
-    lseek(log_fd_, 0, SEEK_END);
-    ssize_t bytes_write = write(log_fd_, log_data, size);
-    if (bytes_write != size) {
+    off_t offset = log_end_.fetch_add(size);
+    ssize_t written = 0;
+    while (written < size) {
+        ssize_t bytes_write = pwrite(log_fd_, log_data + written, size - written, offset + written);
+        if (bytes_write == -1 && errno == EINTR) {
+            continue;
+        }
+        if (bytes_write <= 0) {
+            int err = bytes_write == 0 ? ENOSPC : errno;
+            log_failed_ = true;
+            errno = err;
+            throw UnixError();
+        }
+        written += bytes_write;
+    }
+    mark_log_written(offset, offset + size);
+}
+
+/**
+ * @description: 把已写入的日志持久化到磁盘，日志文件未打开时直接返回
+ *               fdatasync失败后无法确定哪些日志已经落盘，日志同样进入失败状态
+ */
+void DiskManager::sync_log() {
+    if (log_fd_ != -1 && fdatasync(log_fd_) != 0) {
+        log_failed_ = true;
         throw UnixError();
     }
-}
\ No newline at end of file
+}
@@ -0,0 +1,278 @@
+#pragma once
+
+#include <fcntl.h>     // for open
+#include <sys/mman.h>  // for mmap
+#include <sys/stat.h>  // for stat
+#include <unistd.h>    // for pread, pwrite
+
+#include <atomic>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "async_io.h"
+#include "common/config.h"
+#include "errors.h"
+#include "latency_histogram.h"
+
+/* DiskManager的读写统计，由get_stats()生成 */
+struct DiskStats {
+    uint64_t num_reads = 0;         // 读盘次数，read_pages中每次合并后的preadv计一次
+    uint64_t num_writes = 0;        // 写盘次数，write_pages中每次合并后的pwritev计一次
+    uint64_t bytes_read = 0;
+    uint64_t bytes_written = 0;
+    LatencyHistogram::Snapshot read_latency{};
+    LatencyHistogram::Snapshot write_latency{};
+};
+
+/**
+ * @description: DiskManager的作用主要是根据上层的需要对磁盘文件进行操作
+ */
+class DiskManager {
+   public:
+    explicit DiskManager();
+
+    ~DiskManager() = default;
+
+    void write_page(int fd, page_id_t page_no, const char *offset, int num_bytes);
+
+    void read_page(int fd, page_id_t page_no, char *offset, int num_bytes);
+
+    void read_pages(int fd, const std::vector<std::pair<page_id_t, char *>> &pages);
+
+    void write_pages(int fd, const std::vector<std::pair<page_id_t, const char *>> &pages);
+
+    void async_read_pages(int fd, const std::vector<std::pair<page_id_t, char *>> &pages,
+                          std::function<void(bool)> callback);
+
+    void async_write_pages(int fd, const std::vector<std::pair<page_id_t, const char *>> &pages,
+                           std::function<void(bool)> callback);
+
+    /**
+     * @description: 启用异步读写后端：优先使用io_uring，不可用时退回线程池；未启用时async_*接口同步执行
+     * @param {unsigned} queue_depth 同时在途的最大请求数
+     */
+    void enable_async_io(unsigned queue_depth = 64) { async_io_ = AsyncIO::create(queue_depth); }
+
+    const char *async_io_backend() const { return async_io_ == nullptr ? "sync" : async_io_->name(); }
+
+    page_id_t allocate_page(int fd);
+
+    void deallocate_page(int fd, page_id_t page_no);
+
+    int truncate_free_pages(int fd);
+
+    /**
+     * @description: 获得文件的空闲页位图，第i位（按字节从高位到低位）为1表示第i页已被释放，可被allocate_page复用
+     *               位图覆盖[0, get_fd2pageno(fd))，由文件头持久化，打开文件时通过set_free_page_map恢复
+     */
+    std::vector<char> get_free_page_map(int fd);
+
+    void set_free_page_map(int fd, const char *map, int num_bytes);
+
+    int get_num_free_pages(int fd) { return num_free_pages_[fd]; }
+
+    /*目录操作*/
+    bool is_dir(const std::string &path);
+
+    void create_dir(const std::string &path);
+
+    void destroy_dir(const std::string &path);
+
+    /*文件操作*/
+    bool is_file(const std::string &path);
+
+    void create_file(const std::string &path, bool compressed = false);
+
+    void destroy_file(const std::string &path);
+
+    int open_file(const std::string &path, bool read_only = false);
+
+    void close_file(int fd);
+
+    int get_file_size(const std::string &file_name);
+
+    int get_file_num_pages(int fd);
+
+    std::string get_file_name(int fd);
+
+    int get_file_fd(const std::string &file_name);
+
+    /**
+     * @description: 设置之后打开的数据文件是否使用O_DIRECT，绕过内核页缓存，使缓冲池成为唯一的缓存
+     *               日志文件不受影响；文件系统不支持O_DIRECT时自动退回普通模式
+     */
+    void set_direct_io(bool enable) { direct_io_ = enable; }
+
+    bool is_direct_io(int fd) const { return direct_fds_[fd]; }
+
+    /**
+     * @description: 设置文件增长时每次预分配的页面个数，为0时关闭预分配
+     *               allocate_page分配到已预分配范围之外时，用fallocate一次为之后的num_pages个页面分配磁盘空间，
+     *               不改变文件大小；之后的追加写入落在已分配的连续空间中，不再逐页分配磁盘块和更新元数据
+     */
+    void set_extent_size(int num_pages) { extent_size_ = num_pages; }
+
+    int get_extent_size() const { return extent_size_; }
+
+    /**
+     * @description: 文件是否为压缩文件（create_file时指定）：每个页面写入时压缩，按变长数据块存放在数据文件中，
+     *               页号到数据块位置的映射保存在同名的PAGE_MAP_SUFFIX文件中；读写接口对上层透明
+     *               页面总是写到新的数据块（不覆盖磁盘上的位置表仍引用的块），写完后才更新位置，
+     *               被替换的数据块在下一次flush_page_map持久化新的位置表之后才会被复用，崩溃后按旧位置表读出的页面仍然完整
+     */
+    bool is_compressed(int fd) const { return compressed_[fd] != nullptr; }
+
+    void flush_page_map(int fd);
+
+    static constexpr const char *PAGE_MAP_SUFFIX = ".pmap";
+
+    /**
+     * @description: 文件是否以只读方式打开并映射到了内存，这样的文件由缓冲池直接返回指向映射的页面视图
+     */
+    bool is_mapped(int fd) const { return mappings_[fd].data != nullptr; }
+
+    char *get_mapped_page(int fd, page_id_t page_no) const;
+
+    void advise_sequential(int fd);
+
+    void advise_willneed(int fd, page_id_t start_page_no, int num_pages);
+
+    /*日志操作*/
+    int read_log(char *log_data, int size, int offset);
+
+    void write_log(char *log_data, int size);
+
+    void sync_log();
+
+    // 日志文件当前的长度，即下一次write_log写入的位置
+    int64_t get_log_size() const { return log_end_; }
+
+    // 日志写入或同步曾经失败，此后的日志不再写入，需要重新设置日志文件
+    bool is_log_failed() const { return log_failed_; }
+
+    void SetLogFd(int log_fd) {
+        log_end_ = lseek(log_fd, 0, SEEK_END);
+        log_written_ = log_end_.load();
+        {
+            std::scoped_lock lock{log_latch_};
+            log_pending_.clear();
+        }
+        log_failed_ = false;
+        log_fd_ = log_fd;
+    }
+
+    int GetLogFd() { return log_fd_; }
+
+    /**
+     * @description: 设置文件已经分配的页面个数
+     * @param {int} fd 文件对应的文件句柄
+     * @param {int} start_page_no 已经分配的页面个数，即文件接下来从start_page_no开始分配页面编号
+     */
+    void set_fd2pageno(int fd, int start_page_no) { fd2pageno_[fd] = start_page_no; }
+
+    /**
+     * @description: 获得文件目前已分配的页面个数，即如果文件要分配一个新页面，需要从fd2pagenp_[fd]开始分配
+     * @return {page_id_t} 已分配的页面个数
+     * @param {int} fd 文件对应的句柄
+     */
+    page_id_t get_fd2pageno(int fd) { return fd2pageno_[fd]; }
+
+    DiskStats get_stats() const;
+
+    static constexpr int MAX_FD = 8192;
+
+   private:
+    void direct_write_unaligned(int fd, page_id_t page_no, const char *offset, int num_bytes);
+
+    void direct_read_unaligned(int fd, page_id_t page_no, char *offset, int num_bytes);
+
+    void extend_file(int fd, page_id_t page_no);
+
+    void open_log();
+
+    void mark_log_written(int64_t begin, int64_t end);
+
+    void load_page_map(int fd, const std::string &path);
+
+    void write_compressed_page(int fd, page_id_t page_no, const char *offset, int num_bytes);
+
+    void read_compressed_pages(int fd, const std::vector<std::pair<page_id_t, char *>> &pages);
+
+    void submit_pages(int fd, const std::vector<std::pair<page_id_t, char *>> &pages, bool is_write,
+                      std::function<void(bool)> callback);
+
+    // 文件打开列表，用于记录文件是否被打开
+    std::unordered_map<std::string, int> path2fd_;  //<Page文件磁盘路径,Page fd>哈希表
+    std::unordered_map<int, std::string> fd2path_;  //<Page fd,Page文件磁盘路径>哈希表
+
+    std::atomic<int> log_fd_{-1};                 // WAL日志文件的文件句柄，默认为-1，代表未打开日志文件
+    std::atomic<int64_t> log_end_{0};             // 日志文件的长度，打开日志时从文件大小初始化，write_log按此偏移追加
+    std::atomic<int64_t> log_written_{0};         // [0, log_written_)中的日志都已pwrite完成，read_log只读到这里
+    std::atomic<bool> log_failed_{false};         // 日志写入失败，log_written_不会再前进，之后的write_log直接抛出异常
+    std::mutex log_latch_;                        // 串行化日志文件的打开，并保护log_pending_
+    std::map<int64_t, int64_t> log_pending_;      // 已写完但前面还有未写完的日志的区间：起始偏移 -> 结束偏移
+    std::atomic<page_id_t> fd2pageno_[MAX_FD]{};  // 文件中已经分配的页面个数，初始值为0
+
+    // 已释放页面的位图，allocate_page优先复用其中页号最小的页面；close_file时清空
+    std::mutex free_latch_;                         // 保护free_maps_、num_free_pages_、fd2extent_，以及分配和截断时的fd2pageno_
+    std::vector<char> free_maps_[MAX_FD];
+    std::atomic<int> num_free_pages_[MAX_FD]{};
+
+    // 文件增长时按区（extent）预分配磁盘空间
+    std::atomic<int> extent_size_{64};              // 每次预分配的页面个数，为0时不预分配
+    page_id_t fd2extent_[MAX_FD]{};                 // 文件中已预分配到的页号（不含），打开文件时为0
+
+    bool direct_io_ = false;        // 新打开的数据文件是否使用O_DIRECT
+    bool direct_fds_[MAX_FD]{};     // 以O_DIRECT打开的文件，其读写的缓冲区、长度和偏移都需要按PAGE_SIZE对齐
+
+    // 只读打开的文件在打开时整体映射到内存（PROT_READ），关闭时解除映射
+    struct FileMapping {
+        char *data = nullptr;
+        size_t size = 0;
+        std::atomic<bool> sequential{false};   // 是否已对整个映射设置MADV_SEQUENTIAL
+    };
+    FileMapping mappings_[MAX_FD];
+
+    // 压缩文件中一个页面的数据块；length为0表示页面从未写入，等于PAGE_SIZE表示页面不可压缩、按原样存放
+    struct CompressedPage {
+        uint64_t offset = 0;
+        uint32_t length = 0;
+        uint32_t capacity = 0;      // 数据块占用的空间，按COMPRESSED_ALIGN向上取整
+    };
+    // 压缩文件的页面位置表，打开文件时从PAGE_MAP_SUFFIX文件读入，flush_page_map或关闭文件时写回
+    struct CompressedFile {
+        std::mutex latch;               // 保护pages、end、free_blocks、released和dirty
+        std::shared_mutex read_latch;   // 读者从取位置到读完数据块期间持有共享锁；回收数据块前独占获取，正在读的块不会被复用
+        std::shared_mutex write_latch;  // 整页写入持有共享锁；部分写入是读-改-写，持有独占锁
+        std::mutex flush_latch;         // 串行化flush_page_map，旧的位置表不会覆盖新的
+        std::vector<CompressedPage> pages;
+        std::multimap<uint32_t, uint64_t> free_blocks;  // 可复用的数据块：capacity -> offset
+        std::vector<CompressedPage> released;           // 被替换下来、磁盘上的位置表可能仍引用的数据块
+        uint64_t end = 0;               // 数据文件中已使用空间的末尾，没有合适的空闲块时在此追加
+        bool dirty = false;
+    };
+    static constexpr uint32_t COMPRESSED_ALIGN = 32;
+    std::unique_ptr<CompressedFile> compressed_[MAX_FD];
+
+    CompressedPage allocate_block(CompressedFile &file, int length);
+
+    // 读写统计，均为无锁计数
+    std::atomic<uint64_t> num_reads_{0};
+    std::atomic<uint64_t> num_writes_{0};
+    std::atomic<uint64_t> bytes_read_{0};
+    std::atomic<uint64_t> bytes_written_{0};
+    LatencyHistogram read_latency_;
+    LatencyHistogram write_latency_;
+
+    // 异步读写后端，最后声明以便最先析构：析构时等待在途请求完成，它们的回调还会更新上面的统计
+    std::unique_ptr<AsyncIO> async_io_;
+};
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+/* 无锁的延迟直方图：第i个桶统计耗时在[2^(i-1), 2^i)微秒内的样本数，第0个桶统计不足1微秒的样本 */
+class LatencyHistogram {
+   public:
+    static constexpr size_t NUM_BUCKETS = 32;
+
+    using Snapshot = std::array<uint64_t, NUM_BUCKETS>;
+
+    void record(std::chrono::nanoseconds latency) {
+        uint64_t us = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(latency).count());
+        size_t bucket = us == 0 ? 0 : 64 - __builtin_clzll(us);
+        if (bucket >= NUM_BUCKETS) {
+            bucket = NUM_BUCKETS - 1;
+        }
+        buckets_[bucket].fetch_add(1, std::memory_order_relaxed);
+    }
+
+    /**
+     * @description: 把当前各个桶的计数累加到snapshot中，用于合并多个分片的直方图
+     */
+    void add_to(Snapshot *snapshot) const {
+        for (size_t i = 0; i < NUM_BUCKETS; i++) {
+            (*snapshot)[i] += buckets_[i].load(std::memory_order_relaxed);
+        }
+    }
+
+    /**
+     * @description: 估算分位数
+     * @return {uint64_t} 分位数所在桶的上界（微秒），没有样本时返回0
+     * @param {double} quantile 取值(0, 1]，如0.99表示p99
+     */
+    static uint64_t percentile(const Snapshot &snapshot, double quantile) {
+        uint64_t total = 0;
+        for (uint64_t count : snapshot) {
+            total += count;
+        }
+        if (total == 0) {
+            return 0;
+        }
+        uint64_t target = static_cast<uint64_t>(quantile * total);
+        uint64_t seen = 0;
+        for (size_t i = 0; i < NUM_BUCKETS; i++) {
+            seen += snapshot[i];
+            if (seen >= target && snapshot[i] != 0) {
+                return 1ULL << i;
+            }
+        }
+        return 1ULL << (NUM_BUCKETS - 1);
+    }
+
+   private:
+    std::array<std::atomic<uint64_t>, NUM_BUCKETS> buckets_{};
+};
+
+/* 作用域计时器：析构时把经过的时间记录到直方图中 */
+class LatencyTimer {
+   public:
+    explicit LatencyTimer(LatencyHistogram *histogram)
+        : histogram_(histogram), start_(std::chrono::steady_clock::now()) {}
+
+    ~LatencyTimer() { histogram_->record(std::chrono::steady_clock::now() - start_); }
+
+   private:
+    LatencyHistogram *histogram_;
+    std::chrono::steady_clock::time_point start_;
+};
@@ -0,0 +1,135 @@
+#include "log_writer.h"
+
+#include <string.h>
+
+#include "errors.h"
+
+LogWriter::LogWriter(DiskManager *disk_manager, size_t buffer_size, std::chrono::milliseconds flush_interval)
+    : disk_manager_(disk_manager), flush_interval_(flush_interval) {
+    buffers_[0].resize(buffer_size);
+    buffers_[1].resize(buffer_size);
+    // 读一次日志以打开日志文件，使偏移从已有日志的末尾开始
+    char unused;
+    disk_manager_->read_log(&unused, 0, 0);
+    appended_offset_ = durable_offset_ = disk_manager_->get_log_size();
+    flusher_ = std::thread(&LogWriter::flush_loop, this);
+}
+
+/**
+ * @description: 停止后台线程，缓冲区中剩余的日志在退出前写盘
+ */
+LogWriter::~LogWriter() {
+    {
+        std::scoped_lock lock{latch_};
+        running_ = false;
+    }
+    flush_cv_.notify_one();
+    flusher_.join();
+}
+
+/**
+ * @description: 把一条日志追加到活动缓冲区，不等待写盘
+ * @return {uint64_t} 该日志在日志流中的结束偏移，传给wait_durable可等待其持久化
+ */
+uint64_t LogWriter::append(const char *log_data, int size) {
+    std::unique_lock lock{latch_};
+    if (failed_) {
+        throw InternalError("LogWriter::append: log write failed");
+    }
+    std::vector<char> &active = buffers_[active_];
+    if (static_cast<size_t>(size) > active.size()) {
+        // 比整个缓冲区还大的日志：等活动缓冲区清空后扩大它
+        space_cv_.wait(lock, [this] { return active_size_ == 0 || failed_; });
+        buffers_[active_].resize(size);
+    }
+    while (active_size_ + size > buffers_[active_].size() && !failed_) {
+        flush_cv_.notify_one();
+        space_cv_.wait(lock);
+    }
+    if (failed_) {
+        throw InternalError("LogWriter::append: log write failed");
+    }
+    memcpy(buffers_[active_].data() + active_size_, log_data, size);
+    active_size_ += size;
+    appended_offset_ += size;
+    if (active_size_ >= buffers_[active_].size() / 2) {
+        flush_cv_.notify_one();
+    }
+    return appended_offset_;
+}
+
+/**
+ * @description: 等待日志流中offset之前的日志全部写盘并fdatasync
+ *               后台线程正在写盘时，期间到来的等待者会被下一次写盘一起处理
+ */
+void LogWriter::wait_durable(uint64_t offset) {
+    std::unique_lock lock{latch_};
+    if (durable_offset_ >= offset) {
+        return;
+    }
+    num_waiters_++;
+    flush_cv_.notify_one();
+    durable_cv_.wait(lock, [this, offset] { return durable_offset_ >= offset || failed_; });
+    num_waiters_--;
+    if (durable_offset_ < offset) {
+        throw InternalError("LogWriter::wait_durable: log write failed");
+    }
+}
+
+uint64_t LogWriter::get_appended_offset() {
+    std::scoped_lock lock{latch_};
+    return appended_offset_;
+}
+
+uint64_t LogWriter::get_durable_offset() {
+    std::scoped_lock lock{latch_};
+    return durable_offset_;
+}
+
+uint64_t LogWriter::get_num_syncs() {
+    std::scoped_lock lock{latch_};
+    return num_syncs_;
+}
+
+/**
+ * @description: 后台线程主循环：有事务等待提交、缓冲区过半或到达flush_interval_时交换缓冲区并写盘
+ */
+void LogWriter::flush_loop() {
+    std::unique_lock lock{latch_};
+    while (true) {
+        flush_cv_.wait_for(lock, flush_interval_, [this] {
+            return !running_ || (active_size_ > 0 && (num_waiters_ > 0 || active_size_ >= buffers_[active_].size() / 2));
+        });
+        if (active_size_ == 0 || failed_) {
+            if (!running_) {
+                return;
+            }
+            continue;
+        }
+        int flushing = active_;
+        size_t size = active_size_;
+        uint64_t end = appended_offset_;
+        active_ = 1 - active_;
+        active_size_ = 0;
+        space_cv_.notify_all();
+
+        lock.unlock();
+        bool ok = true;
+        try {
+            disk_manager_->write_log(buffers_[flushing].data(), static_cast<int>(size));
+            disk_manager_->sync_log();
+        } catch (UnixError &) {
+            ok = false;
+        }
+        lock.lock();
+
+        if (ok) {
+            durable_offset_ = end;
+            num_syncs_++;
+        } else {
+            failed_ = true;
+            space_cv_.notify_all();
+        }
+        durable_cv_.notify_all();
+    }
+}
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "disk_manager.h"
+
+/**
+ * @description: 组提交（group commit）日志写入器
+ *               日志先追加到内存中的活动缓冲区；后台线程把活动缓冲区与待写缓冲区交换后，在不持有latch_的情况下
+ *               把待写缓冲区写入日志文件并fdatasync，期间新的日志继续追加到另一个缓冲区
+ *               提交的事务在wait_durable中等待，一次写盘和fdatasync之前追加的所有日志一起持久化，
+ *               并发提交的事务越多，平均每次提交分摊的fdatasync越少
+ */
+class LogWriter {
+   public:
+    /**
+     * @param buffer_size 每个缓冲区的初始大小，活动缓冲区放不下新的日志时追加者等待后台线程交换缓冲区
+     * @param flush_interval 没有事务等待提交时，后台线程至少每隔flush_interval把缓冲区中的日志写盘一次
+     */
+    explicit LogWriter(DiskManager *disk_manager, size_t buffer_size = 1 << 20,
+                       std::chrono::milliseconds flush_interval = std::chrono::milliseconds(10));
+
+    ~LogWriter();
+
+    uint64_t append(const char *log_data, int size);
+
+    void wait_durable(uint64_t offset);
+
+    /**
+     * @description: 追加一条提交日志并等待其持久化
+     * @return {uint64_t} 该日志在日志流中的结束偏移
+     */
+    uint64_t commit(const char *log_data, int size) {
+        uint64_t offset = append(log_data, size);
+        wait_durable(offset);
+        return offset;
+    }
+
+    void flush() { wait_durable(get_appended_offset()); }
+
+    uint64_t get_appended_offset();
+
+    uint64_t get_durable_offset();
+
+    // 后台线程写盘（每次一个write_log加一个fdatasync）的次数
+    uint64_t get_num_syncs();
+
+   private:
+    void flush_loop();
+
+    DiskManager *disk_manager_;
+    std::chrono::milliseconds flush_interval_;
+
+    std::mutex latch_;                      // 保护以下所有成员
+    std::condition_variable flush_cv_;      // 通知后台线程有事务在等待或缓冲区快满了
+    std::condition_variable space_cv_;      // 后台线程交换缓冲区后通知等待空间的追加者
+    std::condition_variable durable_cv_;    // durable_offset_前进时通知等待提交的事务
+    std::vector<char> buffers_[2];
+    int active_ = 0;                        // 正在接收追加的缓冲区，另一个缓冲区正在写盘或空闲
+    size_t active_size_ = 0;
+    uint64_t appended_offset_ = 0;          // 日志流中已追加的字节数，从构造时的日志文件长度开始计
+    uint64_t durable_offset_ = 0;           // 日志流中已写盘并fdatasync的字节数
+    size_t num_waiters_ = 0;                // 在wait_durable中等待的事务数
+    uint64_t num_syncs_ = 0;
+    bool running_ = true;
+    bool failed_ = false;                   // 写盘出错后不再写入，等待者抛出异常
+
+    std::thread flusher_;
+};
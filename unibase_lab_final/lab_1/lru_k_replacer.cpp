@@ -0,0 +1,103 @@
+#include "lru_k_replacer.h"
+
+LRUKReplacer::LRUKReplacer(size_t num_pages, size_t k)
+    : k_(k), history_(num_pages * k, 0), access_count_(num_pages, 0), next_slot_(num_pages, 0), evictable_(num_pages, 0),
+      cold_(num_pages, 0) {}
+
+/**
+ * @description: 淘汰backward k-distance最大的帧，冷帧最先淘汰，其次是访问不足k次的帧
+ * @param {frame_id_t*} frame_id 被移除的frame的id
+ * @return {bool} 如果成功淘汰了一个页面则返回true，否则返回false
+ */
+bool LRUKReplacer::victim(frame_id_t* frame_id) {
+    if (size_ == 0) {
+        return false;
+    }
+    bool found = false;
+    int found_rank = 0;         // 已找到的候选的类别：0为冷帧，1为访问不足k次，2为访问满k次，小的先淘汰
+    size_t oldest = 0;
+    frame_id_t candidate = 0;
+    for (size_t i = 0; i < evictable_.size(); ++i) {
+        if (!evictable_[i]) {
+            continue;
+        }
+        bool is_inf = access_count_[i] < k_;
+        int rank = cold_[i] ? 0 : (is_inf ? 1 : 2);
+        // 冷帧和不足k次时槽0就是放入或最早一次访问的时间；满k次时下一个要覆盖的槽就是倒数第k次访问
+        size_t ts = history_[i * k_ + (is_inf ? 0 : next_slot_[i])];
+        if (!found || rank < found_rank || (rank == found_rank && ts < oldest)) {
+            found = true;
+            found_rank = rank;
+            oldest = ts;
+            candidate = static_cast<frame_id_t>(i);
+        }
+    }
+    evictable_[candidate] = 0;
+    access_count_[candidate] = 0;
+    next_slot_[candidate] = 0;
+    cold_[candidate] = 0;
+    size_--;
+    *frame_id = candidate;
+    return true;
+}
+
+/**
+ * @description: 固定指定的frame并记录一次访问
+ * @param {frame_id_t} 需要固定的frame的id
+ */
+void LRUKReplacer::pin(frame_id_t frame_id) {
+    record_access(frame_id);
+    if (evictable_[frame_id]) {
+        evictable_[frame_id] = 0;
+        size_--;
+    }
+}
+
+/**
+ * @description: 取消固定一个frame，代表该页面可以被淘汰
+ * @param {frame_id_t} frame_id 取消固定的frame的id
+ */
+void LRUKReplacer::unpin(frame_id_t frame_id) {
+    if (!evictable_[frame_id]) {
+        evictable_[frame_id] = 1;
+        size_++;
+        return;
+    }
+    // 已可淘汰说明该帧经无锁命中路径被访问过，补记这次访问
+    record_access(frame_id);
+}
+
+/**
+ * @description: 在帧的访问历史中记录一次访问，被访问过的帧不再是冷帧
+ * @param {frame_id_t} frame_id 被访问的frame的id
+ */
+void LRUKReplacer::record_access(frame_id_t frame_id) {
+    cold_[frame_id] = 0;
+    history_[frame_id * k_ + next_slot_[frame_id]] = ++current_timestamp_;
+    next_slot_[frame_id] = (next_slot_[frame_id] + 1) % k_;
+    if (access_count_[frame_id] < k_) {
+        access_count_[frame_id]++;
+    }
+}
+
+/**
+ * @description: 取消固定一个冷帧，使其先于其他帧被淘汰；冷帧之间按放入的时间先进先出，
+ *               连续预读的页面不会在被消费之前就被后放入的冷帧挤掉
+ *               不经过unpin：帧已可淘汰时unpin会补记一次访问，访问次数达到k后就不再是冷帧
+ * @param {frame_id_t} frame_id 取消固定的frame的id
+ */
+void LRUKReplacer::unpin_cold(frame_id_t frame_id) {
+    access_count_[frame_id] = 1;
+    next_slot_[frame_id] = 1 % k_;
+    history_[frame_id * k_] = ++current_timestamp_;
+    cold_[frame_id] = 1;
+    if (!evictable_[frame_id]) {
+        evictable_[frame_id] = 1;
+        size_++;
+    }
+}
+
+/**
+ * @description: 获取当前replacer中可以被淘汰的页面数量
+ */
+size_t LRUKReplacer::Size() { return size_; }
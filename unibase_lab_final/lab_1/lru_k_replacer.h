@@ -0,0 +1,43 @@
+#pragma once
+
+#include <vector>
+
+#include "common/config.h"
+#include "replacer/replacer.h"
+
+/**
+ * LRUKReplacer implements the LRU-K replacement policy.
+ * 淘汰backward k-distance（当前时间与倒数第k次访问时间之差）最大的帧；
+ * 访问次数不足k次的帧距离视为无穷大，它们之间按最早一次访问时间做LRU。
+ * unpin_cold放入的冷帧在这两类之前淘汰，冷帧之间按放入的先后顺序淘汰。
+ * 每个帧的访问历史保存在构造时分配好的环形数组中。
+ * 本类不持有自己的锁，调用方（BufferPoolManager）需要在持有latch_时调用。
+ */
+class LRUKReplacer : public Replacer {
+   public:
+    LRUKReplacer(size_t num_pages, size_t k = 2);
+
+    ~LRUKReplacer() = default;
+
+    bool victim(frame_id_t *frame_id);
+
+    void pin(frame_id_t frame_id);
+
+    void unpin(frame_id_t frame_id);
+
+    void unpin_cold(frame_id_t frame_id);
+
+    size_t Size();
+
+   private:
+    void record_access(frame_id_t frame_id);
+
+    size_t k_;
+    size_t current_timestamp_ = 0;
+    std::vector<size_t> history_;       // 第frame_id * k_开始的k_个元素为该帧最近k次访问的时间戳
+    std::vector<size_t> access_count_;  // 每个帧被访问的次数（最多记录到k_）
+    std::vector<size_t> next_slot_;     // 环形数组中下一次写入的位置
+    std::vector<char> evictable_;
+    std::vector<char> cold_;            // 经unpin_cold放入且之后没有再被访问的帧，槽0记录放入的时间
+    size_t size_ = 0;
+};
@@ -1,18 +1,25 @@
 #include "lru_replacer.h"
 
-LRUReplacer::LRUReplacer(size_t num_pages) { max_size_ = num_pages; }
+LRUReplacer::LRUReplacer(size_t num_pages) : in_cold_(num_pages, 0) { max_size_ = num_pages; }
 
 LRUReplacer::~LRUReplacer() = default;  
 
 /**
- * @description: 使用LRU策略删除一个victim frame，并返回该frame的id
+ * @description: 使用LRU策略删除一个victim frame，并返回该frame的id；有冷帧时先淘汰最早放入的冷帧
  * @param {frame_id_t*} frame_id 被移除的frame的id，如果没有frame被移除返回nullptr
  * @return {bool} 如果成功淘汰了一个页面则返回true，否则返回false
  */
 bool LRUReplacer::victim(frame_id_t* frame_id) {
     // C++17 std::scoped_lock
     // 它能够避免死锁发生，其构造函数能够自动进行上锁操作，析构函数会对互斥量进行解锁操作，保证线程安全。
-    std::socped_lock lock{latch_};  //  如果编译报错可以替换成其他lock
+    std::scoped_lock lock{latch_};
+    if(!this->cold_list_.empty()) {
+        *frame_id = this->cold_list_.front();
+        this->cold_list_.pop_front();
+        this->in_cold_[*frame_id] = 0;
+        this->LRUhash_.erase(*frame_id);
+        return true;
+    }
     if(this->LRUlist_.empty()){
         frame_id = nullptr;
         return false;
@@ -38,8 +45,9 @@ void LRUReplacer::pin(frame_id_t frame_id) {
     std::scoped_lock lock{latch_};
     auto find = this->LRUhash_.find(frame_id);
     if(find != this->LRUhash_.end()){
-        this->LRUlist_.erase(find->second);
+        this->list_of(frame_id).erase(find->second);
         this->LRUhash_.erase(find);
+        this->in_cold_[frame_id] = 0;
     }
     // Todo:
     // 固定指定id的frame
@@ -54,16 +62,39 @@ void LRUReplacer::unpin(frame_id_t frame_id) {
     std::scoped_lock lock{latch_};
 
     auto find = LRUhash_.find(frame_id);
-    if(find == LRUhash_.end()) {
-        LRUlist_.push_front(frame_id);
-        LRUhash_[frame_id] = LRUlist_.begin();
+    if(find != LRUhash_.end()) {
+        // 已在链表中说明该帧经无锁命中路径被访问过，移到头部记录这次访问；冷帧被访问后不再是冷帧
+        // 用splice移动原有结点，命中路径上每次unpin不再申请和释放链表结点
+        LRUlist_.splice(LRUlist_.begin(), list_of(frame_id), find->second);
+        in_cold_[frame_id] = 0;
+        return;
     }
+    LRUlist_.push_front(frame_id);
+    LRUhash_[frame_id] = LRUlist_.begin();
     // Todo:
     //  支持并发锁
     //  选择一个frame取消固定
 }
 
+/**
+ * @description: 取消固定一个冷帧，放在冷帧链表尾部，先于LRUlist_中的帧被淘汰；已在某个链表中时移到冷帧链表尾部
+ * @param {frame_id_t} frame_id 取消固定的frame的id
+ */
+void LRUReplacer::unpin_cold(frame_id_t frame_id) {
+    std::scoped_lock lock{latch_};
+
+    auto find = LRUhash_.find(frame_id);
+    if(find != LRUhash_.end()) {
+        cold_list_.splice(cold_list_.end(), list_of(frame_id), find->second);
+        in_cold_[frame_id] = 1;
+        return;
+    }
+    cold_list_.push_back(frame_id);
+    LRUhash_[frame_id] = std::prev(cold_list_.end());
+    in_cold_[frame_id] = 1;
+}
+
 /**
  * @description: 获取当前replacer中可以被淘汰的页面数量
  */
-size_t LRUReplacer::Size() { return LRUlist_.size(); }
+size_t LRUReplacer::Size() { return LRUlist_.size() + cold_list_.size(); }
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <list>
+#include <mutex>  // NOLINT
+#include <unordered_map>
+#include <vector>
+
+#include "common/config.h"
+#include "replacer/replacer.h"
+
+/**
+ * LRUReplacer implements the Least Recently Used replacement policy.
+ */
+class LRUReplacer : public Replacer {
+   public:
+    /**
+     * Create a new LRUReplacer.
+     * @param num_pages the maximum number of pages the LRUReplacer will be required to store
+     */
+    explicit LRUReplacer(size_t num_pages);
+
+    ~LRUReplacer();
+
+    bool victim(frame_id_t *frame_id);
+
+    void pin(frame_id_t frame_id);
+
+    void unpin(frame_id_t frame_id);
+
+    void unpin_cold(frame_id_t frame_id);
+
+    size_t Size();
+
+   private:
+    std::list<frame_id_t> &list_of(frame_id_t frame_id) { return in_cold_[frame_id] ? cold_list_ : LRUlist_; }
+
+    std::mutex latch_;                  // 互斥锁
+    std::list<frame_id_t> LRUlist_;     // 按加入的时间顺序存放unpinned pages的frame id，首部表示最近被访问
+    // 冷帧链表：unpin_cold放入的帧按放入的先后顺序排列，victim优先从首部淘汰，之后才淘汰LRUlist_中的帧
+    // 冷帧之间按先进先出淘汰，连续预读放入的页面不会在被消费之前就被后放入的冷帧挤掉
+    std::list<frame_id_t> cold_list_;
+    std::unordered_map<frame_id_t, std::list<frame_id_t>::iterator> LRUhash_;   // frame_id_t -> 该帧在LRUlist_或cold_list_中的位置
+    std::vector<char> in_cold_;         // frame是否在cold_list_中
+    size_t max_size_;   // 最大容量（与缓冲池的容量相同）
+};
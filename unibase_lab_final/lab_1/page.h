@@ -0,0 +1,105 @@
+#pragma once
+
+#include <atomic>
+#include <cstring>
+#include <shared_mutex>
+#include <string>
+
+#include "common/config.h"
+
+/**
+ * @description: 存储层每个Page的id的声明
+ */
+struct PageId {
+    int fd;  //  Page所在的磁盘文件开启后的文件描述符, 来定位打开的文件在内存中的位置
+    page_id_t page_no = INVALID_PAGE_ID;
+
+    friend bool operator==(const PageId &x, const PageId &y) { return x.fd == y.fd && x.page_no == y.page_no; }
+    bool operator<(const PageId& x) const {
+        if(fd < x.fd) return true;
+        return page_no < x.page_no;
+    }
+
+    std::string toString() {
+        return "{fd: " + std::to_string(fd) + " page_no: " + std::to_string(page_no) + "}"; 
+    }
+
+    inline int64_t Get() const {
+        return (static_cast<int64_t>(fd << 16) | page_no);
+    }
+};
+
+// PageId的自定义哈希算法, 用于构建unordered_map<PageId, frame_id_t, PageIdHash>
+struct PageIdHash {
+    size_t operator()(const PageId &x) const { return (x.fd << 16) | x.page_no; }
+};
+
+template <>
+struct std::hash<PageId> {
+    size_t operator()(const PageId &obj) const { return std::hash<int64_t>()(obj.Get()); }
+};
+
+/**
+ * @description: Page类声明, Page是RMDB数据块的单位、是负责数据操作Record模块的操作对象，
+ * Page对象在磁盘上有文件存储, 若在Buffer中则有帧偏移, 并非特指Buffer或Disk上的数据
+ * 页面数据不在Page对象内部，而是指向BufferPoolManager统一申请的按页对齐的帧内存（arena）中，
+ * 这样帧内存可以使用透明大页，并能直接用于O_DIRECT读写
+ */
+class Page {
+    friend class BufferPoolManager;
+
+   public:
+    
+    Page() = default;
+
+    ~Page() = default;
+
+    PageId get_page_id() const { return id_; }
+
+    inline char *get_data() { return data_; }
+
+    bool is_dirty() const { return is_dirty_; }
+
+    static constexpr size_t OFFSET_PAGE_START = 0;
+    static constexpr size_t OFFSET_LSN = 0;
+    static constexpr size_t OFFSET_PAGE_HDR = 4;
+
+    inline lsn_t get_page_lsn() { return *reinterpret_cast<lsn_t *>(get_data() + OFFSET_LSN) ; }
+
+    inline void set_page_lsn(lsn_t page_lsn) { memcpy(get_data() + OFFSET_LSN, &page_lsn, sizeof(lsn_t)); }
+
+    /** 是否为只读映射文件的页面视图：数据直接指向文件的内存映射，不属于任何帧，不能修改 */
+    bool is_mapped() const { return is_mapped_; }
+
+    /** 页面读写锁，保护页面数据；调用前页面必须已被固定。一般通过ReadPageGuard/WritePageGuard使用 */
+    void rlatch() { rwlatch_.lock_shared(); }
+
+    void runlatch() { rwlatch_.unlock_shared(); }
+
+    void wlatch() { rwlatch_.lock(); }
+
+    void wunlatch() { rwlatch_.unlock(); }
+
+   private:
+    // pin_count_为该值时，帧空闲或正在被替换为另一个页面，无锁命中路径不能固定它
+    static constexpr int PIN_COUNT_EVICTING = -1;
+
+    void reset_memory() { memset(data_, OFFSET_PAGE_START, PAGE_SIZE); }  // 将data_的PAGE_SIZE个字节填充为0
+
+    /** page的唯一标识符 */
+    PageId id_;
+
+    /** 该页面在bufferPool中的偏移地址，指向arena中属于本帧的PAGE_SIZE字节 */
+    char *data_ = nullptr;
+
+    /** 脏页判断，无锁unpin时也会写入 */
+    std::atomic<bool> is_dirty_{false};
+
+    /** The pin count of this page. 无锁命中路径用CAS增加，取值PIN_COUNT_EVICTING时不能固定 */
+    std::atomic<int> pin_count_{0};
+
+    /** 页面数据的读写锁 */
+    std::shared_mutex rwlatch_;
+
+    bool is_mapped_ = false;
+};
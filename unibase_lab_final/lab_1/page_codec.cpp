@@ -0,0 +1,155 @@
+#include "page_codec.h"
+
+#include <string.h>
+
+namespace {
+
+uint32_t read32(const uint8_t *p) {
+    uint32_t value;
+    memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+// 写入长度中超过15的部分：若干个255，最后一个字节小于255
+bool write_length(uint8_t **out, uint8_t *out_end, int length) {
+    while (length >= 255) {
+        if (*out >= out_end) {
+            return false;
+        }
+        *(*out)++ = 255;
+        length -= 255;
+    }
+    if (*out >= out_end) {
+        return false;
+    }
+    *(*out)++ = static_cast<uint8_t>(length);
+    return true;
+}
+
+bool read_length(const uint8_t **in, const uint8_t *in_end, int *length) {
+    while (true) {
+        if (*in >= in_end) {
+            return false;
+        }
+        uint8_t byte = *(*in)++;
+        *length += byte;
+        if (byte != 255) {
+            return true;
+        }
+    }
+}
+
+}  // namespace
+
+/**
+ * @description: 输出一个序列，match_len为0表示最后一个只有字面量的序列
+ * @return {bool} 输出缓冲区不够时返回false
+ */
+bool PageCodec::emit_sequence(uint8_t **out, uint8_t *out_end, const uint8_t *literals, int num_literals, int offset,
+                              int match_len) {
+    if (*out >= out_end) {
+        return false;
+    }
+    uint8_t *token = (*out)++;
+    int match_code = match_len == 0 ? 0 : match_len - MIN_MATCH;
+    *token = static_cast<uint8_t>((num_literals < 15 ? num_literals : 15) << 4 | (match_code < 15 ? match_code : 15));
+    if (num_literals >= 15 && !write_length(out, out_end, num_literals - 15)) {
+        return false;
+    }
+    if (out_end - *out < num_literals) {
+        return false;
+    }
+    memcpy(*out, literals, num_literals);
+    *out += num_literals;
+    if (match_len == 0) {
+        return true;
+    }
+    if (out_end - *out < 2) {
+        return false;
+    }
+    *(*out)++ = static_cast<uint8_t>(offset);
+    *(*out)++ = static_cast<uint8_t>(offset >> 8);
+    return match_code < 15 || write_length(out, out_end, match_code - 15);
+}
+
+int PageCodec::compress(const char *src, int src_len, char *dst, int dst_cap) {
+    const uint8_t *in = reinterpret_cast<const uint8_t *>(src);
+    uint8_t *out = reinterpret_cast<uint8_t *>(dst);
+    uint8_t *out_end = out + dst_cap;
+    // 哈希表记录每个4字节序列最近出现的位置
+    int table[1 << HASH_BITS];
+    memset(table, -1, sizeof(table));
+
+    int anchor = 0;  // 尚未输出的字面量的起点
+    int pos = 0;
+    while (pos + MIN_MATCH <= src_len) {
+        uint32_t sequence = read32(in + pos);
+        uint32_t hash = (sequence * 2654435761u) >> (32 - HASH_BITS);
+        int candidate = table[hash];
+        table[hash] = pos;
+        if (candidate < 0 || pos - candidate > MAX_OFFSET || read32(in + candidate) != sequence) {
+            pos++;
+            continue;
+        }
+        // 匹配可以和当前位置重叠（距离小于长度），解压时逐字节向前复制即可还原连续的重复内容
+        int match_len = MIN_MATCH;
+        while (pos + match_len < src_len && in[candidate + match_len] == in[pos + match_len]) {
+            match_len++;
+        }
+        if (!emit_sequence(&out, out_end, in + anchor, pos - anchor, pos - candidate, match_len)) {
+            return 0;
+        }
+        pos += match_len;
+        anchor = pos;
+    }
+    if (!emit_sequence(&out, out_end, in + anchor, src_len - anchor, 0, 0)) {
+        return 0;
+    }
+    return static_cast<int>(out - reinterpret_cast<uint8_t *>(dst));
+}
+
+int PageCodec::decompress(const char *src, int src_len, char *dst, int dst_len) {
+    const uint8_t *in = reinterpret_cast<const uint8_t *>(src);
+    const uint8_t *in_end = in + src_len;
+    uint8_t *out_start = reinterpret_cast<uint8_t *>(dst);
+    uint8_t *out = out_start;
+    uint8_t *out_end = out + dst_len;
+    while (in < in_end) {
+        uint8_t token = *in++;
+        int num_literals = token >> 4;
+        if (num_literals == 15 && !read_length(&in, in_end, &num_literals)) {
+            return -1;
+        }
+        if (in_end - in < num_literals || out_end - out < num_literals) {
+            return -1;
+        }
+        memcpy(out, in, num_literals);
+        in += num_literals;
+        out += num_literals;
+        if (in == in_end) {
+            break;  // 最后一个序列
+        }
+        if (in_end - in < 2) {
+            return -1;
+        }
+        int offset = in[0] | in[1] << 8;
+        in += 2;
+        int match_len = (token & 15) + MIN_MATCH;
+        if ((token & 15) == 15 && !read_length(&in, in_end, &match_len)) {
+            return -1;
+        }
+        if (offset == 0 || offset > out - out_start || out_end - out < match_len) {
+            return -1;
+        }
+        const uint8_t *match = out - offset;
+        if (offset >= match_len) {
+            memcpy(out, match, match_len);
+            out += match_len;
+        } else {
+            for (int i = 0; i < match_len; i++) {
+                *out++ = match[i];
+            }
+        }
+    }
+    return static_cast<int>(out - out_start);
+}
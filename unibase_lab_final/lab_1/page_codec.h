@@ -0,0 +1,33 @@
+#pragma once
+
+#include <cstdint>
+
+/**
+ * @description: 页面压缩使用的LZ77类编解码器，格式与LZ4块格式类似，不依赖外部库
+ *               每个序列由一个token字节开始：高4位为字面量长度，低4位为匹配长度减MIN_MATCH，取15时后面跟扩展长度字节；
+ *               token之后是字面量，再之后是2字节小端的匹配距离；最后一个序列只有字面量
+ *               填充0的CHAR(n)字段和空闲slot会变成很长的匹配，压缩率很高
+ */
+class PageCodec {
+   public:
+    static constexpr int MIN_MATCH = 4;
+    static constexpr int MAX_OFFSET = 65535;
+
+    /**
+     * @description: 压缩src中的src_len字节
+     * @return {int} 压缩后的字节数；压缩结果超过dst_cap（即数据不可压缩）时返回0
+     */
+    static int compress(const char *src, int src_len, char *dst, int dst_cap);
+
+    /**
+     * @description: 解压src中的src_len字节到dst
+     * @return {int} 解压出的字节数；数据损坏或超过dst_len时返回-1
+     */
+    static int decompress(const char *src, int src_len, char *dst, int dst_len);
+
+   private:
+    static constexpr int HASH_BITS = 12;
+
+    static bool emit_sequence(uint8_t **out, uint8_t *out_end, const uint8_t *literals, int num_literals,
+                              int offset, int match_len);
+};
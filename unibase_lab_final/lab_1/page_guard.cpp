@@ -0,0 +1,74 @@
+#include "page_guard.h"
+
+#include "buffer_pool_manager.h"
+
+BasicPageGuard::BasicPageGuard(BasicPageGuard &&other) noexcept
+    : bpm_(other.bpm_), page_(other.page_), is_dirty_(other.is_dirty_) {
+    other.bpm_ = nullptr;
+    other.page_ = nullptr;
+    other.is_dirty_ = false;
+}
+
+BasicPageGuard &BasicPageGuard::operator=(BasicPageGuard &&other) noexcept {
+    if (this != &other) {
+        drop();
+        bpm_ = other.bpm_;
+        page_ = other.page_;
+        is_dirty_ = other.is_dirty_;
+        other.bpm_ = nullptr;
+        other.page_ = nullptr;
+        other.is_dirty_ = false;
+    }
+    return *this;
+}
+
+/**
+ * @description: 提前释放守卫持有的固定，之后守卫无效；可以重复调用
+ */
+void BasicPageGuard::drop() {
+    if (page_ == nullptr) {
+        return;
+    }
+    bpm_->unpin_page(page_, is_dirty_);
+    bpm_ = nullptr;
+    page_ = nullptr;
+    is_dirty_ = false;
+}
+
+ReadPageGuard &ReadPageGuard::operator=(ReadPageGuard &&other) noexcept {
+    if (this != &other) {
+        drop();
+        guard_ = std::move(other.guard_);
+    }
+    return *this;
+}
+
+/**
+ * @description: 释放读锁和固定
+ */
+void ReadPageGuard::drop() {
+    if (!guard_.is_valid()) {
+        return;
+    }
+    guard_.get_page()->runlatch();
+    guard_.drop();
+}
+
+WritePageGuard &WritePageGuard::operator=(WritePageGuard &&other) noexcept {
+    if (this != &other) {
+        drop();
+        guard_ = std::move(other.guard_);
+    }
+    return *this;
+}
+
+/**
+ * @description: 释放写锁和固定，页面在unpin时被标记为脏页
+ */
+void WritePageGuard::drop() {
+    if (!guard_.is_valid()) {
+        return;
+    }
+    guard_.get_page()->wunlatch();
+    guard_.drop();
+}
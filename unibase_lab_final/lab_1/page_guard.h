@@ -0,0 +1,112 @@
+#pragma once
+
+#include "page.h"
+
+class BufferPoolManager;
+
+/**
+ * @description: 页面守卫，持有页面的一次固定（pin），析构或drop()时自动unpin，避免固定计数泄露
+ *               只固定、不加页面读写锁，用于已由更上层的锁保证互斥的场景（如B+树的root_latch_）
+ *               守卫只能移动不能复制；获取页面失败（缓冲池没有可用帧）时守卫无效，is_valid()返回false
+ */
+class BasicPageGuard {
+   public:
+    BasicPageGuard() = default;
+
+    BasicPageGuard(BufferPoolManager *bpm, Page *page) : bpm_(bpm), page_(page) {}
+
+    BasicPageGuard(const BasicPageGuard &) = delete;
+
+    BasicPageGuard &operator=(const BasicPageGuard &) = delete;
+
+    BasicPageGuard(BasicPageGuard &&other) noexcept;
+
+    BasicPageGuard &operator=(BasicPageGuard &&other) noexcept;
+
+    ~BasicPageGuard() { drop(); }
+
+    void drop();
+
+    bool is_valid() const { return page_ != nullptr; }
+
+    Page *get_page() const { return page_; }
+
+    PageId get_page_id() const { return page_->get_page_id(); }
+
+    const char *get_data() const { return page_->get_data(); }
+
+    // 获取可修改的页面数据，释放时会把页面标记为脏页
+    char *get_data_mut() {
+        is_dirty_ = true;
+        return page_->get_data();
+    }
+
+    void mark_dirty() { is_dirty_ = true; }
+
+   private:
+    BufferPoolManager *bpm_ = nullptr;
+    Page *page_ = nullptr;
+    bool is_dirty_ = false;
+};
+
+/**
+ * @description: 读页面守卫，持有页面的固定和共享读锁，多个读者可以同时读同一页面
+ *               释放时先解锁再unpin
+ */
+class ReadPageGuard {
+   public:
+    ReadPageGuard() = default;
+
+    // page需已被固定且已加读锁
+    ReadPageGuard(BufferPoolManager *bpm, Page *page) : guard_(bpm, page) {}
+
+    ReadPageGuard(ReadPageGuard &&other) noexcept = default;
+
+    ReadPageGuard &operator=(ReadPageGuard &&other) noexcept;
+
+    ~ReadPageGuard() { drop(); }
+
+    void drop();
+
+    bool is_valid() const { return guard_.is_valid(); }
+
+    Page *get_page() const { return guard_.get_page(); }
+
+    PageId get_page_id() const { return guard_.get_page_id(); }
+
+    const char *get_data() const { return guard_.get_data(); }
+
+   private:
+    BasicPageGuard guard_;
+};
+
+/**
+ * @description: 写页面守卫，持有页面的固定和独占写锁；持有写守卫即视为会修改页面，释放时把页面标记为脏页
+ *               释放时先解锁再unpin
+ */
+class WritePageGuard {
+   public:
+    WritePageGuard() = default;
+
+    // page需已被固定且已加写锁
+    WritePageGuard(BufferPoolManager *bpm, Page *page) : guard_(bpm, page) { guard_.mark_dirty(); }
+
+    WritePageGuard(WritePageGuard &&other) noexcept = default;
+
+    WritePageGuard &operator=(WritePageGuard &&other) noexcept;
+
+    ~WritePageGuard() { drop(); }
+
+    void drop();
+
+    bool is_valid() const { return guard_.is_valid(); }
+
+    Page *get_page() const { return guard_.get_page(); }
+
+    PageId get_page_id() const { return guard_.get_page_id(); }
+
+    char *get_data() { return guard_.get_data_mut(); }
+
+   private:
+    BasicPageGuard guard_;
+};
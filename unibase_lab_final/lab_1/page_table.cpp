@@ -0,0 +1,88 @@
+#include "page_table.h"
+
+PageTable::PageTable(size_t num_frames) {
+    size_t capacity = 2;
+    int bits = 1;
+    while (capacity < num_frames * 2) {
+        capacity <<= 1;
+        bits++;
+    }
+    slots_ = std::vector<Slot>(capacity);
+    mask_ = capacity - 1;
+    shift_ = 64 - bits;
+}
+
+/**
+ * @description: 查找页面所在的帧
+ * @return {bool} 页面在表中则返回true
+ * @param {PageId} page_id 目标页面
+ * @param {frame_id_t*} frame_id 返回页面所在的帧号
+ */
+bool PageTable::find(PageId page_id, frame_id_t *frame_id) const {
+    uint64_t key = make_key(page_id);
+    // 容量至少为帧数的两倍，表中总有空槽，探测一定会结束
+    for (size_t i = home_slot(key);; i = (i + 1) & mask_) {
+        const Slot &slot = slots_[i];
+        uint64_t slot_key = slot.key.load(std::memory_order_acquire);
+        if (slot_key == key) {
+            *frame_id = slot.frame_id.load(std::memory_order_relaxed);
+            // 无锁读时该槽可能刚被清空
+            return *frame_id != INVALID_FRAME_ID;
+        }
+        if (slot_key == EMPTY_KEY) {
+            return false;
+        }
+    }
+}
+
+/**
+ * @description: 插入或更新页面到帧的映射，表中的元素个数不会超过帧数，因此一定能找到空槽
+ * @param {PageId} page_id 目标页面
+ * @param {frame_id_t} frame_id 页面所在的帧号
+ */
+void PageTable::insert(PageId page_id, frame_id_t frame_id) {
+    uint64_t key = make_key(page_id);
+    for (size_t i = home_slot(key);; i = (i + 1) & mask_) {
+        Slot &slot = slots_[i];
+        uint64_t slot_key = slot.key.load(std::memory_order_relaxed);
+        if (slot_key == key) {
+            slot.frame_id.store(frame_id, std::memory_order_release);
+            return;
+        }
+        if (slot_key == EMPTY_KEY) {
+            set_slot(slot, key, frame_id);
+            size_++;
+            return;
+        }
+    }
+}
+
+/**
+ * @description: 删除页面的映射，并把同一探测链上后面的元素前移，保证查找不会提前遇到空槽
+ * @return {bool} 页面在表中则返回true
+ * @param {PageId} page_id 目标页面
+ */
+bool PageTable::erase(PageId page_id) {
+    uint64_t key = make_key(page_id);
+    size_t hole = home_slot(key);
+    while (slots_[hole].key.load(std::memory_order_relaxed) != key) {
+        if (slots_[hole].key.load(std::memory_order_relaxed) == EMPTY_KEY) {
+            return false;
+        }
+        hole = (hole + 1) & mask_;
+    }
+    uint64_t slot_key;
+    for (size_t i = (hole + 1) & mask_; (slot_key = slots_[i].key.load(std::memory_order_relaxed)) != EMPTY_KEY;
+         i = (i + 1) & mask_) {
+        size_t home = home_slot(slot_key);
+        // 若home不在(hole, i]的环形区间内，说明slots_[i]可以移到hole
+        bool movable = hole <= i ? (home <= hole || home > i) : (home <= hole && home > i);
+        if (movable) {
+            set_slot(slots_[hole], slot_key, slots_[i].frame_id.load(std::memory_order_relaxed));
+            hole = i;
+        }
+    }
+    set_slot(slots_[hole], EMPTY_KEY, INVALID_FRAME_ID);
+    size_--;
+    return true;
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+#include "common/config.h"
+#include "page.h"
+
+/**
+ * PageTable是缓冲池专用的定长开放寻址哈希表，记录PageId到帧号的映射。
+ * 容量在构造时由帧数确定（不小于帧数的两倍且为2的幂），运行期间不再申请内存；
+ * 采用线性探测，删除时向前移动后续元素（backward shift），不使用墓碑。
+ * 本类不持有自己的锁，insert和erase由BufferPoolManager在持有latch_时调用；
+ * find可以不加锁与写者并发执行，此时可能漏找（删除时正在移动元素）或返回已过期的帧号，
+ * 调用方需要在固定帧之后校验帧中的PageId，失败时退回加锁路径。
+ */
+class PageTable {
+   public:
+    explicit PageTable(size_t num_frames);
+
+    bool find(PageId page_id, frame_id_t *frame_id) const;
+
+    void insert(PageId page_id, frame_id_t frame_id);
+
+    bool erase(PageId page_id);
+
+    size_t size() const { return size_; }
+
+   private:
+    static constexpr uint64_t EMPTY_KEY = ~0ULL;    // fd和page_no都为-1，不会是合法的PageId
+
+    // 槽的两个字段都是原子变量：写者（持有latch_）与无锁读者并发时，读者只会读到某一时刻的旧值或新值
+    struct Slot {
+        std::atomic<uint64_t> key{EMPTY_KEY};               // (fd << 32) | page_no，EMPTY_KEY表示空槽
+        std::atomic<frame_id_t> frame_id{INVALID_FRAME_ID};
+    };
+
+    void set_slot(Slot &slot, uint64_t key, frame_id_t frame_id) {
+        slot.frame_id.store(frame_id, std::memory_order_relaxed);
+        slot.key.store(key, std::memory_order_release);
+    }
+
+    static uint64_t make_key(PageId page_id) {
+        return (static_cast<uint64_t>(static_cast<uint32_t>(page_id.fd)) << 32) |
+               static_cast<uint32_t>(page_id.page_no);
+    }
+
+    // Fibonacci hashing，取乘积的高位作为槽号
+    size_t home_slot(uint64_t key) const { return static_cast<size_t>((key * 0x9E3779B97F4A7C15ULL) >> shift_); }
+
+    std::vector<Slot> slots_;
+    size_t mask_;
+    int shift_;
+    size_t size_ = 0;
+};
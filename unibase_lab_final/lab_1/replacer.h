@@ -0,0 +1,48 @@
+#pragma once
+
+#include "common/config.h"
+
+/* buffer pool可选的置换策略，在BufferPoolManager构造时指定 */
+enum class ReplacerType { LRU, CLOCK, LRU_K };
+
+/**
+ * Replacer is an abstract class that tracks page usage.
+ */
+class Replacer {
+   public:
+    Replacer() = default;
+    virtual ~Replacer() = default;
+
+    /**
+     * @description: 根据置换策略选择一个可以淘汰的帧
+     * @param {frame_id_t*} frame_id 被淘汰的帧的id
+     * @return {bool} 如果找到了可以淘汰的帧则返回true，否则返回false
+     */
+    virtual bool victim(frame_id_t *frame_id) = 0;
+
+    /**
+     * @description: 固定一个帧，该帧不能被淘汰
+     * @param {frame_id_t} frame_id 需要固定的帧的id
+     */
+    virtual void pin(frame_id_t frame_id) = 0;
+
+    /**
+     * @description: 取消固定一个帧，该帧可以被淘汰
+     *               帧已在replacer中时，说明它经缓冲池的无锁命中路径被访问过（该路径不调用pin），
+     *               此时应记录一次访问，而不是忽略
+     * @param {frame_id_t} frame_id 取消固定的帧的id
+     */
+    virtual void unpin(frame_id_t frame_id) = 0;
+
+    /**
+     * @description: 取消固定一个只被顺序扫描访问过的帧，把它放在最先被淘汰的位置，
+     *               使大范围扫描只循环使用少量帧，而不会冲刷掉热点页面
+     * @param {frame_id_t} frame_id 取消固定的帧的id
+     */
+    virtual void unpin_cold(frame_id_t frame_id) = 0;
+
+    /**
+     * @description: 获取当前可以被淘汰的帧的数量
+     */
+    virtual size_t Size() = 0;
+};
@@ -1,5 +1,7 @@
 #include "rm_file_handle.h"
 
+#include <algorithm>
+
 /**
  * @description: 获取当前表中记录号为rid的记录
  * @param {Rid&} rid 记录号，指定记录的位置
@@ -10,14 +12,23 @@ std::unique_ptr<RmRecord> RmFileHandle::get_record(const Rid& rid, Context* cont
     // Todo:
     // 1. 获取指定记录所在的page handle
     // 2. 初始化一个指向RmRecord的指针（赋值其内部的data和size）
-    auto page_handle = fetch_page_handle(rid.page_no); // 取指定记录所在的page handle
-    auto record = std::make_unique<RmRecord>(file_hdr_.record_size);
+    return get_record_view(rid).to_record();
+}
+
+/**
+ * @description: 获取记录号为rid的记录的只读视图，不复制记录；视图析构前页面保持固定和读锁
+ * @param {Rid&} rid 记录号，指定记录的位置
+ * @param {AccessPattern} pattern 访问模式，顺序扫描传入SEQUENTIAL
+ * @return {RmRecordView} 指向缓冲池中该记录的视图
+ */
+RmRecordView RmFileHandle::get_record_view(const Rid& rid, AccessPattern pattern) const {
+    ReadPageGuard guard = fetch_page_read(rid.page_no, pattern);    // 守卫随视图析构时自动解锁并unpin
+    RmPageHandle page_handle(&file_hdr_, guard.get_page()); // 取指定记录所在的page handle
     if(!Bitmap::is_set(page_handle.bitmap, rid.slot_no)) {  // 是否找到record
         throw RecordNotFoundError(rid.page_no, rid.slot_no);
     }
-    memcpy(record->data, page_handle.get_slot(rid.slot_no), file_hdr_.record_size);  // .get_slot()返回位于slot_no的record的地址
-    record->size = file_hdr_.record_size;
-    return record;
+    const char *data = page_handle.get_slot(rid.slot_no);  // .get_slot()返回位于slot_no的record的地址
+    return RmRecordView(std::move(guard), data, file_hdr_.record_size);
 }
 
 /**
@@ -33,7 +44,8 @@ Rid RmFileHandle::insert_record(char* buf, Context* context) {
     // 3. 将buf复制到空闲slot位置
     // 4. 更新page_handle.page_hdr中的数据结构
     // 注意考虑插入一条记录后页面已满的情况，需要更新file_hdr_.first_free_page_no
-RmPageHandle page_handle = create_page_handle(); // 创建或获取一个空闲的page handle
+    WritePageGuard guard = create_free_page();  // 创建或获取一个空闲页面，守卫释放时标脏并unpin
+    RmPageHandle page_handle(&file_hdr_, guard.get_page());
     int free_slot = Bitmap::first_bit(false, page_handle.bitmap, file_hdr_.num_records_per_page);  // 获取空闲的slot
     //false表示找到第一个未设置的比特位，传入page_handle的位图和该页最大记录数。Bitmap::first_bit会扫描位图，找到第一个为0的slot位。即查找页面中第一个空闲的记录槽位，并返回该空闲slot的序号。
     memcpy(page_handle.get_slot(free_slot), buf, file_hdr_.record_size);
@@ -46,6 +58,47 @@ RmPageHandle page_handle = create_page_handle(); // 创建或获取一个空闲
     return Rid{page_handle.page->get_page_id().page_no, free_slot};
 }
 
+/**
+ * @description: 在当前表中批量插入记录，不指定插入位置
+ *               每个页面只固定一次并填满：页面中每段连续的空闲slot用一次memcpy写入、用Bitmap::set_range一次置位，
+ *               新建的页面整页只有一段空闲slot；已有的空闲页面用完后连续追加新页面
+ * @param {char*} bufs 要插入的记录的数据，num_records条记录依次连续存放，每条长度为file_hdr_.record_size
+ * @param {int} num_records 要插入的记录条数
+ * @param {Context*} context
+ * @return {vector<Rid>} 按bufs中的顺序返回每条记录的记录号
+ */
+std::vector<Rid> RmFileHandle::insert_records(const char* bufs, int num_records, Context* context) {
+    std::vector<Rid> rids;
+    rids.reserve(num_records);
+    const int record_size = file_hdr_.record_size;
+    const int num_slots = file_hdr_.num_records_per_page;
+    int inserted = 0;
+    while (inserted < num_records) {
+        WritePageGuard guard = create_free_page();  // 先用空闲页面链表中的页面，用完后追加新页面
+        RmPageHandle page_handle(&file_hdr_, guard.get_page());
+        int page_no = page_handle.page->get_page_id().page_no;
+        int begin = Bitmap::first_bit(false, page_handle.bitmap, num_slots);
+        while (begin < num_slots && inserted < num_records) {
+            // [begin, end)是一段连续的空闲slot
+            int end = Bitmap::next_bit(true, page_handle.bitmap, num_slots, begin);
+            end = std::min(end, begin + (num_records - inserted));
+            memcpy(page_handle.get_slot(begin), bufs + static_cast<size_t>(inserted) * record_size,
+                   static_cast<size_t>(end - begin) * record_size);
+            Bitmap::set_range(page_handle.bitmap, begin, end);
+            for (int slot_no = begin; slot_no < end; slot_no++) {
+                rids.push_back(Rid{page_no, slot_no});
+            }
+            page_handle.page_hdr->num_records += end - begin;
+            inserted += end - begin;
+            begin = Bitmap::next_bit(false, page_handle.bitmap, num_slots, end - 1);
+        }
+        if (begin >= num_slots) {  // 满了，以bitmap为准判断，不依赖num_records
+            file_hdr_.first_free_page_no = page_handle.page_hdr->next_free_page_no;
+        }
+    }
+    return rids;
+}
+
 /**
  * @description: 在当前表中的指定位置插入一条记录
  * @param {Rid&} rid 要插入记录的位置
@@ -53,9 +106,10 @@ RmPageHandle page_handle = create_page_handle(); // 创建或获取一个空闲
  */
 void RmFileHandle::insert_record(const Rid& rid, char* buf) {
     if (rid.page_no < file_hdr_.num_pages) {
-        create_new_page_handle();
+        create_new_page();
     }
-    RmPageHandle pageHandle = fetch_page_handle(rid.page_no);
+    WritePageGuard guard = fetch_page_write(rid.page_no);
+    RmPageHandle pageHandle(&file_hdr_, guard.get_page());
     Bitmap::set(pageHandle.bitmap, rid.slot_no);
     pageHandle.page_hdr->num_records++;
     if (pageHandle.page_hdr->num_records == file_hdr_.num_records_per_page) {
@@ -64,8 +118,6 @@ void RmFileHandle::insert_record(const Rid& rid, char* buf) {
 
     char *slot = pageHandle.get_slot(rid.slot_no);
     memcpy(slot, buf, file_hdr_.record_size);
-
-    buffer_pool_manager_->unpin_page(pageHandle.page->get_page_id(), true);
 }
 
 /**
@@ -78,18 +130,18 @@ void RmFileHandle::delete_record(const Rid& rid, Context* context) {
     // 1. 获取指定记录所在的page handle
     // 2. 更新page_handle.page_hdr中的数据结构
     // 注意考虑删除一条记录后页面未满的情况，需要调用release_page_handle()
-    RmPageHandle page_handle = fetch_page_handle(rid.page_no);
+    WritePageGuard guard = fetch_page_write(rid.page_no);
+    RmPageHandle page_handle(&file_hdr_, guard.get_page());
     if(!Bitmap::is_set(page_handle.bitmap, rid.slot_no)) {
-      throw PageNotExistError("a`", rid.page_no);
+      throw PageNotExistError(disk_manager_->get_file_name(fd_), rid.page_no);
     }
     // Okay, remember modifying the bitmap!
     Bitmap::reset(page_handle.bitmap, rid.slot_no);
-    if(page_handle.page_hdr->num_records == file_hdr_.num_records_per_page) {
-        page_handle.page_hdr->num_records--;
-    } else {
-        return;
+    bool was_full = page_handle.page_hdr->num_records == file_hdr_.num_records_per_page;
+    page_handle.page_hdr->num_records--;
+    if(was_full) {
+        release_page_handle(page_handle);  // 页面从已满变为未满，重新挂到空闲页面链表上
     }
-    release_page_handle(page_handle);
 }
 
 
@@ -103,10 +155,11 @@ void RmFileHandle::update_record(const Rid& rid, char* buf, Context* context) {
     // Todo:
     // 1. 获取指定记录所在的page handle
     // 2. 更新记录
-    RmPageHandle page_handle = fetch_page_handle(rid.page_no);
+    WritePageGuard guard = fetch_page_write(rid.page_no);
+    RmPageHandle page_handle(&file_hdr_, guard.get_page());
     // bitmap, bitmap, bitmap!
     if(!Bitmap::is_set(page_handle.bitmap, rid.slot_no)) {
-        throw PageNotExistError("a`", rid.page_no);
+        throw PageNotExistError(disk_manager_->get_file_name(fd_), rid.page_no);
     }
     memcpy(page_handle.get_slot(rid.slot_no), buf, file_hdr_.record_size);
 }
@@ -115,60 +168,87 @@ void RmFileHandle::update_record(const Rid& rid, char* buf, Context* context) {
  * 以下函数为辅助函数，仅提供参考，可以选择完成如下函数，也可以删除如下函数，在单元测试中不涉及如下函数接口的直接调用
 */
 /**
- * @description: 获取指定页面的页面句柄
+ * @description: 获取指定页面并加读锁
  * @param {int} page_no 页面号
- * @return {RmPageHandle} 指定页面的句柄
+ * @param {AccessPattern} pattern 访问模式，顺序扫描传入SEQUENTIAL
+ * @return {ReadPageGuard} 指定页面的读守卫，析构时自动解锁并unpin
  */
-RmPageHandle RmFileHandle::fetch_page_handle(int page_no) const {
+ReadPageGuard RmFileHandle::fetch_page_read(int page_no, AccessPattern pattern) const {
     // Todo:
     // 使用缓冲池获取指定页面，并生成page_handle返回给上层
     // if page_no is invalid, throw PageNotExistError exception
     if(page_no >= file_hdr_.num_pages) {
-        throw PageNotExistError("a`", page_no);
+        throw PageNotExistError(disk_manager_->get_file_name(fd_), page_no);
+    }
+    return this->buffer_pool_manager_->fetch_page_read({this->fd_, page_no}, pattern);
+}
+
+/**
+ * @description: 找出指定页面中所有存放了记录的slot，整页只固定一次；读完bitmap后立即unpin
+ * @param {int} page_no 页面号
+ * @param {vector<int>*} slots 传出参数，按递增顺序存放该页中所有记录的slot_no，原有内容被清空
+ * @param {AccessPattern} pattern 访问模式，顺序扫描传入SEQUENTIAL
+ */
+void RmFileHandle::scan_page(int page_no, std::vector<int> *slots, AccessPattern pattern) const {
+    slots->clear();
+    ReadPageGuard guard = fetch_page_read(page_no, pattern);
+    RmPageHandle page_handle(&file_hdr_, guard.get_page());
+    // 以bitmap为准，不信任页头的num_records：两者不一致时也不会越界或漏掉记录
+    slots->reserve(page_handle.page_hdr->num_records);
+    Bitmap::for_each_set(page_handle.bitmap, file_hdr_.num_records_per_page,
+                         [slots](int slot_no) { slots->push_back(slot_no); });
+}
+
+/**
+ * @description: 获取指定页面并加写锁
+ * @param {int} page_no 页面号
+ * @return {WritePageGuard} 指定页面的写守卫，析构时自动解锁、标脏并unpin
+ */
+WritePageGuard RmFileHandle::fetch_page_write(int page_no) const {
+    if(page_no >= file_hdr_.num_pages) {
+        throw PageNotExistError(disk_manager_->get_file_name(fd_), page_no);
     }
-    return RmPageHandle(&file_hdr_, this->buffer_pool_manager_->fetch_page({this->fd_, page_no}));
+    return this->buffer_pool_manager_->fetch_page_write({this->fd_, page_no});
 }
 
 /**
- * @description: 创建一个新的page handle
- * @return {RmPageHandle} 新的PageHandle
+ * @description: 创建一个新的页面，并初始化其页头
+ * @return {WritePageGuard} 新页面的写守卫
  */
-RmPageHandle RmFileHandle::create_new_page_handle() {
+WritePageGuard RmFileHandle::create_new_page() {
     // Todo:
     // 1.使用缓冲池来创建一个新page
     // 2.更新page handle中的相关信息
     // 3.更新file_hdr_
 
     PageId page_id = {this->fd_, INVALID_PAGE_ID}; // 0 or this->fd_, Not sure.
-    Page* neo_page = this->buffer_pool_manager_->new_page(&page_id);
-    auto page_handle = RmPageHandle(&file_hdr_, neo_page);
-    if(neo_page != nullptr) {
-        RmPageHandle page_handle(&file_hdr_, neo_page);
+    WritePageGuard guard = this->buffer_pool_manager_->new_page_write(&page_id);
+    if(guard.is_valid()) {
+        RmPageHandle page_handle(&file_hdr_, guard.get_page());
         page_handle.page_hdr->num_records = 0;
         page_handle.page_hdr->next_free_page_no = RM_NO_PAGE;
         file_hdr_.num_pages++;
         file_hdr_.first_free_page_no = page_id.page_no;
     }
-    return page_handle;
+    return guard;
 }
 
 /**
- * @brief 创建或获取一个空闲的page handle
+ * @brief 创建或获取一个空闲页面
  *
- * @return RmPageHandle 返回生成的空闲page handle
- * @note pin the page, remember to unpin it outside!
+ * @return WritePageGuard 空闲页面的写守卫，析构时自动unpin
  */
-RmPageHandle RmFileHandle::create_page_handle() {
+WritePageGuard RmFileHandle::create_free_page() {
     // Todo:
     // 1. 判断file_hdr_中是否还有空闲页
-    //     1.1 没有空闲页：使用缓冲池来创建一个新page；可直接调用create_new_page_handle()
+    //     1.1 没有空闲页：使用缓冲池来创建一个新page；可直接调用create_new_page()
     //     1.2 有空闲页：直接获取第一个空闲页
     // 2. 生成page handle并返回给上层
 
     if(this->file_hdr_.first_free_page_no == RM_NO_PAGE){
-        return create_new_page_handle();
+        return create_new_page();
     }
-    return fetch_page_handle(this->file_hdr_.first_free_page_no);
+    return fetch_page_write(this->file_hdr_.first_free_page_no);
 }
 
 /**
@@ -180,5 +260,5 @@ void RmFileHandle::release_page_handle(RmPageHandle&page_handle) {
     // 1. page_handle.page_hdr->next_free_page_no
     // 2. file_hdr_.first_free_page_no
     page_handle.page_hdr->next_free_page_no = file_hdr_.first_free_page_no;
-    file_hdr_.first_free_page_no = page_handle.page_hdr->next_free_page_no;
+    file_hdr_.first_free_page_no = page_handle.page->get_page_id().page_no;
 }
\ No newline at end of file
@@ -0,0 +1,140 @@
+#pragma once
+
+#include <assert.h>
+
+#include <memory>
+#include <vector>
+
+#include "bitmap.h"
+#include "common/context.h"
+#include "rm_defs.h"
+
+class RmManager;
+
+/* 对表数据文件中的页面进行封装，本身不持有页面的固定和锁，使用期间需保留对应的页面守卫 */
+struct RmPageHandle {
+    const RmFileHdr *file_hdr;  // 当前页面所在文件的文件头指针
+    Page *page;                 // 页面的实际数据，包括页面存储的数据、元信息等
+    RmPageHdr *page_hdr;        // page->data的第一部分，存储页面元信息，指针指向首地址，长度为sizeof(RmPageHdr)
+    char *bitmap;               // page->data的第二部分，存储页面的bitmap，指针指向首地址，长度为file_hdr->bitmap_size
+    char *slots;                // page->data的第三部分，存储表的记录，指针指向首地址，每个slot的长度为file_hdr->record_size
+
+    RmPageHandle(const RmFileHdr *fhdr_, Page *page_) : file_hdr(fhdr_), page(page_) {
+        page_hdr = reinterpret_cast<RmPageHdr *>(page->get_data() + page->OFFSET_PAGE_HDR);
+        bitmap = page->get_data() + sizeof(RmPageHdr) + page->OFFSET_PAGE_HDR;
+        slots = bitmap + file_hdr->bitmap_size;
+    }
+
+    // 返回指定slot_no的slot存储收地址
+    char* get_slot(int slot_no) const {
+        return slots + slot_no * file_hdr->record_size;  // slots的首地址 + slot个数 * 每个slot的大小(每个record的大小)
+    }
+};
+
+/* 记录的只读视图：直接指向缓冲池帧中的slot，不复制记录；视图存在期间页面保持固定和读锁
+ * 只能移动不能复制，用完应尽快释放（需要保留记录时用to_record()物化），持有视图时不能再写同一页面 */
+class RmRecordView {
+   public:
+    RmRecordView() = default;
+
+    RmRecordView(ReadPageGuard &&guard, const char *data, int size)
+        : guard_(std::move(guard)), data_(data), size_(size) {}
+
+    RmRecordView(RmRecordView &&other) noexcept
+        : guard_(std::move(other.guard_)), data_(other.data_), size_(other.size_) {
+        other.data_ = nullptr;
+    }
+
+    RmRecordView &operator=(RmRecordView &&other) noexcept {
+        if (this != &other) {
+            guard_ = std::move(other.guard_);
+            data_ = other.data_;
+            size_ = other.size_;
+            other.data_ = nullptr;
+        }
+        return *this;
+    }
+
+    bool is_valid() const { return data_ != nullptr; }
+
+    const char *data() const { return data_; }
+
+    int size() const { return size_; }
+
+    // 把视图中的记录复制为独立的RmRecord
+    std::unique_ptr<RmRecord> to_record() const {
+        auto record = std::make_unique<RmRecord>(size_);
+        memcpy(record->data, data_, size_);
+        return record;
+    }
+
+    void release() {
+        guard_.drop();
+        data_ = nullptr;
+    }
+
+   private:
+    ReadPageGuard guard_;
+    const char *data_ = nullptr;
+    int size_ = 0;
+};
+
+/* 每个RmFileHandle对应一个表的数据文件，里面有多个page，每个page的数据封装在RmPageHandle中 */
+class RmFileHandle {
+    friend class RmScan;
+    friend class RmManager;
+
+   private:
+    DiskManager *disk_manager_;
+    BufferPoolManager *buffer_pool_manager_;
+    int fd_;        // 打开文件后产生的文件句柄
+    RmFileHdr file_hdr_;    // 文件头，维护文件中页面的个数以及第一个可用的page_no
+
+   public:
+    RmFileHandle(DiskManager *disk_manager, BufferPoolManager *buffer_pool_manager, int fd)
+        : disk_manager_(disk_manager), buffer_pool_manager_(buffer_pool_manager), fd_(fd) {
+        // 注意：这里从磁盘中读出文件描述符为fd的文件的file_hdr，读到内存中
+        // 这里实际就是把磁盘文件中的第0页的头信息读到内存中
+        disk_manager_->read_page(fd, RM_FILE_HDR_PAGE, (char *)&file_hdr_, sizeof(file_hdr_));
+        // disk_manager管理的fd对应的文件中，设置从file_hdr_.num_pages开始分配page_no
+        disk_manager_->set_fd2pageno(fd, file_hdr_.num_pages);
+    }
+
+    RmFileHdr get_file_hdr() { return file_hdr_; }
+    int GetFd() { return fd_; }
+
+    /* 判断指定位置上是否已经存在一条记录，通过Bitmap来判断 */
+    bool is_record(const Rid &rid) const {
+        ReadPageGuard guard = fetch_page_read(rid.page_no);
+        RmPageHandle page_handle(&file_hdr_, guard.get_page());
+        return Bitmap::is_set(page_handle.bitmap, rid.slot_no);  // page的slot_no位置上是否有record
+    }
+
+    std::unique_ptr<RmRecord> get_record(const Rid &rid, Context *context) const;
+
+    RmRecordView get_record_view(const Rid &rid, AccessPattern pattern = AccessPattern::NORMAL) const;
+
+    Rid insert_record(char *buf, Context *context);
+
+    void insert_record(const Rid &rid, char *buf);
+
+    std::vector<Rid> insert_records(const char *bufs, int num_records, Context *context);
+
+    void delete_record(const Rid &rid, Context *context);
+
+    void update_record(const Rid &rid, char *buf, Context *context);
+
+    WritePageGuard create_new_page();
+
+    // 顺序扫描时传入AccessPattern::SEQUENTIAL，避免扫描冲刷掉缓冲池中的热点页面
+    ReadPageGuard fetch_page_read(int page_no, AccessPattern pattern = AccessPattern::NORMAL) const;
+
+    WritePageGuard fetch_page_write(int page_no) const;
+
+    void scan_page(int page_no, std::vector<int> *slots, AccessPattern pattern = AccessPattern::NORMAL) const;
+
+   private:
+    WritePageGuard create_free_page();
+
+    void release_page_handle(RmPageHandle &page_handle);
+};
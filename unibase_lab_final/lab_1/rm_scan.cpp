@@ -1,51 +1,83 @@
 #include "rm_scan.h"
 #include "rm_file_handle.h"
 
-/**
- * @brief 初始化file_handle和rid
- * @param file_handle
- */
-RmScan::RmScan(const RmFileHandle *file_handle) : file_handle_(file_handle) {
-    // Todo:
-    // 初始化file_handle和rid（指向第一个存放了记录的位置）
-    this->rid_ = {.page_no = RM_FIRST_RECORD_PAGE, .slot_no = -1};
-    next();
-}
+RmPageScan::RmPageScan()
+    : rid_{.page_no = RM_FIRST_RECORD_PAGE - 1, .slot_no = -1}, slot_idx_(0), prefetch_end_(RM_FIRST_RECORD_PAGE),
+      prefetch_window_(RM_PREFETCH_MIN_PAGES) {}
 
 /**
  * @brief 找到文件中下一个存放了记录的位置
  */
-void RmScan::next() {
-    // Todo:
+void RmPageScan::next() {
     // 找到文件中下一个存放了记录的非空闲位置，用rid_来指向这个位置
-     while(this->rid_.page_no < file_handle_ -> file_hdr_.num_pages){
-        RmPageHandle page_handle = file_handle_->fetch_page_handle(this->rid_.page_no);
-        this->rid_.slot_no = Bitmap::next_bit(true, page_handle.bitmap,
-            file_handle_->file_hdr_.num_records_per_page,
-            this->rid_.slot_no);
-        if(this->rid_.slot_no < this->file_handle_->file_hdr_.num_records_per_page){
-          return;
-        } else {
-            this->rid_ = Rid{this->rid_.page_no+1, -1};
-            if(rid_.page_no >= file_handle_ -> file_hdr_.num_pages) {
-                rid_ = Rid{RM_NO_PAGE, -1};
-                break;
-            }
+    if(this->rid_.page_no == RM_NO_PAGE) {
+        return;
+    }
+    if(++this->slot_idx_ < this->slots_.size()) {  // 当前页中还有记录，不需要再访问缓冲池
+        this->rid_.slot_no = this->slots_[this->slot_idx_];
+        return;
+    }
+    // 进入下一个有记录的页面；scan_page读完后立即unpin，扫描读入的冷页面才能被后续扫描循环复用
+    while(this->rid_.page_no + 1 < num_pages()) {
+        this->rid_ = Rid{this->rid_.page_no + 1, -1};
+        prefetch_ahead();
+        scan_page(this->rid_.page_no, &this->slots_);
+        if(!this->slots_.empty()) {
+            this->slot_idx_ = 0;
+            this->rid_.slot_no = this->slots_[0];
+            return;
         }
     }
+    this->rid_ = Rid{RM_NO_PAGE, -1};
+    this->slots_.clear();
+}
+
+/**
+ * @brief 扫描进入下一页时调用：消费到已预读范围的后半段时，异步预读后面的一段连续页面
+ * 当前页紧接着就被同步读取，预读从它的下一页开始
+ */
+void RmPageScan::prefetch_ahead() {
+    if (rid_.page_no + prefetch_window_ / 2 < prefetch_end_) {
+        return;
+    }
+    page_id_t start = std::max(prefetch_end_, rid_.page_no + 1);
+    int count = std::min(prefetch_window_, num_pages() - start);
+    if (count <= 0) {
+        return;
+    }
+    prefetch(start, count);
+    prefetch_end_ = start + count;
+    prefetch_window_ = std::min(prefetch_window_ * 2, RM_PREFETCH_MAX_PAGES);
 }
 
 /**
  * @brief ​ 判断是否到达文件末尾
  */
-bool RmScan::is_end() const {
-    // Todo: 修改返回值
+bool RmPageScan::is_end() const {
     return rid_.page_no == RM_NO_PAGE;
 }
 
 /**
  * @brief RmScan内部存放的rid
  */
-Rid RmScan::rid() const {
+Rid RmPageScan::rid() const {
     return rid_;
-}
\ No newline at end of file
+}
+
+/**
+ * @brief 初始化file_handle，并进入第一个存放了记录的位置，同时发起第一个预读窗口
+ * @param file_handle
+ */
+RmScan::RmScan(const RmFileHandle *file_handle) : file_handle_(file_handle) {
+    next();
+}
+
+int RmScan::num_pages() const { return file_handle_->file_hdr_.num_pages; }
+
+void RmScan::scan_page(int page_no, std::vector<int> *slots) const {
+    file_handle_->scan_page(page_no, slots, AccessPattern::SEQUENTIAL);
+}
+
+void RmScan::prefetch(page_id_t start_page_no, int count) const {
+    file_handle_->buffer_pool_manager_->prefetch(file_handle_->fd_, start_page_no, count);
+}
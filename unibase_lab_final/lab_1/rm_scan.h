@@ -0,0 +1,61 @@
+#pragma once
+
+#include <vector>
+
+#include "rm_defs.h"
+
+class RmFileHandle;
+
+// 顺序扫描进入第一个记录页时即开始预读当前页之后的页面，预读窗口从RM_PREFETCH_MIN_PAGES开始每次翻倍，最大为RM_PREFETCH_MAX_PAGES
+constexpr int RM_PREFETCH_MIN_PAGES = 4;
+constexpr int RM_PREFETCH_MAX_PAGES = 32;
+
+/**
+ * 按页扫描：每进入一页调用一次scan_page取出该页所有记录的位置，之后的next()只在内存中前进
+ * 定长文件和槽页文件的扫描共用这部分逻辑，文件布局相关的操作由子类提供
+ */
+class RmPageScan : public RecScan {
+    Rid rid_;
+    std::vector<int> slots_;    // 当前页中所有记录的slot_no
+    size_t slot_idx_;           // rid_.slot_no在slots_中的下标
+    page_id_t prefetch_end_;    // 已发起预读的页面范围的结尾（不含）
+    int prefetch_window_;       // 下一次预读的页面数量
+
+   public:
+    void next() override;
+
+    bool is_end() const override;
+
+    Rid rid() const override;
+
+   protected:
+    // 从第一个记录页的前一页开始，子类构造完成后调用next()进入第一个记录页
+    RmPageScan();
+
+    // 文件当前的页面数，包括文件头所在的第0页
+    virtual int num_pages() const = 0;
+
+    // 取出page_no页中所有记录的slot_no
+    virtual void scan_page(int page_no, std::vector<int> *slots) const = 0;
+
+    // 异步预读[start_page_no, start_page_no + count)
+    virtual void prefetch(page_id_t start_page_no, int count) const = 0;
+
+   private:
+    void prefetch_ahead();
+};
+
+/* 定长记录文件的顺序扫描 */
+class RmScan : public RmPageScan {
+    const RmFileHandle *file_handle_;
+
+   public:
+    RmScan(const RmFileHandle *file_handle);
+
+   protected:
+    int num_pages() const override;
+
+    void scan_page(int page_no, std::vector<int> *slots) const override;
+
+    void prefetch(page_id_t start_page_no, int count) const override;
+};
@@ -0,0 +1,311 @@
+#include "rm_slotted_file_handle.h"
+
+#include <algorithm>
+
+int RmVarLenRecord::encoded_size(int fixed_len, const std::vector<std::string_view> &fields) {
+    int size = fixed_len + static_cast<int>(fields.size() * sizeof(uint16_t));
+    for (auto &field : fields) {
+        size += static_cast<int>(field.size());
+    }
+    return size;
+}
+
+int RmVarLenRecord::encode(const char *fixed, int fixed_len, const std::vector<std::string_view> &fields, char *out) {
+    memcpy(out, fixed, fixed_len);
+    int end = fixed_len + static_cast<int>(fields.size() * sizeof(uint16_t));
+    for (size_t i = 0; i < fields.size(); i++) {
+        memcpy(out + end, fields[i].data(), fields[i].size());
+        end += static_cast<int>(fields[i].size());
+        uint16_t field_end = static_cast<uint16_t>(end);
+        memcpy(out + fixed_len + i * sizeof(uint16_t), &field_end, sizeof(uint16_t));
+    }
+    return end;
+}
+
+std::string_view RmVarLenRecord::get_field(const char *rec, int fixed_len, int num_fields, int field_no) {
+    uint16_t begin = static_cast<uint16_t>(fixed_len + num_fields * sizeof(uint16_t));
+    uint16_t end;
+    if (field_no > 0) {
+        memcpy(&begin, rec + fixed_len + (field_no - 1) * sizeof(uint16_t), sizeof(uint16_t));
+    }
+    memcpy(&end, rec + fixed_len + field_no * sizeof(uint16_t), sizeof(uint16_t));
+    return std::string_view(rec + begin, end - begin);
+}
+
+RmSlottedFileHandle::RmSlottedFileHandle(DiskManager *disk_manager, BufferPoolManager *buffer_pool_manager, int fd)
+    : disk_manager_(disk_manager), buffer_pool_manager_(buffer_pool_manager), fd_(fd) {
+    disk_manager_->read_page(fd, RM_FILE_HDR_PAGE, (char *)&file_hdr_, sizeof(file_hdr_));
+    if (file_hdr_.magic != RM_SLOTTED_MAGIC) {
+        throw InternalError("RmSlottedFileHandle: not a slotted record file");
+    }
+    disk_manager_->set_fd2pageno(fd, file_hdr_.num_pages);
+}
+
+/**
+ * @description: 创建一个空的槽页文件
+ * @param {DiskManager*} disk_manager
+ * @param {string&} path 文件路径
+ */
+void RmSlottedFileHandle::create_file(DiskManager *disk_manager, const std::string &path) {
+    disk_manager->create_file(path);
+    int fd = disk_manager->open_file(path);
+    RmSlottedFileHdr file_hdr{};
+    file_hdr.magic = RM_SLOTTED_MAGIC;
+    file_hdr.num_pages = 1;  // 文件头所在的第0页
+    file_hdr.first_free_page_no = RM_NO_PAGE;
+    disk_manager->write_page(fd, RM_FILE_HDR_PAGE, (char *)&file_hdr, sizeof(file_hdr));
+    disk_manager->close_file(fd);
+}
+
+bool RmSlottedFileHandle::is_slotted_file(DiskManager *disk_manager, int fd) {
+    int magic = 0;
+    disk_manager->read_page(fd, RM_FILE_HDR_PAGE, (char *)&magic, sizeof(magic));
+    return magic == RM_SLOTTED_MAGIC;
+}
+
+void RmSlottedFileHandle::flush_file_hdr() {
+    disk_manager_->write_page(fd_, RM_FILE_HDR_PAGE, (char *)&file_hdr_, sizeof(file_hdr_));
+}
+
+bool RmSlottedFileHandle::is_record(const Rid &rid) const {
+    ReadPageGuard guard = fetch_page_read(rid.page_no);
+    RmSlottedPageHandle page_handle(guard.get_page());
+    return page_handle.is_record(rid.slot_no);
+}
+
+/**
+ * @description: 获取记录号为rid的记录，RmRecord::size为该记录的实际长度
+ */
+std::unique_ptr<RmRecord> RmSlottedFileHandle::get_record(const Rid &rid, Context *context) const {
+    return get_record_view(rid).to_record();
+}
+
+/**
+ * @description: 获取记录号为rid的记录的只读视图，视图析构前页面保持固定和读锁
+ */
+RmRecordView RmSlottedFileHandle::get_record_view(const Rid &rid, AccessPattern pattern) const {
+    ReadPageGuard guard = fetch_page_read(rid.page_no, pattern);
+    RmSlottedPageHandle page_handle(guard.get_page());
+    if (!page_handle.is_record(rid.slot_no)) {
+        throw RecordNotFoundError(rid.page_no, rid.slot_no);
+    }
+    const char *data = page_handle.get_record(rid.slot_no);
+    int size = page_handle.slots[rid.slot_no].length;
+    return RmRecordView(std::move(guard), data, size);
+}
+
+/**
+ * @description: 插入一条长度为size的记录
+ *               从空闲页面链表的第一个页面开始尝试：放得下（必要时先整理页面）就插入；剩余空间已经很少的页面移出链表后
+ *               继续尝试下一个页面；链表为空或第一个页面剩余空间较多但放不下这条记录时新建页面
+ * @return {Rid} 插入的记录的记录号
+ */
+Rid RmSlottedFileHandle::insert_record(const char *buf, int size, Context *context) {
+    if (size <= 0 || size > max_record_size()) {
+        throw InternalError("RmSlottedFileHandle::insert_record: invalid record size " + std::to_string(size));
+    }
+    while (true) {
+        WritePageGuard guard = file_hdr_.first_free_page_no == RM_NO_PAGE ? create_new_page()
+                                                                          : fetch_page_write(file_hdr_.first_free_page_no);
+        RmSlottedPageHandle page_handle(guard.get_page());
+        RmSlottedPageHdr *page_hdr = page_handle.page_hdr;
+        // 优先复用已删除的slot，没有时在slot目录末尾追加
+        int slot_no = 0;
+        while (slot_no < page_hdr->num_slots && page_handle.slots[slot_no].offset != 0) {
+            slot_no++;
+        }
+        int needed = size + (slot_no == page_hdr->num_slots ? static_cast<int>(sizeof(RmSlot)) : 0);
+        if (needed > page_handle.total_free()) {
+            if (page_handle.total_free() < RM_SLOTTED_FREE_THRESHOLD) {
+                file_hdr_.first_free_page_no = page_hdr->next_free_page_no;
+                page_hdr->in_free_list = false;
+                continue;
+            }
+            // 页面还有较多空间，只是放不下这条较长的记录：保留在链表中，新建的页面插到链表头
+            guard = create_new_page();
+            page_handle = RmSlottedPageHandle(guard.get_page());
+            page_hdr = page_handle.page_hdr;
+            slot_no = 0;
+            needed = size + static_cast<int>(sizeof(RmSlot));
+        }
+        // 追加slot目录项之前先整理页面，否则目录项可能覆盖记录数据区开头的记录
+        if (page_handle.contiguous_free() < needed) {
+            compact(page_handle);
+        }
+        if (slot_no == page_hdr->num_slots) {
+            page_hdr->num_slots++;
+            page_handle.slots[slot_no] = RmSlot{0, 0};
+        }
+        char *data = allocate(page_handle, size);
+        memcpy(data, buf, size);
+        page_handle.slots[slot_no] = RmSlot{static_cast<uint16_t>(data - page_handle.page->get_data()),
+                                            static_cast<uint16_t>(size)};
+        page_hdr->num_records++;
+        if (page_handle.total_free() < RM_SLOTTED_FREE_THRESHOLD && page_hdr->in_free_list &&
+            file_hdr_.first_free_page_no == page_handle.page->get_page_id().page_no) {
+            file_hdr_.first_free_page_no = page_hdr->next_free_page_no;
+            page_hdr->in_free_list = false;
+        }
+        return Rid{page_handle.page->get_page_id().page_no, slot_no};
+    }
+}
+
+/**
+ * @description: 删除记录号为rid的记录，记录占用的空间计入碎片，下次空间不够时整理页面回收
+ */
+void RmSlottedFileHandle::delete_record(const Rid &rid, Context *context) {
+    WritePageGuard guard = fetch_page_write(rid.page_no);
+    RmSlottedPageHandle page_handle(guard.get_page());
+    if (!page_handle.is_record(rid.slot_no)) {
+        throw RecordNotFoundError(rid.page_no, rid.slot_no);
+    }
+    RmSlottedPageHdr *page_hdr = page_handle.page_hdr;
+    page_hdr->frag_bytes += page_handle.slots[rid.slot_no].length;
+    page_handle.slots[rid.slot_no] = RmSlot{0, 0};
+    page_hdr->num_records--;
+    // 去掉slot目录末尾的空slot，其余空slot保留，保证其他记录的rid不变
+    while (page_hdr->num_slots > 0 && page_handle.slots[page_hdr->num_slots - 1].offset == 0) {
+        page_hdr->num_slots--;
+    }
+    release_page_handle(page_handle);
+}
+
+/**
+ * @description: 把记录号为rid的记录更新为buf中长度为size的数据，rid不变
+ *               不变长时原地覆盖，变短时多出的字节计入碎片；变长时在连续空闲空间中重新分配，
+ *               连续空闲空间不够时先整理页面（原记录的空间也一并回收）
+ */
+void RmSlottedFileHandle::update_record(const Rid &rid, const char *buf, int size, Context *context) {
+    if (size <= 0 || size > max_record_size()) {
+        throw InternalError("RmSlottedFileHandle::update_record: invalid record size " + std::to_string(size));
+    }
+    WritePageGuard guard = fetch_page_write(rid.page_no);
+    RmSlottedPageHandle page_handle(guard.get_page());
+    if (!page_handle.is_record(rid.slot_no)) {
+        throw RecordNotFoundError(rid.page_no, rid.slot_no);
+    }
+    RmSlottedPageHdr *page_hdr = page_handle.page_hdr;
+    RmSlot &slot = page_handle.slots[rid.slot_no];
+    if (size <= slot.length) {
+        memcpy(page_handle.get_record(rid.slot_no), buf, size);
+        page_hdr->frag_bytes += slot.length - size;
+        slot.length = static_cast<uint16_t>(size);
+    } else {
+        if (size > page_handle.total_free() + slot.length) {
+            // 记录必须留在原页面中才能保持rid不变
+            throw InternalError("RmSlottedFileHandle::update_record: record does not fit in its page");
+        }
+        // 先释放原记录的空间，这样整理页面时可以一并回收
+        page_hdr->frag_bytes += slot.length;
+        slot = RmSlot{0, 0};
+        char *data = allocate(page_handle, size);
+        memcpy(data, buf, size);
+        slot = RmSlot{static_cast<uint16_t>(data - page_handle.page->get_data()), static_cast<uint16_t>(size)};
+    }
+    release_page_handle(page_handle);
+}
+
+/**
+ * @description: 找出指定页面中所有存放了记录的slot，整页只固定一次
+ * @param {vector<int>*} slots 传出参数，按递增顺序存放该页中所有记录的slot_no，原有内容被清空
+ */
+void RmSlottedFileHandle::scan_page(int page_no, std::vector<int> *slots, AccessPattern pattern) const {
+    slots->clear();
+    ReadPageGuard guard = fetch_page_read(page_no, pattern);
+    RmSlottedPageHandle page_handle(guard.get_page());
+    slots->reserve(page_handle.page_hdr->num_records);
+    for (int slot_no = 0; slot_no < page_handle.page_hdr->num_slots; slot_no++) {
+        if (page_handle.slots[slot_no].offset != 0) {
+            slots->push_back(slot_no);
+        }
+    }
+}
+
+ReadPageGuard RmSlottedFileHandle::fetch_page_read(int page_no, AccessPattern pattern) const {
+    if (page_no >= file_hdr_.num_pages) {
+        throw PageNotExistError(disk_manager_->get_file_name(fd_), page_no);
+    }
+    return buffer_pool_manager_->fetch_page_read({fd_, page_no}, pattern);
+}
+
+WritePageGuard RmSlottedFileHandle::fetch_page_write(int page_no) const {
+    if (page_no >= file_hdr_.num_pages) {
+        throw PageNotExistError(disk_manager_->get_file_name(fd_), page_no);
+    }
+    return buffer_pool_manager_->fetch_page_write({fd_, page_no});
+}
+
+/**
+ * @description: 创建一个新的空页面，并放到空闲页面链表头
+ */
+WritePageGuard RmSlottedFileHandle::create_new_page() {
+    PageId page_id = {fd_, INVALID_PAGE_ID};
+    WritePageGuard guard = buffer_pool_manager_->new_page_write(&page_id);
+    if (!guard.is_valid()) {
+        throw InternalError("RmSlottedFileHandle::create_new_page: no free frame in buffer pool");
+    }
+    RmSlottedPageHandle page_handle(guard.get_page());
+    page_handle.page_hdr->next_free_page_no = file_hdr_.first_free_page_no;
+    page_handle.page_hdr->num_slots = 0;
+    page_handle.page_hdr->num_records = 0;
+    page_handle.page_hdr->data_begin = PAGE_SIZE;
+    page_handle.page_hdr->frag_bytes = 0;
+    page_handle.page_hdr->in_free_list = true;
+    file_hdr_.num_pages++;
+    file_hdr_.first_free_page_no = page_id.page_no;
+    return guard;
+}
+
+/**
+ * @description: 整理页面：把所有记录依次移到页尾，消除记录之间的碎片，slot的编号不变
+ */
+void RmSlottedFileHandle::compact(RmSlottedPageHandle &page_handle) {
+    RmSlottedPageHdr *page_hdr = page_handle.page_hdr;
+    std::vector<int> order;
+    order.reserve(page_hdr->num_records);
+    for (int slot_no = 0; slot_no < page_hdr->num_slots; slot_no++) {
+        if (page_handle.slots[slot_no].offset != 0) {
+            order.push_back(slot_no);
+        }
+    }
+    // 按偏移从大到小移动，每条记录只会向页尾方向移动，不会覆盖还没有移动的记录
+    std::sort(order.begin(), order.end(), [&page_handle](int a, int b) {
+        return page_handle.slots[a].offset > page_handle.slots[b].offset;
+    });
+    char *data = page_handle.page->get_data();
+    int end = PAGE_SIZE;
+    for (int slot_no : order) {
+        RmSlot &slot = page_handle.slots[slot_no];
+        end -= slot.length;
+        if (end != slot.offset) {
+            memmove(data + end, data + slot.offset, slot.length);
+            slot.offset = static_cast<uint16_t>(end);
+        }
+    }
+    page_hdr->data_begin = end;
+    page_hdr->frag_bytes = 0;
+}
+
+/**
+ * @description: 在记录数据区的开头分配size字节，连续空闲空间不够时先整理页面；调用者保证total_free()足够
+ */
+char *RmSlottedFileHandle::allocate(RmSlottedPageHandle &page_handle, int size) {
+    if (page_handle.contiguous_free() < size) {
+        compact(page_handle);
+    }
+    assert(page_handle.contiguous_free() >= size);
+    page_handle.page_hdr->data_begin -= size;
+    return page_handle.page->get_data() + page_handle.page_hdr->data_begin;
+}
+
+/**
+ * @description: 删除或更新记录后调用：页面剩余空间重新达到阈值时放回空闲页面链表
+ */
+void RmSlottedFileHandle::release_page_handle(RmSlottedPageHandle &page_handle) {
+    if (page_handle.page_hdr->in_free_list || page_handle.total_free() < RM_SLOTTED_FREE_THRESHOLD) {
+        return;
+    }
+    page_handle.page_hdr->next_free_page_no = file_hdr_.first_free_page_no;
+    page_handle.page_hdr->in_free_list = true;
+    file_hdr_.first_free_page_no = page_handle.page->get_page_id().page_no;
+}
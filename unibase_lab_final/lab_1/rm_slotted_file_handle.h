@@ -0,0 +1,136 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "rm_file_handle.h"
+
+// 槽页文件的文件头第一个字段；定长文件此处为record_size（不超过RM_MAX_RECORD_SIZE），据此区分两种布局
+constexpr int RM_SLOTTED_MAGIC = 0x534c4f54;  // "SLOT"
+// 页面剩余空间（含碎片）不少于该值时留在空闲页面链表中
+constexpr int RM_SLOTTED_FREE_THRESHOLD = PAGE_SIZE / 16;
+
+/* 槽页文件的文件头，存放在第0页 */
+struct RmSlottedFileHdr {
+    int magic;                  // RM_SLOTTED_MAGIC
+    int num_pages;              // 文件中的页面数，包括文件头所在的第0页
+    int first_free_page_no;     // 空闲页面链表的第一个页面
+};
+
+/* 槽页的页头：页头之后是从前向后增长的slot目录，记录数据从页尾向前增长 */
+struct RmSlottedPageHdr {
+    int next_free_page_no;      // 空闲页面链表中的下一个页面
+    int num_slots;              // slot目录的长度，包括已删除的slot
+    int num_records;            // 页面中的记录数
+    int data_begin;             // 记录数据区的起始偏移（相对页面起始），[data_begin, PAGE_SIZE)为记录数据区
+    int frag_bytes;             // 记录数据区中已删除或更新后不再使用的字节数，整理页面后回收
+    int in_free_list;           // 页面是否在空闲页面链表中
+};
+
+/* slot目录项，offset为0表示该slot为空 */
+struct RmSlot {
+    uint16_t offset;            // 记录相对页面起始的偏移
+    uint16_t length;            // 记录长度
+};
+
+/* 对槽页的封装，本身不持有页面的固定和锁，使用期间需保留对应的页面守卫 */
+struct RmSlottedPageHandle {
+    Page *page;
+    RmSlottedPageHdr *page_hdr;
+    RmSlot *slots;
+
+    explicit RmSlottedPageHandle(Page *page_) : page(page_) {
+        page_hdr = reinterpret_cast<RmSlottedPageHdr *>(page->get_data() + page->OFFSET_PAGE_HDR);
+        slots = reinterpret_cast<RmSlot *>(page->get_data() + page->OFFSET_PAGE_HDR + sizeof(RmSlottedPageHdr));
+    }
+
+    bool is_record(int slot_no) const {
+        return slot_no >= 0 && slot_no < page_hdr->num_slots && slots[slot_no].offset != 0;
+    }
+
+    char *get_record(int slot_no) const { return page->get_data() + slots[slot_no].offset; }
+
+    // slot目录末尾到记录数据区之间的连续空闲字节数
+    int contiguous_free() const {
+        return page_hdr->data_begin -
+               static_cast<int>(page->OFFSET_PAGE_HDR + sizeof(RmSlottedPageHdr) + page_hdr->num_slots * sizeof(RmSlot));
+    }
+
+    // 整理页面后可用的空闲字节数
+    int total_free() const { return contiguous_free() + page_hdr->frag_bytes; }
+};
+
+/**
+ * @description: 变长记录的编码：定长字段在前，偏移与ColMeta::offset一致；之后是每个变长字段一个uint16_t的结束偏移
+ *               （相对记录起始），最后依次存放变长字段的数据。变长字段只占实际长度，不像CHAR(n)那样补齐到n字节
+ */
+struct RmVarLenRecord {
+    static int encoded_size(int fixed_len, const std::vector<std::string_view> &fields);
+
+    // 编码到out，out至少有encoded_size个字节；返回编码后的长度
+    static int encode(const char *fixed, int fixed_len, const std::vector<std::string_view> &fields, char *out);
+
+    // 取第field_no个变长字段，rec为encode的结果
+    static std::string_view get_field(const char *rec, int fixed_len, int num_fields, int field_no);
+};
+
+/* 槽页布局的表数据文件：记录长度可变，由页内的slot目录定位；与RmFileHandle的定长位图布局并列，按表选择 */
+class RmSlottedFileHandle {
+    friend class RmSlottedScan;
+
+   private:
+    DiskManager *disk_manager_;
+    BufferPoolManager *buffer_pool_manager_;
+    int fd_;
+    RmSlottedFileHdr file_hdr_;
+
+   public:
+    RmSlottedFileHandle(DiskManager *disk_manager, BufferPoolManager *buffer_pool_manager, int fd);
+
+    // 创建一个空的槽页文件，只有文件头所在的第0页
+    static void create_file(DiskManager *disk_manager, const std::string &path);
+
+    // fd对应的文件是否为槽页布局，打开表时据此选择文件句柄
+    static bool is_slotted_file(DiskManager *disk_manager, int fd);
+
+    // 一条记录的最大长度：空页面中除页头和一个slot目录项外的全部空间
+    static constexpr int max_record_size() {
+        return PAGE_SIZE - static_cast<int>(Page::OFFSET_PAGE_HDR + sizeof(RmSlottedPageHdr) + sizeof(RmSlot));
+    }
+
+    RmSlottedFileHdr get_file_hdr() { return file_hdr_; }
+    int GetFd() { return fd_; }
+
+    // 把内存中的文件头写回第0页，关闭文件前调用
+    void flush_file_hdr();
+
+    bool is_record(const Rid &rid) const;
+
+    std::unique_ptr<RmRecord> get_record(const Rid &rid, Context *context) const;
+
+    RmRecordView get_record_view(const Rid &rid, AccessPattern pattern = AccessPattern::NORMAL) const;
+
+    Rid insert_record(const char *buf, int size, Context *context);
+
+    void delete_record(const Rid &rid, Context *context);
+
+    void update_record(const Rid &rid, const char *buf, int size, Context *context);
+
+    void scan_page(int page_no, std::vector<int> *slots, AccessPattern pattern = AccessPattern::NORMAL) const;
+
+   private:
+    ReadPageGuard fetch_page_read(int page_no, AccessPattern pattern = AccessPattern::NORMAL) const;
+
+    WritePageGuard fetch_page_write(int page_no) const;
+
+    WritePageGuard create_new_page();
+
+    void compact(RmSlottedPageHandle &page_handle);
+
+    char *allocate(RmSlottedPageHandle &page_handle, int size);
+
+    void release_page_handle(RmSlottedPageHandle &page_handle);
+};
@@ -0,0 +1,16 @@
+#include "rm_slotted_scan.h"
+#include "rm_slotted_file_handle.h"
+
+RmSlottedScan::RmSlottedScan(const RmSlottedFileHandle *file_handle) : file_handle_(file_handle) {
+    next();
+}
+
+int RmSlottedScan::num_pages() const { return file_handle_->file_hdr_.num_pages; }
+
+void RmSlottedScan::scan_page(int page_no, std::vector<int> *slots) const {
+    file_handle_->scan_page(page_no, slots, AccessPattern::SEQUENTIAL);
+}
+
+void RmSlottedScan::prefetch(page_id_t start_page_no, int count) const {
+    file_handle_->buffer_pool_manager_->prefetch(file_handle_->fd_, start_page_no, count);
+}
@@ -0,0 +1,22 @@
+#pragma once
+
+#include <vector>
+
+#include "rm_scan.h"
+
+class RmSlottedFileHandle;
+
+/* 槽页文件的顺序扫描，翻页和预读与RmScan共用RmPageScan */
+class RmSlottedScan : public RmPageScan {
+    const RmSlottedFileHandle *file_handle_;
+
+   public:
+    RmSlottedScan(const RmSlottedFileHandle *file_handle);
+
+   protected:
+    int num_pages() const override;
+
+    void scan_page(int page_no, std::vector<int> *slots) const override;
+
+    void prefetch(page_id_t start_page_no, int count) const override;
+};
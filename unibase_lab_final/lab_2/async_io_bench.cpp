@@ -0,0 +1,114 @@
+#include <atomic>
+#include <condition_variable>
+#include <cstdlib>
+#include <mutex>
+#include <random>
+#include <vector>
+
+#include "bench_util.h"
+#include "storage/disk_manager.h"
+
+/* 异步读盘后端在不同队列深度下的随机读IOPS，与同步的read_page对比
+ * 用O_DIRECT打开文件，每次读盘都到达设备；每个在途请求使用自己的对齐缓冲区，完成后缓冲区交还给提交线程 */
+
+static constexpr int NUM_PAGES = 16384;
+static constexpr int NUM_READS = 20000;
+
+/**
+ * @description: 保存空闲缓冲区的栈，没有空闲缓冲区时提交线程等待，从而限制在途的请求数
+ */
+class BufferSlots {
+   public:
+    explicit BufferSlots(int count) : data_(static_cast<char *>(std::aligned_alloc(PAGE_SIZE, count * PAGE_SIZE))) {
+        for (int i = 0; i < count; i++) {
+            free_.push_back(data_ + static_cast<size_t>(i) * PAGE_SIZE);
+        }
+        count_ = count;
+    }
+
+    ~BufferSlots() { std::free(data_); }
+
+    char *acquire() {
+        std::unique_lock lock{latch_};
+        cv_.wait(lock, [&] { return !free_.empty(); });
+        char *buf = free_.back();
+        free_.pop_back();
+        return buf;
+    }
+
+    void release(char *buf) {
+        std::scoped_lock lock{latch_};
+        free_.push_back(buf);
+        cv_.notify_one();
+    }
+
+    // 等待所有请求完成
+    void wait_all() {
+        std::unique_lock lock{latch_};
+        cv_.wait(lock, [&] { return static_cast<int>(free_.size()) == count_; });
+    }
+
+   private:
+    char *data_;
+    int count_;
+    std::vector<char *> free_;
+    std::mutex latch_;
+    std::condition_variable cv_;
+};
+
+int main() {
+    std::string path = "async_io_bench.db";
+    {
+        DiskManager disk_manager;
+        create_bench_file(&disk_manager, path, NUM_PAGES);
+    }
+    std::vector<page_id_t> page_nos(NUM_READS);
+    std::mt19937 rng(9);
+    for (page_id_t &page_no : page_nos) {
+        page_no = static_cast<page_id_t>(rng() % NUM_PAGES);
+    }
+
+    printf("%d uniform random single-page reads over %d pages, O_DIRECT\n", NUM_READS, NUM_PAGES);
+    printf("%-10s %11s %10s %10s\n", "backend", "queue depth", "K IOPS", "failures");
+    {
+        DiskManager disk_manager;
+        disk_manager.set_direct_io(true);
+        int fd = disk_manager.open_file(path);
+        BufferSlots slots(1);
+        char *buf = slots.acquire();
+        BenchTimer timer;
+        for (page_id_t page_no : page_nos) {
+            disk_manager.read_page(fd, page_no, buf, PAGE_SIZE);
+        }
+        printf("%-10s %11d %10.1f %10d\n", "read_page", 1, NUM_READS / timer.seconds() / 1e3, 0);
+        slots.release(buf);
+        disk_manager.close_file(fd);
+    }
+    for (int queue_depth : {1, 2, 4, 8, 16, 32, 64}) {
+        DiskManager disk_manager;
+        disk_manager.set_direct_io(true);
+        disk_manager.enable_async_io(queue_depth);
+        int fd = disk_manager.open_file(path);
+        BufferSlots slots(queue_depth);
+        std::atomic<int> failures{0};
+        BenchTimer timer;
+        for (page_id_t page_no : page_nos) {
+            char *buf = slots.acquire();
+            disk_manager.async_read_pages(fd, {{page_no, buf}}, [&slots, &failures, buf](bool ok) {
+                if (!ok) {
+                    failures++;
+                }
+                slots.release(buf);
+            });
+        }
+        slots.wait_all();
+        double seconds = timer.seconds();
+        printf("%-10s %11d %10.1f %10d\n", disk_manager.async_io_backend(), queue_depth, NUM_READS / seconds / 1e3,
+               failures.load());
+        disk_manager.close_file(fd);
+    }
+
+    DiskManager disk_manager;
+    disk_manager.destroy_file(path);
+    return 0;
+}
@@ -0,0 +1,104 @@
+#include <memory>
+#include <vector>
+
+#include "bench_util.h"
+#include "record/rm_file_handle.h"
+#include "record/rm_scan.h"
+#include "storage/buffer_pool_manager.h"
+
+/* 批量插入与逐条插入的吞吐：向空表插入1M条记录，缓冲池能容纳整个文件
+ * insert_record：每条记录调用一次，每次都要找未满的页面、固定并加写锁
+ * insert_records：一次调用插入全部记录，每个页面只固定一次，连续填满空闲slot
+ * 开始前先检查批量插入会复用删除记录留下的空位，且记录内容与插入顺序一致 */
+
+static constexpr int NUM_RECORDS = 1000000;
+
+class RecordTable {
+   public:
+    RecordTable(const std::string &path, int record_size) : path_(path) {
+        RmFileHdr file_hdr = create_record_file(&disk_manager_, path, record_size);
+        fd_ = disk_manager_.open_file(path);
+        bpm_ = std::make_unique<BufferPoolManager>(NUM_RECORDS / file_hdr.num_records_per_page + 64, &disk_manager_);
+        file_handle_ = std::make_unique<RmFileHandle>(&disk_manager_, bpm_.get(), fd_);
+    }
+
+    ~RecordTable() {
+        file_handle_.reset();
+        bpm_.reset();
+        disk_manager_.close_file(fd_);
+        disk_manager_.destroy_file(path_);
+    }
+
+    RmFileHandle *file_handle() { return file_handle_.get(); }
+
+   private:
+    std::string path_;
+    DiskManager disk_manager_;
+    int fd_;
+    std::unique_ptr<BufferPoolManager> bpm_;
+    std::unique_ptr<RmFileHandle> file_handle_;
+};
+
+static int first_int(const char *data) {
+    int value;
+    memcpy(&value, data, sizeof(value));
+    return value;
+}
+
+/**
+ * @return 批量插入的记录是否都能按返回的Rid读回，且删除留下的空位是否被复用
+ */
+static bool check_hole_reuse() {
+    constexpr int RECORD_SIZE = 16;
+    constexpr int COUNT = 1000;
+    RecordTable table("batch_insert_bench.db", RECORD_SIZE);
+    RmFileHandle *file_handle = table.file_handle();
+    std::vector<char> rows(static_cast<size_t>(RECORD_SIZE) * COUNT);
+    for (int i = 0; i < COUNT; i++) {
+        memcpy(rows.data() + i * RECORD_SIZE, &i, sizeof(i));
+    }
+    std::vector<Rid> rids = file_handle->insert_records(rows.data(), COUNT, nullptr);
+    int num_deleted = 0;
+    for (int i = 0; i < COUNT; i += 3) {
+        file_handle->delete_record(rids[i], nullptr);
+        num_deleted++;
+    }
+    int num_pages = file_handle->get_file_hdr().num_pages;
+    // 插入的记录数不超过删除的数目，应全部放进空位，不增加页面
+    std::vector<Rid> reused = file_handle->insert_records(rows.data(), num_deleted, nullptr);
+    bool ok = static_cast<int>(reused.size()) == num_deleted && file_handle->get_file_hdr().num_pages == num_pages;
+    for (int i = 0; i < num_deleted && ok; i++) {
+        ok = first_int(file_handle->get_record(reused[i], nullptr)->data) == i;
+    }
+    long rows_scanned = 0;
+    for (RmScan scan(file_handle); !scan.is_end(); scan.next()) {
+        rows_scanned++;
+    }
+    return ok && rows_scanned == COUNT;
+}
+
+int main() {
+    printf("batch insert into freed slots: %s\n", check_hole_reuse() ? "ok" : "FAILED");
+    printf("\n%d records into an empty table, M records/s\n", NUM_RECORDS);
+    printf("%-12s %14s %15s %8s\n", "record size", "insert_record", "insert_records", "speedup");
+    for (int record_size : {8, 64, 256}) {
+        std::vector<char> rows(static_cast<size_t>(record_size) * NUM_RECORDS, 'a');
+        double seconds[2];
+        for (int batched = 0; batched < 2; batched++) {
+            RecordTable table("batch_insert_bench.db", record_size);
+            RmFileHandle *file_handle = table.file_handle();
+            BenchTimer timer;
+            if (batched) {
+                file_handle->insert_records(rows.data(), NUM_RECORDS, nullptr);
+            } else {
+                for (int i = 0; i < NUM_RECORDS; i++) {
+                    file_handle->insert_record(rows.data() + static_cast<size_t>(i) * record_size, nullptr);
+                }
+            }
+            seconds[batched] = timer.seconds();
+        }
+        printf("%-12d %14.1f %15.1f %7.1fx\n", record_size, NUM_RECORDS / seconds[0] / 1e6,
+               NUM_RECORDS / seconds[1] / 1e6, seconds[0] / seconds[1]);
+    }
+    return 0;
+}
@@ -0,0 +1,131 @@
+#pragma once
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "record/bitmap.h"
+#include "record/rm_defs.h"
+#include "storage/disk_manager.h"
+
+/* 性能测试程序的公共部分：计时、准备数据文件和记录文件、读取内存和页缓存占用；测试程序只打印结果，不做断言 */
+
+class BenchTimer {
+   public:
+    BenchTimer() : start_(std::chrono::steady_clock::now()) {}
+
+    void reset() { start_ = std::chrono::steady_clock::now(); }
+
+    double seconds() const {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start_).count();
+    }
+
+   private:
+    std::chrono::steady_clock::time_point start_;
+};
+
+/**
+ * @description: 在当前目录创建一个含num_pages个页面的数据文件，第i页的前4个字节为i；已存在时先删除
+ */
+inline void create_bench_file(DiskManager *disk_manager, const std::string &path, int num_pages) {
+    if (disk_manager->is_file(path)) {
+        disk_manager->destroy_file(path);
+    }
+    disk_manager->create_file(path);
+    int fd = disk_manager->open_file(path);
+    constexpr int BATCH = 64;
+    std::vector<char> buf(static_cast<size_t>(BATCH) * PAGE_SIZE, 0);
+    for (int start = 0; start < num_pages; start += BATCH) {
+        std::vector<std::pair<page_id_t, const char *>> pages;
+        for (int i = start; i < std::min(num_pages, start + BATCH); i++) {
+            char *page = buf.data() + static_cast<size_t>(i - start) * PAGE_SIZE;
+            memcpy(page, &i, sizeof(i));
+            pages.emplace_back(i, page);
+        }
+        disk_manager->write_pages(fd, pages);
+    }
+    disk_manager->close_file(fd);
+}
+
+/**
+ * @description: 创建一个空的定长记录文件并写入文件头，页面布局与RmFileHandle一致；已存在时先删除
+ * @return {RmFileHdr} 写入的文件头
+ */
+inline RmFileHdr create_record_file(DiskManager *disk_manager, const std::string &path, int record_size) {
+    if (disk_manager->is_file(path)) {
+        disk_manager->destroy_file(path);
+    }
+    disk_manager->create_file(path);
+    int fd = disk_manager->open_file(path);
+    RmFileHdr file_hdr{};
+    file_hdr.record_size = record_size;
+    file_hdr.num_pages = 1;
+    file_hdr.first_free_page_no = RM_NO_PAGE;
+    // 每个记录占record_size字节加bitmap中的1位
+    file_hdr.num_records_per_page =
+        (BITMAP_WIDTH * (PAGE_SIZE - 1 - static_cast<int>(sizeof(RmPageHdr))) + 1) / (1 + record_size * BITMAP_WIDTH);
+    file_hdr.bitmap_size = (file_hdr.num_records_per_page + BITMAP_WIDTH - 1) / BITMAP_WIDTH;
+    disk_manager->write_page(fd, RM_FILE_HDR_PAGE, reinterpret_cast<char *>(&file_hdr), sizeof(file_hdr));
+    disk_manager->close_file(fd);
+    return file_hdr;
+}
+
+/**
+ * @description: 让内核丢弃文件在页缓存中的（干净）页面，之后的读盘来自磁盘
+ */
+inline void drop_page_cache(int fd) {
+    fdatasync(fd);
+    posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+}
+
+/**
+ * @description: 当前进程的常驻内存（RSS），单位MB
+ */
+inline double rss_mb() {
+    long pages = 0;
+    long resident = 0;
+    FILE *file = fopen("/proc/self/statm", "r");
+    if (file != nullptr) {
+        if (fscanf(file, "%ld %ld", &pages, &resident) != 2) {
+            resident = 0;
+        }
+        fclose(file);
+    }
+    return static_cast<double>(resident) * sysconf(_SC_PAGESIZE) / (1024 * 1024);
+}
+
+/**
+ * @description: 文件当前留在内核页缓存中的大小（mincore统计），单位MB；文件为空或无法映射时返回0
+ */
+inline double page_cache_mb(const std::string &path) {
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return 0;
+    }
+    struct stat st;
+    size_t length = fstat(fd, &st) == 0 ? static_cast<size_t>(st.st_size) : 0;
+    void *addr = length == 0 ? MAP_FAILED : mmap(nullptr, length, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (addr == MAP_FAILED) {
+        return 0;
+    }
+    long os_page_size = sysconf(_SC_PAGESIZE);
+    std::vector<unsigned char> residency((length + os_page_size - 1) / os_page_size);
+    size_t resident = 0;
+    if (mincore(addr, length, residency.data()) == 0) {
+        for (unsigned char flag : residency) {
+            resident += flag & 1;
+        }
+    }
+    munmap(addr, length);
+    return static_cast<double>(resident) * os_page_size / (1024 * 1024);
+}
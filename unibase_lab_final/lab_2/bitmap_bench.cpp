@@ -0,0 +1,126 @@
+#include <algorithm>
+#include <random>
+#include <vector>
+
+#include "bench_util.h"
+#include "record/rm_file_handle.h"
+#include "record/rm_scan.h"
+#include "storage/buffer_pool_manager.h"
+
+/* 按字处理bitmap的效果
+ * 第一部分：一个990个slot的页面（4字节记录）上取出所有记录的slot号，以及从头找第一个空闲slot（前面已占用的比例不同），
+ *           bit by bit为对照实现，按改为按字处理之前的做法逐位调用is_set
+ * 第二部分：不同记录长度下逐条insert_record插入2M条记录和之后全表扫描的吞吐，缓冲池能容纳整个文件 */
+
+static constexpr int NUM_SLOTS = 990;
+static constexpr int ITERATIONS = 200000;
+static constexpr int NUM_RECORDS = 2000000;
+
+static int next_bit_reference(bool bit, const char *bm, int max_n, int curr) {
+    for (int i = curr + 1; i < max_n; i++) {
+        if (Bitmap::is_set(bm, i) == bit) {
+            return i;
+        }
+    }
+    return max_n;
+}
+
+static void bitmap_operations() {
+    char bm[(NUM_SLOTS + BITMAP_WIDTH - 1) / BITMAP_WIDTH];
+    std::vector<int> slots(NUM_SLOTS);
+    std::mt19937 rng(1);
+    long sink = 0;
+    printf("%d-slot page, ns per page\n", NUM_SLOTS);
+    printf("%-24s %12s %12s\n", "operation", "bit by bit", "word level");
+    for (int density : {100, 50, 5}) {
+        Bitmap::init(bm, sizeof(bm));
+        for (int i = 0; i < NUM_SLOTS; i++) {
+            if (static_cast<int>(rng() % 100) < density) {
+                Bitmap::set(bm, i);
+            }
+        }
+        BenchTimer timer;
+        for (int k = 0; k < ITERATIONS; k++) {
+            int count = 0;
+            for (int slot = next_bit_reference(true, bm, NUM_SLOTS, -1); slot < NUM_SLOTS;
+                 slot = next_bit_reference(true, bm, NUM_SLOTS, slot)) {
+                slots[count++] = slot;
+            }
+            sink += count;
+            asm volatile("" : : "r"(bm) : "memory");
+        }
+        double reference_ns = timer.seconds() * 1e9 / ITERATIONS;
+        timer.reset();
+        for (int k = 0; k < ITERATIONS; k++) {
+            int count = 0;
+            Bitmap::for_each_set(bm, NUM_SLOTS, [&](int slot) { slots[count++] = slot; });
+            sink += count;
+            asm volatile("" : : "r"(bm) : "memory");
+        }
+        double word_ns = timer.seconds() * 1e9 / ITERATIONS;
+        printf("all slots, %3d%% full     %12.0f %12.0f\n", density, reference_ns, word_ns);
+    }
+    for (int used : {0, NUM_SLOTS / 2, NUM_SLOTS - 1}) {
+        Bitmap::init(bm, sizeof(bm));
+        Bitmap::set_range(bm, 0, used);
+        BenchTimer timer;
+        for (int k = 0; k < ITERATIONS; k++) {
+            sink += next_bit_reference(false, bm, NUM_SLOTS, -1);
+            asm volatile("" : : "r"(bm) : "memory");
+        }
+        double reference_ns = timer.seconds() * 1e9 / ITERATIONS;
+        timer.reset();
+        for (int k = 0; k < ITERATIONS; k++) {
+            sink += Bitmap::first_bit(false, bm, NUM_SLOTS);
+            asm volatile("" : : "r"(bm) : "memory");
+        }
+        double word_ns = timer.seconds() * 1e9 / ITERATIONS;
+        printf("free slot after %3d used %12.1f %12.1f\n", used, reference_ns, word_ns);
+    }
+    if (sink == -1) {
+        printf("unreachable\n");
+    }
+}
+
+static void insert_and_scan() {
+    printf("\n%d records, M records/s (scan: best of 5)\n", NUM_RECORDS);
+    printf("%-12s %11s %8s %8s\n", "record size", "slots/page", "insert", "scan");
+    for (int record_size : {4, 8, 16, 32}) {
+        std::string path = "bitmap_bench.db";
+        DiskManager disk_manager;
+        RmFileHdr file_hdr = create_record_file(&disk_manager, path, record_size);
+        int fd = disk_manager.open_file(path);
+        {
+            BufferPoolManager bpm(NUM_RECORDS / file_hdr.num_records_per_page + 64, &disk_manager);
+            RmFileHandle file_handle(&disk_manager, &bpm, fd);
+            std::vector<char> record(record_size, 'a');
+            BenchTimer timer;
+            for (int i = 0; i < NUM_RECORDS; i++) {
+                file_handle.insert_record(record.data(), nullptr);
+            }
+            double insert_seconds = timer.seconds();
+            double scan_seconds = 1e9;
+            for (int round = 0; round < 5; round++) {
+                timer.reset();
+                long rows = 0;
+                for (RmScan scan(&file_handle); !scan.is_end(); scan.next()) {
+                    rows++;
+                }
+                scan_seconds = std::min(scan_seconds, timer.seconds());
+                if (rows != NUM_RECORDS) {
+                    printf("scan returned %ld records\n", rows);
+                }
+            }
+            printf("%-12d %11d %8.1f %8.1f\n", record_size, file_hdr.num_records_per_page,
+                   NUM_RECORDS / insert_seconds / 1e6, NUM_RECORDS / scan_seconds / 1e6);
+        }
+        disk_manager.close_file(fd);
+        disk_manager.destroy_file(path);
+    }
+}
+
+int main() {
+    bitmap_operations();
+    insert_and_scan();
+    return 0;
+}
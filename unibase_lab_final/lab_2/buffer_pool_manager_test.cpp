@@ -0,0 +1,295 @@
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "storage/buffer_pool_manager.h"
+
+/* 缓冲池的并发测试；lab_1没有单独的构建目标，测试挂在index目标下，通过它链接storage */
+class BufferPoolManagerTest : public ::testing::Test {
+   protected:
+    static constexpr int NUM_PAGES = 2000;
+
+    std::string path_ = "buffer_pool_manager_test.db";
+    DiskManager disk_manager_;
+    int fd_ = -1;
+
+    // 每个页面的前4个字节是页号，之后4个字节是计数器，初始为0
+    void SetUp() override {
+        if (disk_manager_.is_file(path_)) {
+            disk_manager_.destroy_file(path_);
+        }
+        disk_manager_.create_file(path_);
+        fd_ = disk_manager_.open_file(path_);
+        char page[PAGE_SIZE] = {};
+        for (int i = 0; i < NUM_PAGES; i++) {
+            memcpy(page, &i, sizeof(i));
+            disk_manager_.write_page(fd_, i, page, PAGE_SIZE);
+        }
+        disk_manager_.set_fd2pageno(fd_, NUM_PAGES);
+    }
+
+    void TearDown() override {
+        disk_manager_.close_file(fd_);
+        disk_manager_.destroy_file(path_);
+    }
+
+    static int read_int(const Page *page, int offset) {
+        int value;
+        memcpy(&value, const_cast<Page *>(page)->get_data() + offset, sizeof(value));
+        return value;
+    }
+};
+
+/**
+ * 缩容不等待被长期固定的页面：resize立即返回，固定的页面内容不变，unpin后其帧被回收
+ */
+TEST_F(BufferPoolManagerTest, ShrinkDoesNotWaitForPinnedPages) {
+    BufferPoolManager bpm(1024, &disk_manager_);
+    for (int i = 0; i < 1000; i++) {
+        ASSERT_TRUE(bpm.fetch_page_read({fd_, i}).is_valid());
+    }
+    // 最后读入的页面占用编号较大的帧，缩容到16帧时需要回收它
+    WritePageGuard pinned = bpm.fetch_page_write({fd_, 1500});
+    ASSERT_TRUE(pinned.is_valid());
+
+    auto start = std::chrono::steady_clock::now();
+    EXPECT_TRUE(bpm.resize(16));
+    EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::seconds(1));
+    EXPECT_EQ(bpm.get_pool_size(), 16u);
+
+    EXPECT_EQ(read_int(pinned.get_page(), 0), 1500);
+    int value = 42;
+    memcpy(pinned.get_page()->get_data() + sizeof(int), &value, sizeof(value));
+    pinned.drop();  // 最后一次unpin时脏页写回，帧被回收
+
+    // 缩容后的缓冲池只有16帧，读遍其他页面后1500号页面一定已被换出，再读时来自磁盘
+    for (int i = 0; i < 100; i++) {
+        ASSERT_TRUE(bpm.fetch_page_read({fd_, i}).is_valid());
+    }
+    ReadPageGuard guard = bpm.fetch_page_read({fd_, 1500});
+    ASSERT_TRUE(guard.is_valid());
+    EXPECT_EQ(read_int(guard.get_page(), sizeof(int)), 42);
+}
+
+/**
+ * 并发读写的同时反复扩容和缩容：每个读者看到的页面内容都属于该页面，写者的每次自增都不会丢失
+ */
+TEST_F(BufferPoolManagerTest, ResizeUnderConcurrentLoad) {
+    BufferPoolManager bpm(256, &disk_manager_, 1, ReplacerType::LRU, false, 1024);
+    constexpr int NUM_READERS = 4;
+    constexpr int NUM_WRITERS = 2;
+    constexpr int HOT_PAGES = 64;   // 写者只修改前HOT_PAGES个页面
+    std::atomic<bool> stop{false};
+    std::atomic<int> wrong_pages{0};
+    std::atomic<long> increments{0};
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < NUM_READERS; t++) {
+        threads.emplace_back([&, t] {
+            std::mt19937 rng(t);
+            while (!stop) {
+                int page_no = rng() % NUM_PAGES;
+                ReadPageGuard guard = bpm.fetch_page_read({fd_, page_no});
+                if (!guard.is_valid()) {  // 所有帧都被固定，稍后重试
+                    continue;
+                }
+                if (read_int(guard.get_page(), 0) != page_no) {
+                    wrong_pages++;
+                }
+                if (rng() % 16 == 0) {  // 偶尔跨过一次resize持有固定
+                    std::this_thread::sleep_for(std::chrono::microseconds(200));
+                }
+            }
+        });
+    }
+    for (int t = 0; t < NUM_WRITERS; t++) {
+        threads.emplace_back([&, t] {
+            std::mt19937 rng(100 + t);
+            while (!stop) {
+                int page_no = rng() % HOT_PAGES;
+                WritePageGuard guard = bpm.fetch_page_write({fd_, page_no});
+                if (!guard.is_valid()) {
+                    continue;
+                }
+                char *data = guard.get_page()->get_data();
+                int counter;
+                memcpy(&counter, data + sizeof(int), sizeof(counter));
+                counter++;
+                memcpy(data + sizeof(int), &counter, sizeof(counter));
+                increments++;
+            }
+        });
+    }
+
+    std::mt19937 rng(7);
+    for (int i = 0; i < 200; i++) {
+        size_t pool_size = 16 + rng() % (1024 - 16);
+        EXPECT_TRUE(bpm.resize(pool_size));
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    }
+    stop = true;
+    for (auto &thread : threads) {
+        thread.join();
+    }
+    EXPECT_EQ(wrong_pages, 0);
+
+    bpm.flush_all_pages(fd_);
+    long total = 0;
+    for (int i = 0; i < HOT_PAGES; i++) {
+        char page[PAGE_SIZE];
+        disk_manager_.read_page(fd_, i, page, PAGE_SIZE);
+        int counter;
+        memcpy(&counter, page + sizeof(int), sizeof(counter));
+        total += counter;
+    }
+    EXPECT_EQ(total, increments.load());
+}
+
+/**
+ * 顺序扫描读入的页面放在置换策略的冷端：扫描远大于缓冲池的文件后，热点页面仍然留在缓冲池中
+ * @return 每轮扫描之后重新访问热点页面的命中率
+ */
+static double hot_set_hit_ratio(BufferPoolManager &bpm, int fd, int num_pages, AccessPattern scan_pattern) {
+    constexpr int HOT_PAGES = 64;
+    constexpr int ROUNDS = 5;
+    for (int round = 0; round < 2; round++) {
+        for (int i = 0; i < HOT_PAGES; i++) {
+            bpm.fetch_page_read({fd, i});
+        }
+    }
+    uint64_t hits = 0;
+    uint64_t accesses = 0;
+    for (int round = 0; round < ROUNDS; round++) {
+        for (int i = HOT_PAGES; i < num_pages; i++) {
+            bpm.fetch_page_read({fd, i}, scan_pattern);
+        }
+        uint64_t before = bpm.get_stats().hits;
+        for (int i = 0; i < HOT_PAGES; i++) {
+            bpm.fetch_page_read({fd, i});
+        }
+        hits += bpm.get_stats().hits - before;
+        accesses += HOT_PAGES;
+    }
+    return static_cast<double>(hits) / accesses;
+}
+
+TEST_F(BufferPoolManagerTest, SequentialScanKeepsHotSet) {
+    for (ReplacerType type : {ReplacerType::LRU, ReplacerType::CLOCK, ReplacerType::LRU_K}) {
+        BufferPoolManager bpm(128, &disk_manager_, 1, type);
+        EXPECT_GE(hot_set_hit_ratio(bpm, fd_, NUM_PAGES, AccessPattern::SEQUENTIAL), 0.95)
+            << "replacer " << static_cast<int>(type);
+    }
+    // 对照：按普通访问扫描时，LRU会把热点页面全部换出
+    BufferPoolManager bpm(128, &disk_manager_, 1, ReplacerType::LRU);
+    EXPECT_LT(hot_set_hit_ratio(bpm, fd_, NUM_PAGES, AccessPattern::NORMAL), 0.05);
+}
+
+/**
+ * 未命中路径上读盘或写回失败时帧不会丢失：读盘失败的帧回到free_list_，写回失败的脏页留在缓冲池中
+ * 目录的文件描述符可以打开但不能读写，用它制造IO错误
+ */
+TEST_F(BufferPoolManagerTest, IoFailureReturnsFrame) {
+    int dir_fd = open(".", O_RDONLY | O_DIRECTORY);
+    ASSERT_GE(dir_fd, 0);
+    BufferPoolManager bpm(2, &disk_manager_);
+
+    for (int i = 0; i < 10; i++) {
+        EXPECT_ANY_THROW(bpm.fetch_page({dir_fd, i}));
+    }
+    BufferPoolStats stats = bpm.get_stats();
+    EXPECT_EQ(stats.free_frames, 2u);
+    EXPECT_EQ(stats.pinned_frames, 0u);
+    EXPECT_TRUE(bpm.fetch_page_read({fd_, 0}).is_valid());
+    EXPECT_TRUE(bpm.fetch_page_read({fd_, 1}).is_valid());
+
+    // 两个帧都装入写不回去的脏页，再读其他页面时淘汰写回失败
+    PageId dirty_ids[2];
+    for (PageId &page_id : dirty_ids) {
+        page_id.fd = dir_fd;
+        BasicPageGuard guard = bpm.new_page_basic(&page_id);
+        ASSERT_TRUE(guard.is_valid());
+        int value = 42;
+        memcpy(guard.get_page()->get_data(), &value, sizeof(value));
+    }
+    for (int i = 0; i < 10; i++) {
+        EXPECT_ANY_THROW(bpm.fetch_page({fd_, i}));
+        PageId new_id{.fd = fd_, .page_no = INVALID_PAGE_ID};
+        EXPECT_ANY_THROW(bpm.new_page_basic(&new_id));
+    }
+    stats = bpm.get_stats();
+    EXPECT_EQ(stats.dirty_frames, 2u);
+    EXPECT_EQ(stats.pinned_frames, 0u);
+    for (PageId page_id : dirty_ids) {
+        ReadPageGuard guard = bpm.fetch_page_read(page_id);
+        ASSERT_TRUE(guard.is_valid());
+        EXPECT_EQ(read_int(guard.get_page(), 0), 42);
+    }
+    close(dir_fd);
+}
+
+/**
+ * 预读的页面放在置换策略的冷端：预读远多于缓冲池帧数的页面后，热点页面仍然留在缓冲池中
+ */
+TEST_F(BufferPoolManagerTest, PrefetchKeepsHotSet) {
+    constexpr int HOT_PAGES = 64;
+    constexpr int PREFETCH_PAGES = 512;
+    for (ReplacerType type : {ReplacerType::LRU, ReplacerType::CLOCK, ReplacerType::LRU_K}) {
+        BufferPoolManager bpm(128, &disk_manager_, 1, type);
+        for (int round = 0; round < 2; round++) {
+            for (int i = 0; i < HOT_PAGES; i++) {
+                bpm.fetch_page_read({fd_, i});
+            }
+        }
+        for (int i = HOT_PAGES; i < HOT_PAGES + PREFETCH_PAGES; i += 32) {
+            bpm.prefetch(fd_, i, 32);
+        }
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+        while (bpm.get_stats().prefetched_pages < PREFETCH_PAGES && std::chrono::steady_clock::now() < deadline) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        ASSERT_EQ(bpm.get_stats().prefetched_pages, static_cast<uint64_t>(PREFETCH_PAGES));
+        uint64_t before = bpm.get_stats().hits;
+        for (int i = 0; i < HOT_PAGES; i++) {
+            bpm.fetch_page_read({fd_, i});
+        }
+        EXPECT_GE(bpm.get_stats().hits - before, static_cast<uint64_t>(HOT_PAGES * 95 / 100))
+            << "replacer " << static_cast<int>(type);
+    }
+}
+
+/**
+ * 冷端按放入的先后顺序淘汰：连续预读多批页面时，新的一批挤掉的是最早预读的页面，刚预读的页面在被消费之前不会被淘汰
+ */
+TEST_F(BufferPoolManagerTest, PrefetchEvictsOldestColdPagesFirst) {
+    constexpr int HOT_PAGES = 64;
+    constexpr int BATCH = 32;
+    constexpr int NUM_BATCHES = 8;
+    for (ReplacerType type : {ReplacerType::LRU, ReplacerType::CLOCK, ReplacerType::LRU_K}) {
+        BufferPoolManager bpm(128, &disk_manager_, 1, type);
+        for (int i = 0; i < HOT_PAGES; i++) {
+            bpm.fetch_page_read({fd_, i});
+        }
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+        for (int batch = 0; batch < NUM_BATCHES; batch++) {
+            bpm.prefetch(fd_, HOT_PAGES + batch * BATCH, BATCH);
+            while (bpm.get_stats().prefetched_pages < static_cast<uint64_t>((batch + 1) * BATCH) &&
+                   std::chrono::steady_clock::now() < deadline) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+        }
+        ASSERT_EQ(bpm.get_stats().prefetched_pages, static_cast<uint64_t>(NUM_BATCHES * BATCH));
+        // 最后一批预读的页面全部还在缓冲池中
+        uint64_t before = bpm.get_stats().hits;
+        for (int i = HOT_PAGES + (NUM_BATCHES - 1) * BATCH; i < HOT_PAGES + NUM_BATCHES * BATCH; i++) {
+            bpm.fetch_page_read({fd_, i});
+        }
+        EXPECT_EQ(bpm.get_stats().hits - before, static_cast<uint64_t>(BATCH)) << "replacer " << static_cast<int>(type);
+    }
+}
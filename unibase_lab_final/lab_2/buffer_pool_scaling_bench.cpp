@@ -0,0 +1,68 @@
+#include <atomic>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "bench_util.h"
+#include "storage/buffer_pool_manager.h"
+
+/* 分片缓冲池的多线程吞吐：1到32个线程并发fetch_page/unpin_page，比较不分片和16个分片
+ * 数据文件是缓冲池的4倍，随机访问约3/4未命中，未命中路径要持有分片的latch_选帧和读盘（读盘来自页缓存） */
+
+static constexpr int NUM_PAGES = 8192;
+static constexpr int POOL_SIZE = 2048;
+static constexpr int TOTAL_OPS = 640000;  // 每轮所有线程合计的fetch/unpin次数
+
+/**
+ * @return 每秒完成的fetch/unpin次数（百万）
+ */
+static double run(BufferPoolManager *bpm, int fd, int num_threads) {
+    std::atomic<long> failures{0};
+    std::vector<std::thread> threads;
+    int ops_per_thread = TOTAL_OPS / num_threads;
+    BenchTimer timer;
+    for (int t = 0; t < num_threads; t++) {
+        threads.emplace_back([&, t] {
+            std::mt19937 rng(t);
+            for (int i = 0; i < ops_per_thread; i++) {
+                PageId page_id{fd, static_cast<page_id_t>(rng() % NUM_PAGES)};
+                if (bpm->fetch_page(page_id) == nullptr) {  // 所有帧都被固定，计入失败
+                    failures++;
+                    continue;
+                }
+                bpm->unpin_page(page_id, false);
+            }
+        });
+    }
+    for (auto &thread : threads) {
+        thread.join();
+    }
+    double seconds = timer.seconds();
+    if (failures > 0) {
+        printf("  (%ld fetches found no free frame)\n", failures.load());
+    }
+    return static_cast<double>(num_threads) * ops_per_thread / seconds / 1e6;
+}
+
+int main() {
+    std::string path = "buffer_pool_scaling_bench.db";
+    DiskManager disk_manager;
+    create_bench_file(&disk_manager, path, NUM_PAGES);
+    int fd = disk_manager.open_file(path);
+
+    printf("%u hardware threads, %d pages, %d frames, %d fetch/unpin per run\n",
+           std::thread::hardware_concurrency(), NUM_PAGES, POOL_SIZE, TOTAL_OPS);
+    printf("threads   1 shard (M ops/s)   16 shards (M ops/s)\n");
+    for (int num_threads : {1, 2, 4, 8, 16, 32}) {
+        double result[2];
+        for (int i = 0; i < 2; i++) {
+            BufferPoolManager bpm(POOL_SIZE, &disk_manager, i == 0 ? 1 : 16);
+            result[i] = run(&bpm, fd, num_threads);
+        }
+        printf("%7d   %17.2f   %19.2f\n", num_threads, result[0], result[1]);
+    }
+
+    disk_manager.close_file(fd);
+    disk_manager.destroy_file(path);
+    return 0;
+}
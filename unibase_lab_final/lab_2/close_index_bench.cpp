@@ -0,0 +1,99 @@
+#include <algorithm>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "bench_util.h"
+#include "ix_manager.h"
+
+/* 关闭索引时写回的页面数、写盘次数和耗时，缓冲池能容纳整个索引
+ * per page：逐页调用flush_page再关闭，无论页面是否为脏都单独写一次，相当于按文件记录脏页之前的flush_all_pages
+ * close_index：只写回该文件的脏页，按页号排序后把连续的页面合并为一次pwritev
+ * 两种场景：建完索引后直接关闭（几乎所有页面都是脏页），以及写回所有页面后再插入少量键（少数页面是脏页）
+ * 每轮使用新的缓冲池：关闭文件不会清除缓冲池中该文件的页面，重建的索引可能复用同一个文件描述符 */
+
+static constexpr int NUM_KEYS = 2000000;
+static constexpr int NUM_UPDATES = 2000;
+static constexpr int POOL_SIZE = 16384;
+
+struct CloseResult {
+    uint64_t pages;
+    uint64_t writes;
+    double ms;
+};
+
+class CloseIndexBench {
+   public:
+    CloseIndexBench() {
+        std::mt19937 rng(1);
+        keys_.resize(NUM_KEYS + NUM_UPDATES);
+        for (int i = 0; i < NUM_KEYS + NUM_UPDATES; i++) {
+            keys_[i] = i;
+        }
+        std::shuffle(keys_.begin(), keys_.end(), rng);
+    }
+
+    /**
+     * @description: 建好索引并按场景修改后，用指定的方式关闭，返回关闭时的写盘统计
+     */
+    CloseResult run(bool few_dirty, bool per_page) {
+        BufferPoolManager bpm(POOL_SIZE, &disk_manager_);
+        IxManager ix_manager(&disk_manager_, &bpm);
+        if (ix_manager.exists(table_, cols_)) {
+            ix_manager.destroy_index(table_, cols_);
+        }
+        ix_manager.create_index(table_, cols_);
+        std::unique_ptr<IxIndexHandle> ih = ix_manager.open_index(table_, cols_);
+        int fd = disk_manager_.get_file_fd(ix_manager.get_index_name(table_, cols_));
+        insert_keys(ih.get(), 0, NUM_KEYS);
+        if (few_dirty) {
+            // 结点页面仍在缓冲池中，写回后都是干净的，再插入少量键
+            bpm.flush_all_pages(fd);
+            insert_keys(ih.get(), NUM_KEYS, NUM_KEYS + NUM_UPDATES);
+        }
+
+        DiskStats before = disk_manager_.get_stats();
+        BenchTimer timer;
+        if (per_page) {
+            page_id_t num_pages = disk_manager_.get_fd2pageno(fd);
+            for (page_id_t page_no = 0; page_no < num_pages; page_no++) {
+                bpm.flush_page({fd, page_no});
+            }
+        }
+        ix_manager.close_index(ih.get());
+        double seconds = timer.seconds();
+        DiskStats after = disk_manager_.get_stats();
+        ih.reset();
+        ix_manager.destroy_index(table_, cols_);
+        return {(after.bytes_written - before.bytes_written + PAGE_SIZE - 1) / PAGE_SIZE,
+                after.num_writes - before.num_writes, seconds * 1e3};
+    }
+
+   private:
+    void insert_keys(IxIndexHandle *ih, int begin, int end) {
+        for (int i = begin; i < end; i++) {
+            int key = keys_[i];
+            ih->insert_entry(reinterpret_cast<const char *>(&key), Rid{key / 100, key % 100}, nullptr);
+        }
+    }
+
+    std::string table_ = "close_index_bench";
+    std::vector<ColMeta> cols_ = {{table_, "id", TYPE_INT, sizeof(int), 0, true}};
+    DiskManager disk_manager_;
+    std::vector<int> keys_;
+};
+
+int main() {
+    CloseIndexBench bench;
+    printf("%d keys inserted in random order, %d frames\n", NUM_KEYS, POOL_SIZE);
+    printf("%-24s %-12s %8s %8s %9s\n", "scenario", "flush", "pages", "writes", "ms");
+    for (bool few_dirty : {false, true}) {
+        for (bool per_page : {true, false}) {
+            CloseResult result = bench.run(few_dirty, per_page);
+            printf("%-24s %-12s %8lu %8lu %9.2f\n", few_dirty ? "+2000 keys after flush" : "after build",
+                   per_page ? "per page" : "close_index", static_cast<unsigned long>(result.pages),
+                   static_cast<unsigned long>(result.writes), result.ms);
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,187 @@
+#include <sys/stat.h>
+
+#include <atomic>
+#include <filesystem>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "bench_util.h"
+#include "storage/disk_manager.h"
+
+/* 按文件压缩页面的效果和代价
+ * 第一部分：写入由补零的CHAR行组成的页面，比较普通文件和压缩文件的磁盘占用，以及按64页一批read_pages顺序扫描的耗时，
+ *           cold为扫描前丢弃该文件的页缓存
+ * 第二部分：压缩文件反复整页重写（每次重写页面的压缩大小不同）后的文件大小，空闲块被复用时文件不会一直增长
+ * 第三部分：写回页面映射之后整页重写但不写回映射，复制文件模拟崩溃，副本中读出的应是写回映射时的版本；
+ *           之后4个读线程与1个写线程并发读写，统计读到的不完整页面数 */
+
+static constexpr int NUM_PAGES = 20000;
+static constexpr int BATCH = 64;
+static constexpr int REWRITE_PAGES = 200;
+
+// 每行64字节，前面是文本，其余补零
+static void fill_rows(char *page, int page_no, std::mt19937 *rng) {
+    memset(page, 0, PAGE_SIZE);
+    for (int row = 0; row < PAGE_SIZE / 64; row++) {
+        snprintf(page + row * 64, 64, "id=%d name=user%d", page_no * 64 + row, static_cast<int>((*rng)() % 100000));
+    }
+}
+
+// 第page_no页的第version个版本，不同页面和版本的压缩大小不同
+static void fill_version(char *page, int page_no, int version) {
+    int run = 1 + (page_no + version) % 50;
+    for (int i = 0; i < PAGE_SIZE; i++) {
+        page[i] = static_cast<char>((i / run) * (page_no + 1) + version);
+    }
+}
+
+// 页面是否为第page_no页的某个完整版本
+static bool is_whole_version(const char *page, int page_no) {
+    char expected[PAGE_SIZE];
+    for (int version = 0; version < 256; version++) {
+        fill_version(expected, page_no, version);
+        if (memcmp(page, expected, PAGE_SIZE) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static off_t file_size(int fd) {
+    struct stat st;
+    return fstat(fd, &st) == 0 ? st.st_size : -1;
+}
+
+static void size_and_scan() {
+    printf("%d pages of zero-padded 64-byte rows, scanned in %d-page read_pages batches\n", NUM_PAGES, BATCH);
+    printf("%-11s %12s %14s %14s\n", "file", "MB on disk", "cold scan ms", "warm scan ms");
+    for (bool compressed : {false, true}) {
+        std::string path = compressed ? "compression_bench_c.db" : "compression_bench_r.db";
+        DiskManager disk_manager;
+        if (disk_manager.is_file(path)) {
+            disk_manager.destroy_file(path);
+        }
+        disk_manager.create_file(path, compressed);
+        int fd = disk_manager.open_file(path);
+        std::mt19937 rng(1);
+        std::vector<char> buf(static_cast<size_t>(BATCH) * PAGE_SIZE);
+        for (int i = 0; i < NUM_PAGES; i++) {
+            fill_rows(buf.data(), i, &rng);
+            disk_manager.write_page(fd, disk_manager.allocate_page(fd), buf.data(), PAGE_SIZE);
+        }
+        if (compressed) {
+            disk_manager.flush_page_map(fd);
+        }
+        double mb = static_cast<double>(file_size(fd)) / (1024 * 1024);
+        drop_page_cache(fd);
+        double ms[2];
+        for (int pass = 0; pass < 2; pass++) {
+            BenchTimer timer;
+            for (int start = 0; start < NUM_PAGES; start += BATCH) {
+                std::vector<std::pair<page_id_t, char *>> pages;
+                for (int i = start; i < std::min(NUM_PAGES, start + BATCH); i++) {
+                    pages.emplace_back(i, buf.data() + static_cast<size_t>(i - start) * PAGE_SIZE);
+                }
+                disk_manager.read_pages(fd, pages);
+            }
+            ms[pass] = timer.seconds() * 1e3;
+        }
+        printf("%-11s %12.1f %14.1f %14.1f\n", compressed ? "compressed" : "raw", mb, ms[0], ms[1]);
+        disk_manager.close_file(fd);
+        disk_manager.destroy_file(path);
+    }
+}
+
+static void rewrite_and_crash() {
+    std::string path = "compression_bench_w.db";
+    std::string copy = "compression_bench_crash.db";
+    DiskManager disk_manager;
+    for (const std::string &name : {path, copy}) {
+        if (disk_manager.is_file(name)) {
+            disk_manager.destroy_file(name);
+        }
+    }
+    disk_manager.create_file(path, true);
+    int fd = disk_manager.open_file(path);
+    char page[PAGE_SIZE];
+    for (int i = 0; i < REWRITE_PAGES; i++) {
+        fill_version(page, i, 0);
+        disk_manager.write_page(fd, i, page, PAGE_SIZE);
+    }
+    disk_manager.flush_page_map(fd);
+    off_t initial_size = file_size(fd);
+
+    // 重写全部页面但不写回映射，复制数据文件和映射文件模拟此刻崩溃
+    for (int i = 0; i < REWRITE_PAGES; i++) {
+        fill_version(page, i, 1);
+        disk_manager.write_page(fd, i, page, PAGE_SIZE);
+    }
+    std::filesystem::copy_file(path, copy);
+    std::filesystem::copy_file(path + DiskManager::PAGE_MAP_SUFFIX, copy + DiskManager::PAGE_MAP_SUFFIX);
+    int flushed_versions = 0;
+    {
+        DiskManager crashed;
+        int crash_fd = crashed.open_file(copy);
+        char expected[PAGE_SIZE];
+        for (int i = 0; i < REWRITE_PAGES; i++) {
+            crashed.read_page(crash_fd, i, page, PAGE_SIZE);
+            fill_version(expected, i, 0);
+            flushed_versions += memcmp(page, expected, PAGE_SIZE) == 0;
+        }
+        crashed.close_file(crash_fd);
+        crashed.destroy_file(copy);
+    }
+
+    disk_manager.flush_page_map(fd);
+    for (int version = 2; version < 40; version++) {
+        for (int i = 0; i < REWRITE_PAGES; i++) {
+            fill_version(page, i, version);
+            disk_manager.write_page(fd, i, page, PAGE_SIZE);
+        }
+        disk_manager.flush_page_map(fd);
+    }
+    printf("\n%d compressed pages: %ld KB after the first write, %ld KB after 40 full rewrites\n", REWRITE_PAGES,
+           static_cast<long>(initial_size / 1024), static_cast<long>(file_size(fd) / 1024));
+    printf("crash copy taken before the map flush: %d of %d pages read back as the flushed version\n",
+           flushed_versions, REWRITE_PAGES);
+
+    std::atomic<bool> stop{false};
+    std::atomic<long> reads{0};
+    std::atomic<long> torn{0};
+    std::vector<std::thread> readers;
+    for (int t = 0; t < 4; t++) {
+        readers.emplace_back([&, t] {
+            std::mt19937 rng(t);
+            char buf[PAGE_SIZE];
+            while (!stop) {
+                int page_no = static_cast<int>(rng() % REWRITE_PAGES);
+                disk_manager.read_page(fd, page_no, buf, PAGE_SIZE);
+                torn += !is_whole_version(buf, page_no);
+                reads++;
+            }
+        });
+    }
+    for (int version = 40; version < 200; version++) {
+        for (int i = 0; i < REWRITE_PAGES; i++) {
+            fill_version(page, i, version);
+            disk_manager.write_page(fd, i, page, PAGE_SIZE);
+        }
+        if (version % 10 == 0) {
+            disk_manager.flush_page_map(fd);
+        }
+    }
+    stop = true;
+    for (auto &reader : readers) {
+        reader.join();
+    }
+    printf("concurrent rewrites and map flushes: %ld reads, %ld torn\n", reads.load(), torn.load());
+    disk_manager.close_file(fd);
+    disk_manager.destroy_file(path);
+}
+
+int main() {
+    size_and_scan();
+    rewrite_and_crash();
+    return 0;
+}
@@ -0,0 +1,58 @@
+#include <random>
+#include <vector>
+
+#include "bench_util.h"
+#include "storage/buffer_pool_manager.h"
+
+/* 经过页缓存与O_DIRECT两种读盘方式下的内存占用和随机读吞吐
+ * 数据文件是缓冲池的4倍，开始前丢弃该文件的页缓存，之后在整个文件上均匀随机fetch_page/unpin_page
+ * RSS增量是缓冲池帧内存实际占用的部分；page cache是结束时该文件留在内核页缓存中的大小（mincore统计），
+ * 经过页缓存读盘时同一页面在两处各存一份 */
+
+static constexpr int NUM_PAGES = 32768;
+static constexpr int POOL_SIZE = 8192;
+static constexpr int NUM_READS = 200000;
+
+int main() {
+    std::string path = "direct_io_bench.db";
+    DiskManager disk_manager;
+    create_bench_file(&disk_manager, path, NUM_PAGES);
+
+    printf("%d pages (%d MB), %d frames (%d MB), %d uniform random reads\n", NUM_PAGES,
+           NUM_PAGES * PAGE_SIZE / (1024 * 1024), POOL_SIZE, POOL_SIZE * PAGE_SIZE / (1024 * 1024), NUM_READS);
+    printf("%-24s %10s %10s %10s %16s\n", "mode", "K reads/s", "hit ratio", "RSS +MB", "page cache MB");
+    const struct {
+        const char *name;
+        bool direct;
+        bool huge_pages;
+    } modes[] = {{"page cache", false, false}, {"O_DIRECT", true, false}, {"O_DIRECT + huge pages", true, true}};
+    for (auto mode : modes) {
+        disk_manager.set_direct_io(mode.direct);
+        int fd = disk_manager.open_file(path);
+        drop_page_cache(fd);
+        double rss_before = rss_mb();
+        double rss_after = 0;
+        double seconds = 0;
+        BufferPoolStats stats;
+        {
+            BufferPoolManager bpm(POOL_SIZE, &disk_manager, 1, ReplacerType::LRU, mode.huge_pages);
+            std::mt19937 rng(3);
+            BenchTimer timer;
+            for (int i = 0; i < NUM_READS; i++) {
+                PageId page_id{fd, static_cast<page_id_t>(rng() % NUM_PAGES)};
+                bpm.fetch_page(page_id);
+                bpm.unpin_page(page_id, false);
+            }
+            seconds = timer.seconds();
+            stats = bpm.get_stats();
+            rss_after = rss_mb();
+        }
+        printf("%-24s %10.1f %10.3f %10.1f %16.1f\n", mode.name, NUM_READS / seconds / 1e3,
+               static_cast<double>(stats.hits) / (stats.hits + stats.misses), rss_after - rss_before,
+               page_cache_mb(path));
+        disk_manager.close_file(fd);
+    }
+    disk_manager.set_direct_io(false);
+    disk_manager.destroy_file(path);
+    return 0;
+}
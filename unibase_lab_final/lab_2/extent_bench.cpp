@@ -0,0 +1,78 @@
+#include <linux/fiemap.h>
+#include <linux/fs.h>
+#include <sys/ioctl.h>
+
+#include <vector>
+
+#include "bench_util.h"
+#include "storage/buffer_pool_manager.h"
+
+/* 文件增长时按区预分配磁盘空间的效果：用new_page向文件追加页面，缓冲池远小于文件，追加过程中不断淘汰脏页写回，
+ * 最后flush_all_pages并fsync；比较不预分配（extent 0）和每次预分配64页，以及一个文件单独增长和两个文件交替增长
+ * extents为文件在磁盘上的区段数（FIEMAP统计），越少说明文件越连续 */
+
+static constexpr int NUM_PAGES = 50000;  // 每轮追加的页面总数
+static constexpr int POOL_SIZE = 256;
+static constexpr int ROUNDS = 2;
+
+/**
+ * @description: 文件在磁盘上的区段数，文件系统不支持FIEMAP时返回-1
+ */
+static int count_extents(int fd) {
+    struct fiemap fm {};
+    fm.fm_length = FIEMAP_MAX_OFFSET;
+    fm.fm_flags = FIEMAP_FLAG_SYNC;
+    fm.fm_extent_count = 0;  // 只统计区段数
+    if (ioctl(fd, FS_IOC_FIEMAP, &fm) != 0) {
+        return -1;
+    }
+    return static_cast<int>(fm.fm_mapped_extents);
+}
+
+int main() {
+    printf("%d new pages per run, %d frames, flush_all_pages + fsync at the end\n", NUM_PAGES, POOL_SIZE);
+    printf("%-7s %-6s %6s %10s %16s\n", "extent", "files", "round", "ms", "extents/file");
+    for (int num_files : {1, 2}) {
+        for (int round = 0; round < ROUNDS; round++) {
+            for (int extent_size : {0, 64}) {
+                DiskManager disk_manager;
+                disk_manager.set_extent_size(extent_size);
+                std::vector<int> fds;
+                for (int i = 0; i < num_files; i++) {
+                    std::string path = "extent_bench_" + std::to_string(i) + ".db";
+                    if (disk_manager.is_file(path)) {
+                        disk_manager.destroy_file(path);
+                    }
+                    disk_manager.create_file(path);
+                    fds.push_back(disk_manager.open_file(path));
+                }
+                BenchTimer timer;
+                {
+                    BufferPoolManager bpm(POOL_SIZE, &disk_manager);
+                    for (int i = 0; i < NUM_PAGES; i++) {
+                        PageId page_id{fds[i % num_files], INVALID_PAGE_ID};
+                        Page *page = bpm.new_page(&page_id);
+                        memset(page->get_data(), i, PAGE_SIZE);
+                        bpm.unpin_page(page, true);
+                    }
+                    for (int fd : fds) {
+                        bpm.flush_all_pages(fd);
+                        fsync(fd);
+                    }
+                }
+                double ms = timer.seconds() * 1e3;
+                int extents = 0;
+                for (int fd : fds) {
+                    extents += count_extents(fd);
+                }
+                printf("%-7d %-6d %6d %10.1f %16.1f\n", extent_size, num_files, round, ms,
+                       static_cast<double>(extents) / num_files);
+                for (int i = 0; i < num_files; i++) {
+                    disk_manager.close_file(fds[i]);
+                    disk_manager.destroy_file("extent_bench_" + std::to_string(i) + ".db");
+                }
+            }
+        }
+    }
+    return 0;
+}
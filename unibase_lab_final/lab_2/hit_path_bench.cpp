@@ -0,0 +1,114 @@
+#include <mutex>
+#include <random>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "bench_util.h"
+#include "storage/buffer_pool_manager.h"
+
+/* 命中路径的耗时和多线程扩展性：缓冲池能容纳整个文件，预热后每次fetch_page都命中
+ * locked：对照实现，按加入无锁路径之前的做法，命中时持有全局latch_查unordered_map页表，并调用带锁的replacer的pin/unpin
+ * unpin by PageId：无锁查表和固定，unpin_page(PageId)在latch_下查表后无锁减少计数
+ * unpin by Page*：无锁查表和固定，unpin_page(Page*)整个过程不加锁 */
+
+static constexpr int NUM_PAGES = 4096;
+static constexpr int POOL_SIZE = 8192;
+static constexpr int TOTAL_OPS = 4000000;  // 每轮所有线程合计的fetch/unpin次数
+
+class LockedHitPath {
+   public:
+    LockedHitPath(int fd) : replacer_(NUM_PAGES), pin_counts_(NUM_PAGES, 0) {
+        for (int i = 0; i < NUM_PAGES; i++) {
+            page_table_[PageId{fd, i}] = i;
+            replacer_.unpin(i);
+        }
+    }
+
+    frame_id_t fetch(PageId page_id) {
+        std::scoped_lock lock{latch_};
+        auto iter = page_table_.find(page_id);
+        if (iter == page_table_.end()) {
+            return INVALID_FRAME_ID;
+        }
+        pin_counts_[iter->second]++;
+        replacer_.pin(iter->second);
+        return iter->second;
+    }
+
+    void unpin(PageId page_id) {
+        std::scoped_lock lock{latch_};
+        frame_id_t frame_id = page_table_.find(page_id)->second;
+        if (--pin_counts_[frame_id] == 0) {
+            replacer_.unpin(frame_id);
+        }
+    }
+
+   private:
+    std::mutex latch_;
+    std::unordered_map<PageId, frame_id_t, PageIdHash> page_table_;
+    LRUReplacer replacer_;
+    std::vector<int> pin_counts_;
+};
+
+enum class HitPath { LOCKED, UNPIN_BY_PAGE_ID, UNPIN_BY_PAGE };
+
+/**
+ * @return 每次fetch/unpin的平均耗时（纳秒，按所有线程的总吞吐折算）
+ */
+static double run(HitPath path, BufferPoolManager *bpm, LockedHitPath *locked, int fd, int num_threads) {
+    std::vector<std::thread> threads;
+    int ops_per_thread = TOTAL_OPS / num_threads;
+    BenchTimer timer;
+    for (int t = 0; t < num_threads; t++) {
+        threads.emplace_back([=] {
+            std::mt19937 rng(t);
+            for (int i = 0; i < ops_per_thread; i++) {
+                PageId page_id{fd, static_cast<page_id_t>(rng() % NUM_PAGES)};
+                if (path == HitPath::LOCKED) {
+                    locked->fetch(page_id);
+                    locked->unpin(page_id);
+                } else if (path == HitPath::UNPIN_BY_PAGE_ID) {
+                    bpm->fetch_page(page_id);
+                    bpm->unpin_page(page_id, false);
+                } else {
+                    bpm->unpin_page(bpm->fetch_page(page_id), false);
+                }
+            }
+        });
+    }
+    for (auto &thread : threads) {
+        thread.join();
+    }
+    return timer.seconds() * 1e9 / (static_cast<double>(num_threads) * ops_per_thread);
+}
+
+int main() {
+    std::string path = "hit_path_bench.db";
+    DiskManager disk_manager;
+    create_bench_file(&disk_manager, path, NUM_PAGES);
+    int fd = disk_manager.open_file(path);
+
+    BufferPoolManager bpm(POOL_SIZE, &disk_manager);
+    for (int i = 0; i < NUM_PAGES; i++) {
+        bpm.unpin_page(bpm.fetch_page({fd, i}), false);
+    }
+    LockedHitPath locked(fd);
+
+    printf("%u hardware threads, %d resident pages, %d fetch/unpin per run, all hits\n",
+           std::thread::hardware_concurrency(), NUM_PAGES, TOTAL_OPS);
+    printf("ns per fetch/unpin (total throughput)\n");
+    printf("threads   locked   unpin by PageId   unpin by Page*\n");
+    for (int num_threads : {1, 2, 4, 8, 16, 32}) {
+        double locked_ns = run(HitPath::LOCKED, &bpm, &locked, fd, num_threads);
+        double page_id_ns = run(HitPath::UNPIN_BY_PAGE_ID, &bpm, &locked, fd, num_threads);
+        double page_ns = run(HitPath::UNPIN_BY_PAGE, &bpm, &locked, fd, num_threads);
+        printf("%7d %8.1f %17.1f %16.1f\n", num_threads, locked_ns, page_id_ns, page_ns);
+    }
+    BufferPoolStats stats = bpm.get_stats();
+    printf("buffer pool misses after warm-up: %lu\n", static_cast<unsigned long>(stats.misses - NUM_PAGES));
+
+    disk_manager.close_file(fd);
+    disk_manager.destroy_file(path);
+    return 0;
+}
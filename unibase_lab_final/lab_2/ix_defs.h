@@ -11,6 +11,10 @@ constexpr int IX_LEAF_HEADER_PAGE = 1;
 constexpr int IX_INIT_ROOT_PAGE = 2;
 constexpr int IX_INIT_NUM_PAGES = 3;
 constexpr int IX_MAX_COL_LEN = 512;
+// 文件头中last_leaf_之后的扩展部分以该值开头；旧格式的文件头在last_leaf_处结束，没有扩展部分
+constexpr int IX_FILE_HDR_MAGIC = 0x49584844;  // "IXHD"
+// 扩展部分的格式版本：1为num_file_pages_和free_page_map_
+constexpr int IX_FILE_HDR_VERSION = 1;
 
 class IxFileHdr {
 public: 
@@ -26,16 +30,22 @@ public:
     // first_leaf初始化之后没有进行修改，只不过是在测试文件中遍历叶子结点的时候用了
     page_id_t first_leaf_;              // 首叶节点对应的页号，在上层IxManager的open函数进行初始化，初始化为root page_no
     page_id_t last_leaf_;               // 尾叶节点对应的页号
+    int version_;                       // 文件头格式版本，读到旧格式的文件头时为0
+    int num_file_pages_;                // 文件中已分配的页面个数（含已释放的页面），打开文件时据此设置DiskManager的分配起点
+    std::vector<char> free_page_map_;   // 已释放页面的位图，格式同DiskManager::get_free_page_map，超出文件头页的部分被截掉
     int tot_len_;                       // 记录结构体的整体长度
 
     IxFileHdr() {
-        tot_len_ = col_num_ = 0;
+        tot_len_ = col_num_ = num_file_pages_ = 0;
+        version_ = IX_FILE_HDR_VERSION;
     }
 
     IxFileHdr(page_id_t first_free_page_no, int num_pages, page_id_t root_page, int col_num,
                 int col_tot_len, int btree_order, int keys_size, page_id_t first_leaf, page_id_t last_leaf)
                 : first_free_page_no_(first_free_page_no), num_pages_(num_pages), root_page_(root_page), col_num_(col_num),
                 col_tot_len_(col_tot_len), btree_order_(btree_order), keys_size_(keys_size), first_leaf_(first_leaf), last_leaf_(last_leaf) {
+                    version_ = IX_FILE_HDR_VERSION;
+                    num_file_pages_ = num_pages;
                     tot_len_ = 0;
                 } 
 
@@ -43,6 +53,21 @@ public:
         tot_len_ = 0;
         tot_len_ += sizeof(page_id_t) * 4 + sizeof(int) * 6;
         tot_len_ += sizeof(ColType) * col_num_ + sizeof(int) * col_num_;
+        tot_len_ += sizeof(int) * 4 + free_page_map_.size();
+    }
+
+    /**
+     * @brief 更新文件头中的已分配页面个数和空闲页位图，位图放不下文件头页时截掉末尾，被截掉的空闲页不再被复用
+     */
+    void set_free_page_map(int num_file_pages, std::vector<char> free_page_map) {
+        num_file_pages_ = num_file_pages;
+        free_page_map_.clear();
+        update_tot_len();
+        if (free_page_map.size() > static_cast<size_t>(PAGE_SIZE - tot_len_)) {
+            free_page_map.resize(PAGE_SIZE - tot_len_);
+        }
+        free_page_map_ = std::move(free_page_map);
+        update_tot_len();
     }
 
     void serialize(char* dest) {
@@ -75,6 +100,17 @@ public:
         offset += sizeof(page_id_t);
         memcpy(dest + offset, &last_leaf_, sizeof(page_id_t));
         offset += sizeof(page_id_t);
+        memcpy(dest + offset, &IX_FILE_HDR_MAGIC, sizeof(int));
+        offset += sizeof(int);
+        memcpy(dest + offset, &IX_FILE_HDR_VERSION, sizeof(int));
+        offset += sizeof(int);
+        memcpy(dest + offset, &num_file_pages_, sizeof(int));
+        offset += sizeof(int);
+        int map_size = free_page_map_.size();
+        memcpy(dest + offset, &map_size, sizeof(int));
+        offset += sizeof(int);
+        memcpy(dest + offset, free_page_map_.data(), map_size);
+        offset += map_size;
         assert(offset == tot_len_);
     }
 
@@ -113,6 +149,22 @@ public:
         offset += sizeof(page_id_t);
         last_leaf_ = *reinterpret_cast<const page_id_t*>(src + offset);
         offset += sizeof(page_id_t);
+        // 旧格式的文件头到此结束，已分配页面个数由打开文件的一方根据文件大小推算，没有已释放页面
+        if (offset == tot_len_ || *reinterpret_cast<const int*>(src + offset) != IX_FILE_HDR_MAGIC) {
+            version_ = 0;
+            num_file_pages_ = 0;
+            free_page_map_.clear();
+            return;
+        }
+        offset += sizeof(int);
+        version_ = *reinterpret_cast<const int*>(src + offset);
+        offset += sizeof(int);
+        num_file_pages_ = *reinterpret_cast<const int*>(src + offset);
+        offset += sizeof(int);
+        int map_size = *reinterpret_cast<const int*>(src + offset);
+        offset += sizeof(int);
+        free_page_map_.assign(src + offset, src + offset + map_size);
+        offset += map_size;
         assert(offset == tot_len_);
     }
 };
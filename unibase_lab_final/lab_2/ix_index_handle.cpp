@@ -16,41 +16,34 @@ int IxNodeHandle::lower_bound(const char *target) const
 
     int left = 0;
 
-    int right = page_hdr->num_key; // 更规范的命名，使用num_keys而不是num_key
+    int right = page_hdr->num_key; // 在[left, right)中查找，right=num_key表示所有key都小于target
 
-    while (left <= right)
+    while (left < right)
     {
 
         int mid = left + (right - left) / 2; // 防止溢出，使用更安全的计算方式
 
         int cmp = ix_compare(target, get_key(mid), file_hdr->col_types_, file_hdr->col_lens_);
 
-        if (cmp == 0)
+        if (cmp > 0)
         {
 
-            // 找到了等于target的key，直接返回索引
-
-            return mid;
-        }
-        else if (cmp < 0)
-        {
-
-            // target小于当前节点的key，继续在左侧查找
+            // target大于当前节点的key，继续在右侧查找
 
-            right = mid - 1;
+            left = mid + 1;
         }
         else
         {
 
-            // target大于当前节点的key，继续在右侧查找
+            // target小于等于当前节点的key，第一个>=target的key在mid或其左侧
 
-            left = mid + 1;
+            right = mid;
         }
     }
 
-    // 如果没有找到等于target的key，返回最接近target且大于它的key的位置（即插入位置）
+    // 返回第一个大于等于target的key的位置（即插入位置），不存在时为num_key
 
-    return left; // 使用left作为返回值，因为此时left已经指向了第一个大于target的位置或数组末尾
+    return left;
 }
 
 /**
@@ -72,35 +65,28 @@ int IxNodeHandle::upper_bound(const char *target) const
 
     int left = 0;
 
-    int right = page_hdr->num_key - 1; // 更规范的命名，使用num_keys，并调整初始范围
+    int right = page_hdr->num_key; // 在[left, right)中查找
 
-    while (left <= right)
+    while (left < right)
     {
 
         int mid = left + (right - left) / 2; // 防止溢出，使用更安全的计算方式
 
         int cmp = ix_compare(target, get_key(mid), file_hdr->col_types_, file_hdr->col_lens_);
 
-        if (cmp == 0)
+        if (cmp >= 0)
         {
 
-            // 找到了等于target的key，返回其后一个位置的索引
-
-            return mid + 1;
-        }
-        else if (cmp < 0)
-        {
-
-            // target小于当前节点的key，继续在右侧查找
+            // target大于等于当前节点的key，继续在右侧查找
 
             left = mid + 1;
         }
         else
         {
 
-            // target大于当前节点的key，继续在左侧查找
+            // target小于当前节点的key，第一个>target的key在mid或其左侧
 
-            right = mid - 1;
+            right = mid;
         }
     }
 
@@ -126,7 +112,7 @@ bool IxNodeHandle::leaf_lookup(const char *key, Rid **value)
     // 1
     auto it = lower_bound(key);
     // 2
-    if (it != page_hdr->num_key)
+    if (it != page_hdr->num_key && ix_compare(key, get_key(it), file_hdr->col_types_, file_hdr->col_lens_) == 0)
     {
         *value = get_rid(it);
         return true;
@@ -151,21 +137,8 @@ page_id_t IxNodeHandle::internal_lookup(const char *key)
     //     throw IndexEntryNotFoundError();
     //}
 
-    // 暂时处理不了小于最小值
-    int child_index = -1;
-    int num_key = get_size();
-    for (int i = 1; i < num_key; i++)
-    {
-        if (ix_compare(key, get_key(i), file_hdr->col_types_[i], file_hdr->col_lens_[i]) < 0)
-        {
-            child_index = i - 1;
-            break;
-        }
-    }
-    if (child_index == -1)
-    {
-        child_index = num_key - 1;
-    }
+    // 第i个key是第i个孩子中的最小key，目标在最后一个不大于key的孩子中；小于第0个key时也落在第0个孩子中
+    int child_index = std::max(upper_bound(key) - 1, 0);
     return value_at(child_index);
 }
 
@@ -191,12 +164,12 @@ void IxNodeHandle::insert_pairs(int pos, const char *key, const Rid *rid, int n)
     // 3. 通过rid获取n个连续键值对的rid值，并把n个rid值插入到pos位置
     // 4. 更新当前节点的键数量
 
-    if (pos < 0 || pos + n > get_max_size())
+    if (pos < 0 || pos > get_size() || get_size() + n > get_max_size())
     {
         return;
     }
 
-    memmove(rids + (pos + n) * sizeof(Rid), rids + pos * sizeof(Rid), (get_size() - pos) * sizeof(Rid));
+    memmove(rids + pos + n, rids + pos, (get_size() - pos) * sizeof(Rid));
 
     memmove(keys + (pos + n) * file_hdr->col_tot_len_, keys + pos * file_hdr->col_tot_len_, (get_size() - pos) * file_hdr->col_tot_len_);
 
@@ -233,7 +206,7 @@ int IxNodeHandle::insert(const char *key, const Rid &value)
     // printf("insert start\n");
     int pos = lower_bound(key);
     // printf("%d\n",pos);
-    if (pos < get_size() && ix_compare(key, get_key(pos), file_hdr->col_types_[pos], file_hdr->col_lens_[pos]) == 0)
+    if (pos < get_size() && ix_compare(key, get_key(pos), file_hdr->col_types_, file_hdr->col_lens_) == 0)
     {
         return get_size();
     }
@@ -264,8 +237,7 @@ void IxNodeHandle::erase_pair(int pos)
     memmove(key_slot, key_slot + len, mv_size * len); // 2
 
     Rid *rid_slot = get_rid(pos);
-    len = sizeof(Rid);
-    memmove(rid_slot, rid_slot + len, mv_size * len);
+    memmove(rid_slot, rid_slot + 1, mv_size * sizeof(Rid));
     set_size(get_size() - 1);
 }
 
@@ -283,8 +255,7 @@ int IxNodeHandle::remove(const char *key)
     // 3. 返回完成删除操作后的键值对数量
 
     int index = lower_bound(key);
-    int pos = lower_bound(key);
-    if (index != get_size() && ix_compare(key, get_key(index), file_hdr->col_types_[pos], file_hdr->col_lens_[pos]) == 0)
+    if (index != get_size() && ix_compare(key, get_key(index), file_hdr->col_types_, file_hdr->col_lens_) == 0)
         erase_pair(index);
     return get_size();
 }
@@ -300,9 +271,13 @@ IxIndexHandle::IxIndexHandle(DiskManager *disk_manager, BufferPoolManager *buffe
     file_hdr_ = new IxFileHdr();
     file_hdr_->deserialize(buf);
 
-    // disk_manager管理的fd对应的文件中，设置从file_hdr_->num_pages开始分配page_no
-    int now_page_no = disk_manager_->get_fd2pageno(fd);
-    disk_manager_->set_fd2pageno(fd, now_page_no + 1);
+    // 旧格式的文件头没有记录已分配页面个数，按文件中的页数推算（压缩文件不能用文件大小）；关闭索引时文件头以新格式写回
+    if (file_hdr_->version_ == 0) {
+        file_hdr_->num_file_pages_ = std::max(disk_manager_->get_file_num_pages(fd), IX_INIT_NUM_PAGES);
+    }
+    // disk_manager管理的fd对应的文件中，设置从file_hdr_->num_file_pages_开始分配page_no，并恢复已释放页面的位图
+    disk_manager_->set_fd2pageno(fd, file_hdr_->num_file_pages_);
+    disk_manager_->set_free_page_map(fd, file_hdr_->free_page_map_.data(), file_hdr_->free_page_map_.size());
 }
 
 /**
@@ -311,11 +286,10 @@ IxIndexHandle::IxIndexHandle(DiskManager *disk_manager, BufferPoolManager *buffe
  * @param operation 查找到目标键值对后要进行的操作类型
  * @param transaction 事务参数，如果不需要则默认传入nullptr
  * @return [leaf node] and [root_is_latched] 返回目标叶子结点以及根结点是否加锁
- * @note need to Unlatch and unpin the leaf node outside!
- * 注意：用了FindLeafPage之后一定要unlatch叶结点，否则下次latch该结点会堵塞！
+ * @note 调用方需持有root_latch_；返回的叶结点持有页面固定，释放结点时自动unpin
  */
-std::pair<IxNodeHandle *, bool> IxIndexHandle::find_leaf_page(const char *key, Operation operation,
-                                                              Transaction *transaction, bool find_first)
+std::pair<std::unique_ptr<IxNodeHandle>, bool> IxIndexHandle::find_leaf_page(const char *key, Operation operation,
+                                                                             Transaction *transaction, bool find_first)
 {
     // Todo:
     // 1. 获取根节点
@@ -325,16 +299,16 @@ std::pair<IxNodeHandle *, bool> IxIndexHandle::find_leaf_page(const char *key, O
     // internal_lookup 暂时处理不了找不到的情况
     // 一定找得到？
     page_id_t node_page = file_hdr_->root_page_;
-    IxNodeHandle *node_handle = fetch_node(node_page);
+    auto node_handle = fetch_node(node_page);
     while (!node_handle->is_leaf_page())
     {
         node_page = node_handle->internal_lookup(key);
-        node_handle = fetch_node(node_page);
+        node_handle = fetch_node(node_page); // 上一层结点在此处释放
     }
-    buffer_pool_manager_->unpin_page(node_handle->get_page_id(), false);
+    if (operation != Operation::FIND)
+        node_handle->mark_dirty();
 
-    root_latch_.unlock();
-    return std::make_pair(node_handle, false);
+    return std::make_pair(std::move(node_handle), false);
 }
 
 /**
@@ -347,12 +321,14 @@ std::pair<IxNodeHandle *, bool> IxIndexHandle::find_leaf_page(const char *key, O
  */
 bool IxIndexHandle::get_value(const char *key, std::vector<Rid> *result, Transaction *transaction)
 {
+    std::shared_lock lock{root_latch_};
+
     // 定义搜索操作类型为查找
     Operation op = Operation::FIND;
 
-    // 搜索包含目标键的叶子页面
+    // 搜索包含目标键的叶子页面，叶结点在函数返回时自动unpin
     auto searchResult = find_leaf_page(key, op, transaction, false);
-    IxNodeHandle *leafNodeHandle = searchResult.first;
+    auto &leafNodeHandle = searchResult.first;
 
     // 检查是否找到了叶子节点
     if (leafNodeHandle != nullptr)
@@ -366,34 +342,21 @@ bool IxIndexHandle::get_value(const char *key, std::vector<Rid> *result, Transac
             // 将找到的RID添加到结果向量中
             result->push_back(*foundRid);
 
-            // 从缓冲区池中取消固定页面
-            buffer_pool_manager_->unpin_page(leafNodeHandle->get_page_id(), false);
-
             // 成功找到值
             return true;
         }
-
-        // 如果没有找到键，则取消固定页面
-        buffer_pool_manager_->unpin_page(leafNodeHandle->get_page_id(), false);
     }
 
     // 如果到达这里，则表示在索引中未找到该键
-    // 注意：root_latch的解锁理应在函数外部处理或以RAII方式管理。
-    // 但由于要求不改变函数签名，我们将其保留在此处，并添加注释说明潜在改进。
-    root_latch_.unlock();
-
-    // 键未找到
     return false;
 }
 
 /**
  * @brief  将传入的一个node拆分(Split)成两个结点，在node的右边生成一个新结点new node
  * @param node 需要拆分的结点
- * @return 拆分得到的new_node
- * @note need to unpin the new node outside
- * 注意：本函数执行完毕后，原node和new node都需要在函数外面进行unpin
+ * @return 拆分得到的new_node，释放时自动unpin
  */
-IxNodeHandle *IxIndexHandle::split(IxNodeHandle *node)
+std::unique_ptr<IxNodeHandle> IxIndexHandle::split(IxNodeHandle *node)
 {
     // Todo:
     // 1. 将原结点的键值对平均分配，右半部分分裂为新的右兄弟结点
@@ -404,7 +367,7 @@ IxNodeHandle *IxIndexHandle::split(IxNodeHandle *node)
     int total_keys = node->get_size();
     int mid = total_keys / 2;
 
-    IxNodeHandle *new_node = create_node();
+    auto new_node = create_node();
     if (node->is_leaf_page())
         new_node->page_hdr->is_leaf = true;
     // 只有叶子会分出叶子
@@ -426,12 +389,14 @@ IxNodeHandle *IxIndexHandle::split(IxNodeHandle *node)
         new_node->set_prev_leaf(node->get_page_no());
         new_node->set_next_leaf(node->get_next_leaf());
         node->set_next_leaf(new_node->get_page_no());
+        // 原来的后继（最后一个叶子的后继是leaf header）的prev_leaf改为指向新结点，删除时erase_leaf依赖双向指针
+        fetch_node_mut(new_node->get_next_leaf())->set_prev_leaf(new_node->get_page_no());
     }
     else
     {
-        for (int i = 0; i <= new_node->get_size(); ++i)
+        for (int i = 0; i < new_node->get_size(); ++i)
         {
-            maintain_child(new_node, i);
+            maintain_child(new_node.get(), i);
 
             /*IxNodeHandle *child = fetch_node(new_node->value_at(i));
             child->set_parent_page_no(new_node->get_page_no());*/
@@ -452,7 +417,6 @@ IxNodeHandle *IxIndexHandle::split(IxNodeHandle *node)
  * @param key 要插入parent的key
  * @note 一个结点插入了键值对之后需要分裂，分裂后左半部分的键值对保留在原结点，在参数中称为old_node，
  * 右半部分的键值对分裂为新的右兄弟节点，在参数中称为new_node（参考Split函数来理解old_node和new_node）
- * @note 本函数执行完毕后，new node和old node都需要在函数外面进行unpin
  */
 void IxIndexHandle::insert_into_parent(IxNodeHandle *old_node, const char *key, IxNodeHandle *new_node,
                                        Transaction *transaction)
@@ -470,7 +434,7 @@ void IxIndexHandle::insert_into_parent(IxNodeHandle *old_node, const char *key,
     if (old_node->is_root_page())
     {
 
-        IxNodeHandle *new_root = create_node();
+        auto new_root = create_node();
 
         new_root->insert_pair(0, old_node->get_key(0), (Rid){old_node->get_page_no()});
         new_root->insert_pair(1, new_node->get_key(0), (Rid){new_node->get_page_no()});
@@ -487,15 +451,16 @@ void IxIndexHandle::insert_into_parent(IxNodeHandle *old_node, const char *key,
         return;
     }
 
-    IxNodeHandle *parent_node = fetch_node(old_node->get_parent_page_no());
+    auto parent_node = fetch_node_mut(old_node->get_parent_page_no());
 
-    int parent_insert_pos = parent_node->upper_bound(key); // 合理!
+    // new_node紧跟在old_node之后
+    int parent_insert_pos = parent_node->find_child(old_node) + 1;
     parent_node->insert_pair(parent_insert_pos, new_node->get_key(0), (Rid){new_node->get_page_no()});
 
     if (parent_node->get_size() >= parent_node->get_max_size())
     {
-        IxNodeHandle *new_parent_node = split(parent_node);
-        insert_into_parent(parent_node, key, new_parent_node, transaction);
+        auto new_parent_node = split(parent_node.get());
+        insert_into_parent(parent_node.get(), key, new_parent_node.get(), transaction);
     }
 }
 
@@ -507,13 +472,15 @@ void IxIndexHandle::insert_into_parent(IxNodeHandle *old_node, const char *key,
  */
 page_id_t IxIndexHandle::insert_entry(const char *key, const Rid &value, Transaction *transaction)
 {
+    check_writable();
+    std::scoped_lock lock{root_latch_};
+
     // 定义操作类型为插入
     Operation op = Operation::INSERT;
 
-    // 查找应该插入键值对的叶子节点，并获取是否根节点被锁定的信息
-    std::pair<IxNodeHandle *, bool> result = find_leaf_page(key, op, transaction, false);
-    IxNodeHandle *leaf_node = result.first; // 叶子节点指针
-    bool root_is_latched = result.second;   // 根节点是否被锁定的标志
+    // 查找应该插入键值对的叶子节点，叶子节点由result持有，函数返回时自动unpin
+    auto result = find_leaf_page(key, op, transaction, false);
+    IxNodeHandle *leaf_node = result.first.get(); // 叶子节点指针
 
     // 在叶子节点中插入键值对
     int insert_result = leaf_node->insert(key, value);
@@ -522,31 +489,16 @@ page_id_t IxIndexHandle::insert_entry(const char *key, const Rid &value, Transac
     if (insert_result == leaf_node->get_max_size())
     {
         // 分裂叶子节点，得到新的右兄弟节点
-        IxNodeHandle *new_node = split(leaf_node);
+        auto new_node = split(leaf_node);
 
         // 将分裂产生的新节点信息（以及可能需要重新定位的键）插入到父节点中
-        insert_into_parent(leaf_node, key, new_node, transaction);
+        insert_into_parent(leaf_node, key, new_node.get(), transaction);
 
         // 如果当前叶子节点是最后一个叶子节点，则更新文件头中的最后一个叶子节点页号
         if (file_hdr_->last_leaf_ == leaf_node->get_page_no())
         {
             file_hdr_->last_leaf_ = new_node->get_page_id().page_no;
         }
-
-        // 释放（unpin）叶子节点和新节点的页面，因为它们的修改已经完成
-        buffer_pool_manager_->unpin_page(leaf_node->get_page_id(), true);
-        buffer_pool_manager_->unpin_page(new_node->get_page_id(), true);
-    }
-    else
-    {
-        // 如果叶子节点未满，则只需释放（unpin）叶子节点的页面
-        buffer_pool_manager_->unpin_page(leaf_node->get_page_id(), true);
-    }
-
-    // 如果根节点被锁定，则解锁根节点（这通常发生在并发控制中，以确保对根节点的访问是安全的）
-    if (root_is_latched)
-    {
-        root_latch_.unlock();
     }
 
     // 返回插入键值对所在的叶子节点的页号（注意：这里返回的是叶子节点的页号，而不是新插入的键值对的具体位置）
@@ -566,16 +518,21 @@ bool IxIndexHandle::delete_entry(const char *key, Transaction *transaction)
     // 3. 如果删除成功需要调用CoalesceOrRedistribute来进行合并或重分配操作，并根据函数返回结果判断是否有结点需要删除
     // 4. 如果需要并发，并且需要删除叶子结点，则需要在事务的delete_page_set中添加删除结点的对应页面；记得处理并发的上锁
 
+    check_writable();
+    std::scoped_lock lock{root_latch_};
+
     // 1
-    IxNodeHandle *leaf = find_leaf_page(key, Operation::DELETE, transaction).first;
+    auto leaf = find_leaf_page(key, Operation::DELETE, transaction).first;
     int num = leaf->get_size();
     // 2
     bool res = (num != leaf->remove(key));
     // 3
     if (res)
-        coalesce_or_redistribute(leaf);
+        coalesce_or_redistribute(leaf.get());
 
-    buffer_pool_manager_->unpin_page(leaf->get_page_id(), res);
+    // 所有结点都已unpin，此时才能释放被合并掉的结点的页面
+    leaf.reset();
+    free_released_pages();
 
     return res;
 }
@@ -609,21 +566,20 @@ bool IxIndexHandle::coalesce_or_redistribute(IxNodeHandle *node, Transaction *tr
     }
     else
     {
-        IxNodeHandle *parent = fetch_node(node->get_parent_page_no()); // 2
+        auto parent = fetch_node_mut(node->get_parent_page_no()); // 2
         int index = parent->find_child(node);
-        IxNodeHandle *neighbor = fetch_node(parent->get_rid(index + (index ? -1 : 1))->page_no); // 3
+        auto neighbor = fetch_node_mut(parent->get_rid(index + (index ? -1 : 1))->page_no); // 3
         if (node->get_size() + neighbor->get_size() >= node->get_min_size() * 2)
         { // 4
-            redistribute(neighbor, node, parent, index);
-            buffer_pool_manager_->unpin_page(parent->get_page_id(), true);
-            buffer_pool_manager_->unpin_page(neighbor->get_page_id(), true);
+            redistribute(neighbor.get(), node, parent.get(), index);
             return false;
         }
         else
         {
-            coalesce(&neighbor, &node, &parent, index, transaction, root_is_latched); // 5
-            buffer_pool_manager_->unpin_page(parent->get_page_id(), true);
-            buffer_pool_manager_->unpin_page(neighbor->get_page_id(), true);
+            // coalesce可能交换node和neighbor，只交换裸指针，页面固定仍由parent和neighbor持有
+            IxNodeHandle *neighbor_node = neighbor.get();
+            IxNodeHandle *parent_node = parent.get();
+            coalesce(&neighbor_node, &node, &parent_node, index, transaction, root_is_latched); // 5
             return true;
         }
     }
@@ -643,23 +599,16 @@ bool IxIndexHandle::adjust_root(IxNodeHandle *old_root_node)
     // 1. 如果old_root_node是内部结点，并且大小为1，则直接把它的孩子更新成新的根结点
     // 2. 如果old_root_node是叶结点，且大小为0，则直接更新root page
     // 3. 除了上述两种情况，不需要进行操作
+    // 叶结点的根变空时保留为空树的根：插入和扫描都假定根存在，且它仍是first_leaf_和last_leaf_
     if (!old_root_node->is_leaf_page() && old_root_node->page_hdr->num_key == 1)
     {
-        IxNodeHandle *child = fetch_node(old_root_node->get_rid(0)->page_no);
+        auto child = fetch_node_mut(old_root_node->get_rid(0)->page_no);
         release_node_handle(*old_root_node);
         file_hdr_->root_page_ = child->get_page_no();
         child->set_parent_page_no(IX_NO_PAGE);
-        buffer_pool_manager_->unpin_page(child->get_page_id(), true);
         return true;
     }
-    else if (old_root_node->is_leaf_page() && !old_root_node->page_hdr->num_key)
-    {
-        release_node_handle(*old_root_node);
-        file_hdr_->root_page_ = INVALID_PAGE_ID;
-        return true;
-    }
-    else
-        return false;
+    return false;
 }
 
 /**
@@ -708,34 +657,34 @@ void IxIndexHandle::redistribute(IxNodeHandle *neighbor_node, IxNodeHandle *node
 bool IxIndexHandle::coalesce(IxNodeHandle **neighbor_node, IxNodeHandle **node, IxNodeHandle **parent, int index,
                              Transaction *transaction, bool *root_is_latched)
 {
-    // 确保neighbor_node是左节点，node是右节点
+    // 确保neighbor_node是左节点，node是右节点；交换后被删除的右结点在parent中的位置是1
     if (!index)
     {
         IxNodeHandle *temp = *neighbor_node;
         *neighbor_node = *node;
         *node = temp;
-        // 注意：这里不需要改变index，因为我们在parent中的位置没有改变
+        index = 1;
     }
 
     // 更新最后叶子节点的指针（如果适用）
     if ((*node)->is_leaf_page() && (*node)->get_page_no() == file_hdr_->last_leaf_)
         file_hdr_->last_leaf_ = (*neighbor_node)->get_page_no();
 
-    // 将node中的所有键值对移动到neighbor_node中
+    // 将node中的所有键值对移动到neighbor_node中，内部结点还要把移过去的孩子的父指针改为neighbor_node
     int neighbor_size = (*neighbor_node)->get_size();
     for (int i = 0; i < (*node)->get_size(); i++)
     {
-        (*neighbor_node)->insert_pair(neighbor_size + i, (*node)->get_key(i), (*node)->get_rid(i));
-        // 注意：这里可能需要一个额外的函数来更新子节点的父指针，或者insert_pair已经包含了这一逻辑
-        // 假设insert_pair已经处理了子节点的父指针更新，这里就不调用maintain_child了
+        (*neighbor_node)->insert_pair(neighbor_size + i, (*node)->get_key(i), *(*node)->get_rid(i));
+        maintain_child(*neighbor_node, neighbor_size + i);
     }
 
-    // 删除和释放node节点
-    erase_leaf(*node); // 假设这个函数也处理了非叶子节点的情况，或者应该有不同的函数来处理
+    // 删除和释放node节点，叶结点先从叶子链表中摘除
+    if ((*node)->is_leaf_page())
+        erase_leaf(*node);
     release_node_handle(**node);
 
     // 从parent中删除对node的引用
-    (*parent)->erase_pair(index); // 注意：这里应该是erase_child而不是erase_pair，因为我们在处理子节点
+    (*parent)->erase_pair(index);
 
     // 检查parent节点是否需要进一步的合并或重分配
     return coalesce_or_redistribute(*parent, transaction, root_is_latched); // 传递root_is_latched参数
@@ -752,12 +701,12 @@ bool IxIndexHandle::coalesce(IxNodeHandle **neighbor_node, IxNodeHandle **node,
  */
 Rid IxIndexHandle::get_rid(const Iid &iid) const
 {
-    IxNodeHandle *node = fetch_node(iid.page_no);
+    std::shared_lock lock{root_latch_};
+    auto node = fetch_node(iid.page_no);
     if (iid.slot_no >= node->get_size())
     {
         throw IndexEntryNotFoundError();
     }
-    buffer_pool_manager_->unpin_page(node->get_page_id(), false);
     return *node->get_rid(iid.slot_no);
 }
 
@@ -794,9 +743,9 @@ Iid IxIndexHandle::upper_bound(const char *key)
  */
 Iid IxIndexHandle::leaf_end() const
 {
-    IxNodeHandle *node = fetch_node(file_hdr_->last_leaf_);
+    std::shared_lock lock{root_latch_};
+    auto node = fetch_node(file_hdr_->last_leaf_);
     Iid iid = {.page_no = file_hdr_->last_leaf_, .slot_no = node->get_size()};
-    buffer_pool_manager_->unpin_page(node->get_page_id(), false); // unpin it!
     return iid;
 }
 
@@ -812,42 +761,68 @@ Iid IxIndexHandle::leaf_begin() const
     return iid;
 }
 
+/**
+ * @brief 只读打开（文件映射为只读）的索引不能修改，在修改任何结点之前抛出异常
+ */
+void IxIndexHandle::check_writable() const
+{
+    if (disk_manager_->is_mapped(fd_))
+    {
+        throw InternalError("IxIndexHandle: index is opened read-only");
+    }
+}
+
 /**
  * @brief 获取一个指定结点
  *
  * @param page_no
- * @return IxNodeHandle*
- * @note pin the page, remember to unpin it outside!
+ * @param pattern 访问模式，范围扫描传入SEQUENTIAL
+ * @return std::unique_ptr<IxNodeHandle> 结点持有页面的固定，释放结点时自动unpin
  */
-IxNodeHandle *IxIndexHandle::fetch_node(int page_no) const
+std::unique_ptr<IxNodeHandle> IxIndexHandle::fetch_node(int page_no, AccessPattern pattern) const
 {
-    Page *page = buffer_pool_manager_->fetch_page(PageId{fd_, page_no});
-    IxNodeHandle *node = new IxNodeHandle(file_hdr_, page);
+    return std::make_unique<IxNodeHandle>(file_hdr_,
+                                          buffer_pool_manager_->fetch_page_basic(PageId{fd_, page_no}, pattern));
+}
 
+/**
+ * @brief 获取一个将被修改的结点，释放结点时页面被标记为脏页
+ *
+ * @param page_no
+ * @return std::unique_ptr<IxNodeHandle>
+ */
+std::unique_ptr<IxNodeHandle> IxIndexHandle::fetch_node_mut(int page_no) const
+{
+    auto node = fetch_node(page_no);
+    node->mark_dirty();
     return node;
 }
 
 /**
  * @brief 创建一个新结点
  *
- * @return IxNodeHandle*
- * @note pin the page, remember to unpin it outside!
+ * @return std::unique_ptr<IxNodeHandle> 释放结点时自动unpin，新结点总是脏页
  * 注意：对于Index的处理是，删除某个页面后，认为该被删除的页面是free_page
  * 而first_free_page实际上就是最新被删除的页面，初始为IX_NO_PAGE
  * 在最开始插入时，一直是create node，那么first_page_no一直没变，一直是IX_NO_PAGE
  * 与Record的处理不同，Record将未插入满的记录页认为是free_page
  */
-IxNodeHandle *IxIndexHandle::create_node()
+std::unique_ptr<IxNodeHandle> IxIndexHandle::create_node()
 {
-    IxNodeHandle *node;
     (file_hdr_->num_pages_)++;
 
     // 从3开始分配page_no，第一次分配之后，new_page_id.page_no=3，file_hdr_.num_pages=4
     PageId new_page_id = {.fd = fd_, .page_no = INVALID_PAGE_ID};
-    Page *page = buffer_pool_manager_->new_page(&new_page_id);
-
-    node = new IxNodeHandle(file_hdr_, page);
-
+    auto node = std::make_unique<IxNodeHandle>(file_hdr_, buffer_pool_manager_->new_page_basic(&new_page_id));
+    // 页号可能是被合并掉的结点释放的，页头必须显式初始化为空的内部结点，由调用者再设置is_leaf和指针
+    *node->page_hdr = {
+        .next_free_page_no = IX_NO_PAGE,
+        .parent = IX_NO_PAGE,
+        .num_key = 0,
+        .is_leaf = false,
+        .prev_leaf = IX_NO_PAGE,
+        .next_leaf = IX_NO_PAGE,
+    };
     return node;
 }
 
@@ -859,12 +834,13 @@ IxNodeHandle *IxIndexHandle::create_node()
 void IxIndexHandle::maintain_parent(IxNodeHandle *node)
 {
     IxNodeHandle *curr = node;
+    std::unique_ptr<IxNodeHandle> curr_owner; // 向上遍历时持有当前节点，保证其页面一直被固定
 
     // 遍历直到没有父节点
     while (curr->get_parent_page_no() != IX_NO_PAGE)
     {
         // 加载当前节点的父节点
-        IxNodeHandle *parent = fetch_node(curr->get_parent_page_no());
+        auto parent = fetch_node_mut(curr->get_parent_page_no());
 
         // 在父节点中找到当前节点的位置
         int rank = parent->find_child(curr);
@@ -873,21 +849,18 @@ void IxIndexHandle::maintain_parent(IxNodeHandle *node)
         char *parent_key = parent->get_key(rank);
         char *child_first_key = curr->get_key(0);
 
-        // 如果父节点的键已经与当前节点的第一个键相同，则无需更新，直接解锁并退出循环
+        // 如果父节点的键已经与当前节点的第一个键相同，则无需更新，直接退出循环
         if (memcmp(parent_key, child_first_key, file_hdr_->col_tot_len_) == 0)
         {
-            assert(buffer_pool_manager_->unpin_page(parent->get_page_id(), true));
             break;
         }
 
         // 更新父节点的键为当前节点的第一个键
         memcpy(parent_key, child_first_key, file_hdr_->col_tot_len_);
 
-        // 将当前节点设置为父节点，继续向上遍历
-        curr = parent;
-
-        // 解锁当前父节点（注意：这里解锁的是更新后的父节点）
-        assert(buffer_pool_manager_->unpin_page(parent->get_page_id(), true));
+        // 将当前节点设置为父节点，继续向上遍历；原来持有的节点在此处释放
+        curr_owner = std::move(parent);
+        curr = curr_owner.get();
     }
 }
 
@@ -902,33 +875,50 @@ void IxIndexHandle::erase_leaf(IxNodeHandle *leaf)
     assert(leaf->is_leaf_page());
 
     // 获取要删除叶节点的前一个叶节点
-    IxNodeHandle *prev = fetch_node(leaf->get_prev_leaf());
+    auto prev = fetch_node_mut(leaf->get_prev_leaf());
 
     // 更新前一个叶节点的next_leaf指针，指向当前叶节点的下一个叶节点
     prev->set_next_leaf(leaf->get_next_leaf());
 
-    // 解锁前一个叶节点（注意：这里假设fetch_node已经对页面进行了加锁）
-    assert(buffer_pool_manager_->unpin_page(prev->get_page_id(), true));
+    // 释放前一个叶节点
+    prev.reset();
 
     // 获取要删除叶节点的下一个叶节点
-    IxNodeHandle *next = fetch_node(leaf->get_next_leaf());
+    auto next = fetch_node_mut(leaf->get_next_leaf());
 
     // 更新下一个叶节点的prev_leaf指针，指向当前叶节点的前一个叶节点
     // 注意：原代码中的注释“注意此处是SetPrevLeaf()”实际上是对函数调用的说明，已体现在代码中
     next->set_prev_leaf(leaf->get_prev_leaf());
-
-    // 解锁下一个叶节点
-    assert(buffer_pool_manager_->unpin_page(next->get_page_id(), true));
 }
 
 /**
- * @brief 删除node时，更新file_hdr_.num_pages
+ * @brief 删除node时，更新file_hdr_.num_pages，并记录其页号
+ * 此时node及其父结点等仍被固定，页面在free_released_pages中统一释放
  *
  * @param node
  */
 void IxIndexHandle::release_node_handle(IxNodeHandle &node)
 {
     file_hdr_->num_pages_--;
+    released_pages_.push_back(node.get_page_no());
+}
+
+/**
+ * @brief 释放release_node_handle记录的页面，之后create_node可以复用这些页号
+ * 调用时不能再持有任何结点；仍被固定的页面（如IxScan停留的叶子）不能删除，留在released_pages_中，
+ * 在之后的删除或关闭索引时重试，这样页号不会从空闲页位图中丢失
+ */
+void IxIndexHandle::free_released_pages()
+{
+    std::vector<page_id_t> pinned_pages;
+    for (page_id_t page_no : released_pages_)
+    {
+        if (!buffer_pool_manager_->delete_page({.fd = fd_, .page_no = page_no}))
+        {
+            pinned_pages.push_back(page_no);
+        }
+    }
+    released_pages_.swap(pinned_pages);
 }
 
 /**
@@ -940,8 +930,7 @@ void IxIndexHandle::maintain_child(IxNodeHandle *node, int child_idx)
     {
         //  Current node is inner node, load its child and set its parent to current node
         int child_page_no = node->value_at(child_idx);
-        IxNodeHandle *child = fetch_node(child_page_no);
+        auto child = fetch_node_mut(child_page_no);
         child->set_parent_page_no(node->get_page_no());
-        buffer_pool_manager_->unpin_page(child->get_page_id(), true);
     }
 }
\ No newline at end of file
@@ -1,5 +1,9 @@
 #pragma once
 
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+
 #include "ix_defs.h"
 #include "transaction/transaction.h"
 
@@ -60,6 +64,7 @@ private:
     IxPageHdr *page_hdr;       // page->data的第一部分，指针指向首地址，长度为sizeof(IxPageHdr)
     char *keys;                // page->data的第二部分，指针指向首地址，长度为file_hdr->keys_size，每个key的长度为file_hdr->col_len
     Rid *rids;                 // page->data的第三部分，指针指向首地址
+    BasicPageGuard guard;      // 持有page的固定，结点析构时自动unpin
 
 public:
     IxNodeHandle() = default;
@@ -71,6 +76,14 @@ public:
         rids = reinterpret_cast<Rid *>(keys + file_hdr->keys_size_);
     }
 
+    IxNodeHandle(const IxFileHdr *file_hdr_, BasicPageGuard &&guard_) : IxNodeHandle(file_hdr_, guard_.get_page())
+    {
+        guard = std::move(guard_);
+    }
+
+    // 结点被修改过，释放时需要把页面标记为脏页
+    void mark_dirty() { guard.mark_dirty(); }
+
     int get_size() { return page_hdr->num_key; }
 
     void set_size(int size) { page_hdr->num_key = size; }
@@ -165,6 +178,37 @@ public:
     }
 };
 
+/**
+ * @description: 写优先的读写锁。glibc的std::shared_mutex偏向读者，查找持续不断时插入、删除会一直拿不到写锁；
+ *               写者先占住gate_，之后到来的读者在gate_上等待，已持有读锁的读者退出后写者即可进入
+ */
+class IxTreeLatch
+{
+    std::mutex gate_;
+    std::shared_mutex latch_;
+
+public:
+    void lock()
+    {
+        gate_.lock();
+        latch_.lock();
+    }
+
+    void unlock()
+    {
+        latch_.unlock();
+        gate_.unlock();
+    }
+
+    void lock_shared()
+    {
+        std::scoped_lock gate{gate_};
+        latch_.lock_shared();
+    }
+
+    void unlock_shared() { latch_.unlock_shared(); }
+};
+
 /* B+树 */
 class IxIndexHandle
 {
@@ -176,7 +220,10 @@ private:
     BufferPoolManager *buffer_pool_manager_;
     int fd_;              // 存储B+树的文件
     IxFileHdr *file_hdr_; // 存了root_page，但其初始化为2（第0页存FILE_HDR_PAGE，第1页存LEAF_HEADER_PAGE）
-    std::mutex root_latch_;
+    // 树级读写锁：插入、删除持有写锁，查找和扫描持有读锁
+    // 结构修改时同一页面可能被多次获取（如分裂后维护孩子的父指针），因此结点只持有页面固定，不再加页面锁
+    mutable IxTreeLatch root_latch_;
+    std::vector<page_id_t> released_pages_; // 本次删除中被合并掉、待释放的结点页号，受root_latch_保护
 
 public:
     IxIndexHandle(DiskManager *disk_manager, BufferPoolManager *buffer_pool_manager, int fd);
@@ -186,13 +233,13 @@ public:
     // for search
     bool get_value(const char *key, std::vector<Rid> *result, Transaction *transaction);
 
-    std::pair<IxNodeHandle *, bool> find_leaf_page(const char *key, Operation operation, Transaction *transaction,
-                                                   bool find_first = false);
+    std::pair<std::unique_ptr<IxNodeHandle>, bool> find_leaf_page(const char *key, Operation operation,
+                                                                   Transaction *transaction, bool find_first = false);
 
     // for insert
     page_id_t insert_entry(const char *key, const Rid &value, Transaction *transaction);
 
-    IxNodeHandle *split(IxNodeHandle *node);
+    std::unique_ptr<IxNodeHandle> split(IxNodeHandle *node);
 
     void insert_into_parent(IxNodeHandle *old_node, const char *key, IxNodeHandle *new_node, Transaction *transaction);
 
@@ -222,10 +269,14 @@ private:
 
     bool is_empty() const { return file_hdr_->root_page_ == IX_NO_PAGE; }
 
+    void check_writable() const;
+
     // for get/create node
-    IxNodeHandle *fetch_node(int page_no) const;
+    std::unique_ptr<IxNodeHandle> fetch_node(int page_no, AccessPattern pattern = AccessPattern::NORMAL) const;
 
-    IxNodeHandle *create_node();
+    std::unique_ptr<IxNodeHandle> fetch_node_mut(int page_no) const;
+
+    std::unique_ptr<IxNodeHandle> create_node();
 
     // for maintain data structure
     void maintain_parent(IxNodeHandle *node);
@@ -234,6 +285,8 @@ private:
 
     void release_node_handle(IxNodeHandle &node);
 
+    void free_released_pages();
+
     void maintain_child(IxNodeHandle *node, int child_idx);
 
     // for index test
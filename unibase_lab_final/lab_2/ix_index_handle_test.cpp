@@ -0,0 +1,226 @@
+#include <algorithm>
+#include <atomic>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "ix_manager.h"
+#include "ix_scan.h"
+
+/* B+树和页面守卫的并发测试：多个读者并发查找和扫描，同时有写者修改不相交的键 */
+class IxIndexHandleTest : public ::testing::Test {
+   protected:
+    static constexpr int NUM_KEYS = 20000;
+    static constexpr int POOL_SIZE = 256;  // 远小于索引的页面数，读者之间会互相换出结点
+
+    std::string table_ = "ix_index_handle_test";
+    std::vector<ColMeta> cols_ = {{table_, "id", TYPE_INT, sizeof(int), 0, true}};
+    DiskManager disk_manager_;
+    std::unique_ptr<BufferPoolManager> bpm_;
+    std::unique_ptr<IxManager> ix_manager_;
+    std::unique_ptr<IxIndexHandle> ih_;
+
+    void SetUp() override {
+        bpm_ = std::make_unique<BufferPoolManager>(POOL_SIZE, &disk_manager_);
+        ix_manager_ = std::make_unique<IxManager>(&disk_manager_, bpm_.get());
+        if (ix_manager_->exists(table_, cols_)) {
+            ix_manager_->destroy_index(table_, cols_);
+        }
+        ix_manager_->create_index(table_, cols_);
+        ih_ = ix_manager_->open_index(table_, cols_);
+        // 偶数键预先插入，奇数键留给写者
+        for (int key = 0; key < NUM_KEYS; key += 2) {
+            ih_->insert_entry(reinterpret_cast<const char *>(&key), rid_of(key), nullptr);
+        }
+    }
+
+    void TearDown() override {
+        ix_manager_->close_index(ih_.get());
+        ih_.reset();
+        ix_manager_->destroy_index(table_, cols_);
+    }
+
+    static Rid rid_of(int key) { return Rid{key / 100, key % 100}; }
+};
+
+/**
+ * 读者并发执行点查和范围扫描，结果与预先插入的键一致，结束后没有遗留的页面固定
+ */
+TEST_F(IxIndexHandleTest, ConcurrentReaders) {
+    constexpr int NUM_THREADS = 8;
+    std::atomic<int> errors{0};
+    std::vector<std::thread> threads;
+    for (int t = 0; t < NUM_THREADS; t++) {
+        threads.emplace_back([&, t] {
+            std::mt19937 rng(t);
+            for (int round = 0; round < 2000; round++) {
+                int key = rng() % NUM_KEYS;
+                std::vector<Rid> result;
+                bool found = ih_->get_value(reinterpret_cast<const char *>(&key), &result, nullptr);
+                if (found != (key % 2 == 0) || (found && !(result.size() == 1 && result[0] == rid_of(key)))) {
+                    errors++;
+                }
+                if (round % 500 != 0) {
+                    continue;
+                }
+                // 沿叶子链扫描全部键，键按顺序出现且不重复不遗漏
+                IxScan scan(ih_.get(), ih_->leaf_begin(), ih_->leaf_end(), bpm_.get());
+                int expected = 0;
+                for (; !scan.is_end(); scan.next()) {
+                    if (scan.rid() != rid_of(expected)) {
+                        errors++;
+                    }
+                    expected += 2;
+                }
+                if (expected != NUM_KEYS) {
+                    errors++;
+                }
+            }
+        });
+    }
+    for (auto &thread : threads) {
+        thread.join();
+    }
+    EXPECT_EQ(errors, 0);
+    EXPECT_EQ(bpm_->get_stats().pinned_frames, 0u);
+}
+
+/**
+ * 写者插入奇数键，引起叶结点和内部结点的分裂；读者并发查找的偶数键始终能找到，结束后所有键都在树中
+ */
+TEST_F(IxIndexHandleTest, ReadersWithConcurrentWriter) {
+    constexpr int NUM_READERS = 6;
+    std::atomic<bool> stop{false};
+    std::atomic<int> errors{0};
+    std::vector<std::thread> threads;
+    for (int t = 0; t < NUM_READERS; t++) {
+        threads.emplace_back([&, t] {
+            std::mt19937 rng(t);
+            while (!stop) {
+                int key = rng() % (NUM_KEYS / 2) * 2;
+                std::vector<Rid> result;
+                if (!ih_->get_value(reinterpret_cast<const char *>(&key), &result, nullptr) ||
+                    result.size() != 1 || result[0] != rid_of(key)) {
+                    errors++;
+                }
+            }
+        });
+    }
+    for (int key = 1; key < NUM_KEYS; key += 2) {
+        ih_->insert_entry(reinterpret_cast<const char *>(&key), rid_of(key), nullptr);
+    }
+    stop = true;
+    for (auto &thread : threads) {
+        thread.join();
+    }
+    EXPECT_EQ(errors, 0);
+
+    for (int key = 0; key < NUM_KEYS; key++) {
+        std::vector<Rid> result;
+        ASSERT_TRUE(ih_->get_value(reinterpret_cast<const char *>(&key), &result, nullptr)) << key;
+        EXPECT_EQ(result[0], rid_of(key));
+    }
+    EXPECT_EQ(bpm_->get_stats().pinned_frames, 0u);
+}
+
+/**
+ * 乱序删除大部分键，引起叶结点和内部结点的重分配与合并、根结点下降；再插回删除的键，
+ * 新结点复用被合并掉的结点释放的页号，树的内容和叶子链表都保持正确，文件不因此增长
+ */
+TEST_F(IxIndexHandleTest, DeleteAndReinsert) {
+    int fd = disk_manager_.get_file_fd(ix_manager_->get_index_name(table_, cols_));
+    page_id_t num_file_pages = disk_manager_.get_fd2pageno(fd);
+
+    // 只保留16的倍数
+    std::vector<int> deleted;
+    for (int key = 0; key < NUM_KEYS; key += 2) {
+        if (key % 16 != 0) {
+            deleted.push_back(key);
+        }
+    }
+    std::shuffle(deleted.begin(), deleted.end(), std::mt19937(1));
+    for (int key : deleted) {
+        ASSERT_TRUE(ih_->delete_entry(reinterpret_cast<const char *>(&key), nullptr)) << key;
+    }
+    EXPECT_GT(disk_manager_.get_num_free_pages(fd), 0);
+
+    // 剩下的键都能找到且按顺序出现在叶子链表中，被删除的键都找不到
+    auto check = [&](int step) {
+        for (int key = 0; key < NUM_KEYS; key += 2) {
+            std::vector<Rid> result;
+            bool found = ih_->get_value(reinterpret_cast<const char *>(&key), &result, nullptr);
+            ASSERT_EQ(found, key % step == 0) << key;
+            if (found) {
+                EXPECT_EQ(result[0], rid_of(key));
+            }
+        }
+        IxScan scan(ih_.get(), ih_->leaf_begin(), ih_->leaf_end(), bpm_.get());
+        int expected = 0;
+        for (; !scan.is_end(); scan.next()) {
+            ASSERT_EQ(scan.rid(), rid_of(expected));
+            expected += step;
+        }
+        EXPECT_EQ(expected, NUM_KEYS);
+    };
+    check(16);
+
+    for (int key : deleted) {
+        ih_->insert_entry(reinterpret_cast<const char *>(&key), rid_of(key), nullptr);
+    }
+    check(2);
+    EXPECT_LE(disk_manager_.get_fd2pageno(fd), num_file_pages);
+    EXPECT_EQ(bpm_->get_stats().pinned_frames, 0u);
+}
+
+/**
+ * 只读打开的索引直接读文件映射：并发查找和扫描结果正确，结点页面不进入缓冲池，修改索引抛出异常
+ */
+TEST_F(IxIndexHandleTest, ReadOnlyOpen) {
+    ix_manager_->close_index(ih_.get());
+    ih_ = ix_manager_->open_index(table_, cols_, true);
+    BufferPoolStats before = bpm_->get_stats();
+
+    constexpr int NUM_THREADS = 4;
+    std::atomic<int> errors{0};
+    std::vector<std::thread> threads;
+    for (int t = 0; t < NUM_THREADS; t++) {
+        threads.emplace_back([&, t] {
+            std::mt19937 rng(t);
+            for (int round = 0; round < 2000; round++) {
+                int key = rng() % NUM_KEYS;
+                std::vector<Rid> result;
+                bool found = ih_->get_value(reinterpret_cast<const char *>(&key), &result, nullptr);
+                if (found != (key % 2 == 0) || (found && !(result.size() == 1 && result[0] == rid_of(key)))) {
+                    errors++;
+                }
+            }
+            IxScan scan(ih_.get(), ih_->leaf_begin(), ih_->leaf_end(), bpm_.get());
+            int expected = 0;
+            for (; !scan.is_end(); scan.next()) {
+                if (scan.rid() != rid_of(expected)) {
+                    errors++;
+                }
+                expected += 2;
+            }
+            if (expected != NUM_KEYS) {
+                errors++;
+            }
+        });
+    }
+    for (auto &thread : threads) {
+        thread.join();
+    }
+    EXPECT_EQ(errors, 0);
+
+    BufferPoolStats after = bpm_->get_stats();
+    EXPECT_EQ(after.hits + after.misses, before.hits + before.misses);
+    EXPECT_EQ(after.pinned_frames, 0u);
+
+    int key = 1;
+    EXPECT_ANY_THROW(ih_->insert_entry(reinterpret_cast<const char *>(&key), rid_of(key), nullptr));
+    key = 0;
+    EXPECT_ANY_THROW(ih_->delete_entry(reinterpret_cast<const char *>(&key), nullptr));
+    std::vector<Rid> result;
+    EXPECT_TRUE(ih_->get_value(reinterpret_cast<const char *>(&key), &result, nullptr));
+}
@@ -134,19 +134,32 @@ class IxManager {
     }
 
     // 注意这里打开文件，创建并返回了index file handle的指针
-    std::unique_ptr<IxIndexHandle> open_index(const std::string &filename, const std::vector<ColMeta>& index_cols) {
+    // read_only为true时文件以只读方式映射，结点页面不复制进缓冲池，插入和删除会抛出异常
+    std::unique_ptr<IxIndexHandle> open_index(const std::string &filename, const std::vector<ColMeta>& index_cols,
+                                              bool read_only = false) {
         std::string ix_name = get_index_name(filename, index_cols);
-        int fd = disk_manager_->open_file(ix_name);
+        int fd = disk_manager_->open_file(ix_name, read_only);
         return std::make_unique<IxIndexHandle>(disk_manager_, buffer_pool_manager_, fd);
     }
 
-    std::unique_ptr<IxIndexHandle> open_index(const std::string &filename, const std::vector<std::string>& index_cols) {
+    std::unique_ptr<IxIndexHandle> open_index(const std::string &filename, const std::vector<std::string>& index_cols,
+                                              bool read_only = false) {
         std::string ix_name = get_index_name(filename, index_cols);
-        int fd = disk_manager_->open_file(ix_name);
+        int fd = disk_manager_->open_file(ix_name, read_only);
         return std::make_unique<IxIndexHandle>(disk_manager_, buffer_pool_manager_, fd);
     }
 
-    void close_index(const IxIndexHandle *ih) {
+    void close_index(IxIndexHandle *ih) {
+        if (disk_manager_->is_mapped(ih->fd_)) {  // 只读打开的索引没有修改，不写回文件头
+            disk_manager_->close_file(ih->fd_);
+            return;
+        }
+        // 先释放删除时因仍被固定而没能释放的结点页面，使它们记入空闲页位图
+        ih->free_released_pages();
+        // 截掉文件末尾的空闲页，其余空闲页随文件头持久化，下次打开后继续复用
+        disk_manager_->truncate_free_pages(ih->fd_);
+        ih->file_hdr_->set_free_page_map(disk_manager_->get_fd2pageno(ih->fd_),
+                                         disk_manager_->get_free_page_map(ih->fd_));
         char* data = new char[ih->file_hdr_->tot_len_];
         ih->file_hdr_->serialize(data);
         disk_manager_->write_page(ih->fd_, IX_FILE_HDR_PAGE, data, ih->file_hdr_->tot_len_);
@@ -1,23 +1,69 @@
 #include "ix_scan.h"
 
+IxScan::IxScan(const IxIndexHandle *ih, const Iid &lower, const Iid &upper, BufferPoolManager *bpm)
+    : ih_(ih), iid_(lower), end_(upper), bpm_(bpm) {
+    if (!is_end()) {
+        std::shared_lock lock{ih_->root_latch_};
+        node_ = ih_->fetch_node(iid_.page_no, AccessPattern::SEQUENTIAL);
+    }
+}
+
 /**
- * @brief 
- * @todo 加上读锁（需要使用缓冲池得到page）
+ * @brief 持有B+树的读锁移动到下一个位置，只在跨到下一个叶子时访问缓冲池
  */
 void IxScan::next() {
     assert(!is_end());
-    IxNodeHandle *node = ih_->fetch_node(iid_.page_no);
-    assert(node->is_leaf_page());
-    assert(iid_.slot_no < node->get_size());
+    std::shared_lock lock{ih_->root_latch_};
+    assert(node_->is_leaf_page());
+    assert(iid_.slot_no < node_->get_size());
     // increment slot no
     iid_.slot_no++;
-    if (iid_.page_no != ih_->file_hdr_->last_leaf_ && iid_.slot_no == node->get_size()) {
-        // go to next leaf
+    if (iid_.page_no != ih_->file_hdr_->last_leaf_ && iid_.slot_no == node_->get_size()) {
+        // go to next leaf，原来的叶子在此处unpin
         iid_.slot_no = 0;
-        iid_.page_no = node->get_next_leaf();
+        iid_.page_no = node_->get_next_leaf();
+        if (is_end()) {
+            node_.reset();
+            return;
+        }
+        node_ = ih_->fetch_node(iid_.page_no, AccessPattern::SEQUENTIAL);
+        prefetch_leaves();
+    }
+}
+
+/**
+ * @brief 进入一个新叶子后调用：沿next_leaf推进预读前沿，每次最多推进两个叶子，直到领先IX_PREFETCH_LEAVES个叶子
+ * 读取前沿叶子的next_leaf需要访问该叶子，它此前已被预读，通常已在缓冲池中
+ */
+void IxScan::prefetch_leaves() {
+    if (prefetched_leaves_ > 0) {
+        prefetched_leaves_--;  // 刚进入的叶子是之前预读的
+    } else {
+        prefetch_frontier_ = iid_.page_no;
+    }
+    for (int step = 0; step < 2 && prefetched_leaves_ < IX_PREFETCH_LEAVES; step++) {
+        if (prefetch_frontier_ == ih_->file_hdr_->last_leaf_ || prefetch_frontier_ == end_.page_no) {
+            return;
+        }
+        page_id_t next_leaf = prefetch_frontier_ == iid_.page_no
+                                  ? node_->get_next_leaf()
+                                  : ih_->fetch_node(prefetch_frontier_, AccessPattern::SEQUENTIAL)->get_next_leaf();
+        if (next_leaf == IX_LEAF_HEADER_PAGE) {
+            return;
+        }
+        bpm_->prefetch(ih_->fd_, next_leaf, 1);
+        prefetch_frontier_ = next_leaf;
+        prefetched_leaves_++;
     }
 }
 
 Rid IxScan::rid() const {
-    return ih_->get_rid(iid_);
+    if (node_ == nullptr) {
+        return ih_->get_rid(iid_);
+    }
+    std::shared_lock lock{ih_->root_latch_};
+    if (iid_.slot_no >= node_->get_size()) {
+        throw IndexEntryNotFoundError();
+    }
+    return *node_->get_rid(iid_.slot_no);
 }
\ No newline at end of file
@@ -5,18 +5,23 @@
 
 // class IxIndexHandle;
 
+// 扫描跨过叶子后沿next_leaf预读，预读前沿最多领先当前叶子IX_PREFETCH_LEAVES个叶子
+constexpr int IX_PREFETCH_LEAVES = 8;
+
 // 用于遍历叶子结点
 // 用于直接遍历叶子结点，而不用findleafpage来得到叶子结点
-// TODO：对page遍历时，要加上读锁
+// 每次next/rid持有B+树的读锁
 class IxScan : public RecScan {
     const IxIndexHandle *ih_;
     Iid iid_;  // 初始为lower（用于遍历的指针）
     Iid end_;  // 初始为upper
     BufferPoolManager *bpm_;
+    std::unique_ptr<IxNodeHandle> node_;  // iid_所在的叶子，在两次next之间保持固定，进入下一个叶子时才释放
+    page_id_t prefetch_frontier_ = IX_NO_PAGE;  // 已发起预读的最后一个叶子
+    int prefetched_leaves_ = 0;                 // 当前叶子之后已发起预读的叶子数
 
    public:
-    IxScan(const IxIndexHandle *ih, const Iid &lower, const Iid &upper, BufferPoolManager *bpm)
-        : ih_(ih), iid_(lower), end_(upper), bpm_(bpm) {}
+    IxScan(const IxIndexHandle *ih, const Iid &lower, const Iid &upper, BufferPoolManager *bpm);
 
     void next() override;
 
@@ -25,4 +30,7 @@ class IxScan : public RecScan {
     Rid rid() const override;
 
     const Iid &iid() const { return iid_; }
+
+   private:
+    void prefetch_leaves();
 };
\ No newline at end of file
@@ -0,0 +1,64 @@
+#include <vector>
+
+#include "bench_util.h"
+#include "record/rm_file_handle.h"
+#include "record/rm_scan.h"
+#include "storage/buffer_pool_manager.h"
+
+/* 只读映射与复制到帧两种方式下RmScan的吞吐和内存占用
+ * copy：以读写方式打开，页面从内核复制到缓冲池的帧中；mmap：以只读方式打开，fetch_page返回指向映射区的页面视图
+ * cold为扫描前丢弃该文件的页缓存，warm为紧接着再扫描一遍；
+ * RSS增量包含帧内存和映射区中被访问过的页面，frames为扫描后缓冲池中被占用的帧数 */
+
+static constexpr int RECORD_SIZE = 64;
+static constexpr int NUM_RECORDS = 1000000;
+static constexpr int POOL_SIZE = 1024;
+
+static void load_table(DiskManager *disk_manager, const std::string &path) {
+    create_record_file(disk_manager, path, RECORD_SIZE);
+    int fd = disk_manager->open_file(path);
+    {
+        BufferPoolManager bpm(8192, disk_manager);
+        RmFileHandle file_handle(disk_manager, &bpm, fd);
+        std::vector<char> rows(static_cast<size_t>(RECORD_SIZE) * NUM_RECORDS, 'a');
+        file_handle.insert_records(rows.data(), NUM_RECORDS, nullptr);
+        bpm.flush_all_pages(fd);
+        RmFileHdr file_hdr = file_handle.get_file_hdr();
+        disk_manager->write_page(fd, RM_FILE_HDR_PAGE, reinterpret_cast<char *>(&file_hdr), sizeof(file_hdr));
+    }
+    disk_manager->close_file(fd);
+}
+
+int main() {
+    std::string path = "mmap_scan_bench.db";
+    DiskManager disk_manager;
+    load_table(&disk_manager, path);
+
+    printf("%d records of %d bytes, %d frames\n", NUM_RECORDS, RECORD_SIZE, POOL_SIZE);
+    printf("%-6s %-6s %7s %9s %10s %9s %8s %15s\n", "mode", "cache", "pages", "MB/s", "M rows/s", "RSS +MB", "frames",
+           "page cache MB");
+    for (bool mapped : {false, true}) {
+        int fd = disk_manager.open_file(path, mapped);
+        drop_page_cache(fd);
+        BufferPoolManager bpm(POOL_SIZE, &disk_manager);
+        RmFileHandle file_handle(&disk_manager, &bpm, fd);
+        int num_pages = file_handle.get_file_hdr().num_pages;
+        double rss_before = rss_mb();
+        for (bool warm : {false, true}) {
+            long rows = 0;
+            BenchTimer timer;
+            for (RmScan scan(&file_handle); !scan.is_end(); scan.next()) {
+                rows++;
+            }
+            double seconds = timer.seconds();
+            BufferPoolStats stats = bpm.get_stats();
+            printf("%-6s %-6s %7d %9.1f %10.2f %9.1f %8lu %15.1f\n", disk_manager.is_mapped(fd) ? "mmap" : "copy",
+                   warm ? "warm" : "cold", num_pages, static_cast<double>(num_pages) * PAGE_SIZE / seconds / (1024 * 1024),
+                   rows / seconds / 1e6, rss_mb() - rss_before,
+                   static_cast<unsigned long>(POOL_SIZE - stats.free_frames), page_cache_mb(path));
+        }
+        disk_manager.close_file(fd);
+    }
+    disk_manager.destroy_file(path);
+    return 0;
+}
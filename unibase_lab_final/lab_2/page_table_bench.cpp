@@ -0,0 +1,130 @@
+#include <algorithm>
+#include <random>
+#include <unordered_map>
+#include <vector>
+
+#include "bench_util.h"
+#include "storage/page_table.h"
+
+/* 缓冲池页表的插入、查找、删除耗时：开放寻址的PageTable与原来使用的unordered_map<PageId, frame_id_t, PageIdHash>
+ * 页表中有n个页面（n等于帧数），分布在4个文件中，页号在[0, 4n)中随机选取；查找按随机顺序进行，
+ * miss为查找不在页表中的页面；evict为删除一个页面再插入另一个页面，对应缓冲池淘汰一帧换入新页 */
+
+static constexpr int LOOKUP_ROUNDS = 4;  // 每个页面被查找的次数
+
+struct Result {
+    double insert_ns;
+    double find_ns;
+    double miss_ns;
+    double evict_ns;
+    double erase_ns;
+};
+
+static std::vector<PageId> make_keys(int n, std::mt19937 *rng) {
+    std::vector<PageId> keys;
+    keys.reserve(2 * n);
+    std::vector<char> used(static_cast<size_t>(4) * 4 * n, 0);
+    while (static_cast<int>(keys.size()) < 2 * n) {
+        int fd = 3 + static_cast<int>((*rng)() % 4);
+        page_id_t page_no = static_cast<page_id_t>((*rng)() % (4 * n));
+        char &flag = used[static_cast<size_t>(fd - 3) * 4 * n + page_no];
+        if (!flag) {
+            flag = 1;
+            keys.push_back(PageId{fd, page_no});
+        }
+    }
+    return keys;
+}
+
+/**
+ * @description: keys的前一半放入页表，后一半用于miss查找和evict时换入的新页面
+ */
+template <typename Table, typename Find, typename Insert, typename Erase>
+static Result run(Table &table, const std::vector<PageId> &keys, Find find, Insert insert, Erase erase) {
+    int n = static_cast<int>(keys.size() / 2);
+    std::mt19937 rng(7);
+    std::vector<int> order(n);
+    for (int i = 0; i < n; i++) {
+        order[i] = i;
+    }
+    std::shuffle(order.begin(), order.end(), rng);
+    Result result{};
+    long sink = 0;
+
+    BenchTimer timer;
+    for (int i = 0; i < n; i++) {
+        insert(table, keys[i], i);
+    }
+    result.insert_ns = timer.seconds() * 1e9 / n;
+
+    timer.reset();
+    for (int round = 0; round < LOOKUP_ROUNDS; round++) {
+        for (int i : order) {
+            sink += find(table, keys[i]);
+        }
+    }
+    result.find_ns = timer.seconds() * 1e9 / (static_cast<double>(n) * LOOKUP_ROUNDS);
+
+    timer.reset();
+    for (int i : order) {
+        sink += find(table, keys[n + i]);
+    }
+    result.miss_ns = timer.seconds() * 1e9 / n;
+
+    // 每个帧换入后一半中的一个页面，之后页表中仍有n个页面
+    timer.reset();
+    for (int i : order) {
+        erase(table, keys[i]);
+        insert(table, keys[n + i], i);
+    }
+    result.evict_ns = timer.seconds() * 1e9 / n;
+
+    timer.reset();
+    for (int i : order) {
+        erase(table, keys[n + i]);
+    }
+    result.erase_ns = timer.seconds() * 1e9 / n;
+
+    if (sink == -1) {
+        printf("unreachable\n");
+    }
+    return result;
+}
+
+int main() {
+    printf("ns per operation, n pages in a table sized for n frames\n");
+    printf("%8s  %-13s %7s %7s %7s %7s %7s\n", "n", "table", "insert", "find", "miss", "evict", "erase");
+    for (int n : {1 << 10, 1 << 14, 1 << 17, 1 << 20}) {
+        std::mt19937 rng(n);
+        std::vector<PageId> keys = make_keys(n, &rng);
+
+        PageTable page_table(n);
+        Result open_addressing = run(
+            page_table, keys,
+            [](PageTable &table, PageId page_id) {
+                frame_id_t frame_id = INVALID_FRAME_ID;
+                return table.find(page_id, &frame_id) ? frame_id : -1;
+            },
+            [](PageTable &table, PageId page_id, frame_id_t frame_id) { table.insert(page_id, frame_id); },
+            [](PageTable &table, PageId page_id) { table.erase(page_id); });
+
+        std::unordered_map<PageId, frame_id_t, PageIdHash> map;
+        Result unordered = run(
+            map, keys,
+            [](std::unordered_map<PageId, frame_id_t, PageIdHash> &table, PageId page_id) {
+                auto iter = table.find(page_id);
+                return iter != table.end() ? iter->second : -1;
+            },
+            [](std::unordered_map<PageId, frame_id_t, PageIdHash> &table, PageId page_id, frame_id_t frame_id) {
+                table[page_id] = frame_id;
+            },
+            [](std::unordered_map<PageId, frame_id_t, PageIdHash> &table, PageId page_id) { table.erase(page_id); });
+
+        for (auto [name, result] : {std::pair<const char *, Result>{"PageTable", open_addressing},
+                                    std::pair<const char *, Result>{"unordered_map", unordered}}) {
+            printf("%8d  %-13s %7.1f %7.1f %7.1f %7.1f %7.1f\n", n, name, result.insert_ns, result.find_ns,
+                   result.miss_ns, result.evict_ns, result.erase_ns);
+        }
+    }
+    return 0;
+}
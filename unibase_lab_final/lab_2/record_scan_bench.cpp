@@ -0,0 +1,75 @@
+#include <algorithm>
+#include <vector>
+
+#include "bench_util.h"
+#include "record/rm_file_handle.h"
+#include "record/rm_scan.h"
+#include "storage/buffer_pool_manager.h"
+
+/* 不同记录长度下全表扫描的吞吐，缓冲池能容纳整个文件，预热后所有页面都在缓冲池中，取5次中最快的一次
+ * per record：对照实现，按逐页扫描之前RmScan::next()的做法，每前进一条记录都固定并加读锁一次当前页，再在bitmap中找下一个记录
+ * RmScan：每页只固定一次，用scan_page取出该页所有记录的slot号后释放页面 */
+
+static constexpr int NUM_RECORDS = 1000000;
+static constexpr int ROUNDS = 5;
+
+static long scan_per_record(RmFileHandle *file_handle) {
+    RmFileHdr file_hdr = file_handle->get_file_hdr();
+    long rows = 0;
+    for (int page_no = RM_FIRST_RECORD_PAGE; page_no < file_hdr.num_pages; page_no++) {
+        int slot_no = -1;
+        while (true) {
+            ReadPageGuard guard = file_handle->fetch_page_read(page_no);
+            RmPageHandle page_handle(&file_hdr, guard.get_page());
+            slot_no = Bitmap::next_bit(true, page_handle.bitmap, file_hdr.num_records_per_page, slot_no);
+            if (slot_no == file_hdr.num_records_per_page) {
+                break;
+            }
+            rows++;
+        }
+    }
+    return rows;
+}
+
+static long scan_rm_scan(RmFileHandle *file_handle) {
+    long rows = 0;
+    for (RmScan scan(file_handle); !scan.is_end(); scan.next()) {
+        rows++;
+    }
+    return rows;
+}
+
+int main() {
+    printf("%d records, all pages resident, best of %d, M records/s\n", NUM_RECORDS, ROUNDS);
+    printf("%-12s %8s %12s %10s\n", "record size", "pages", "per record", "RmScan");
+    for (int record_size : {16, 64, 256}) {
+        std::string path = "record_scan_bench.db";
+        DiskManager disk_manager;
+        RmFileHdr file_hdr = create_record_file(&disk_manager, path, record_size);
+        int fd = disk_manager.open_file(path);
+        {
+            int num_pages = NUM_RECORDS / file_hdr.num_records_per_page + 2;
+            BufferPoolManager bpm(num_pages + 64, &disk_manager);
+            RmFileHandle file_handle(&disk_manager, &bpm, fd);
+            std::vector<char> rows(static_cast<size_t>(record_size) * NUM_RECORDS, 'a');
+            file_handle.insert_records(rows.data(), NUM_RECORDS, nullptr);
+
+            double best[2] = {1e9, 1e9};
+            for (int round = 0; round < ROUNDS; round++) {
+                for (int i = 0; i < 2; i++) {
+                    BenchTimer timer;
+                    long count = i == 0 ? scan_per_record(&file_handle) : scan_rm_scan(&file_handle);
+                    best[i] = std::min(best[i], timer.seconds());
+                    if (count != NUM_RECORDS) {
+                        printf("scan returned %ld records\n", count);
+                    }
+                }
+            }
+            printf("%-12d %8d %12.1f %10.1f\n", record_size, file_handle.get_file_hdr().num_pages,
+                   NUM_RECORDS / best[0] / 1e6, NUM_RECORDS / best[1] / 1e6);
+        }
+        disk_manager.close_file(fd);
+        disk_manager.destroy_file(path);
+    }
+    return 0;
+}
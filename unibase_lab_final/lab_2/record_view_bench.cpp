@@ -0,0 +1,93 @@
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include <vector>
+
+#include "bench_util.h"
+#include "record/rm_file_handle.h"
+#include "record/rm_scan.h"
+#include "storage/buffer_pool_manager.h"
+
+/* 在记录视图上判断扫描条件的效果：扫描1M条64字节记录，条件选中1%的记录，选中的记录物化为RmRecord
+ * get_record：对照实现，按使用视图之前的做法每条记录都复制为RmRecord再判断条件
+ * view：用get_record_view直接在缓冲池帧中判断条件
+ * 替换全局operator new统计每行的堆分配次数；缓冲池能容纳整个文件，取5次中最快的一次 */
+
+static constexpr int RECORD_SIZE = 64;
+static constexpr int NUM_RECORDS = 1000000;
+static constexpr int ROUNDS = 5;
+
+static std::atomic<long> num_allocations{0};
+
+void *operator new(size_t size) {
+    num_allocations.fetch_add(1, std::memory_order_relaxed);
+    void *ptr = std::malloc(size == 0 ? 1 : size);
+    if (ptr == nullptr) {
+        throw std::bad_alloc();
+    }
+    return ptr;
+}
+
+void *operator new[](size_t size) { return operator new(size); }
+
+void operator delete(void *ptr) noexcept { std::free(ptr); }
+
+void operator delete[](void *ptr) noexcept { std::free(ptr); }
+
+void operator delete(void *ptr, size_t) noexcept { std::free(ptr); }
+
+void operator delete[](void *ptr, size_t) noexcept { std::free(ptr); }
+
+static bool qualifies(const char *data) {
+    int value;
+    memcpy(&value, data, sizeof(value));
+    return value % 100 == 0;
+}
+
+int main() {
+    std::string path = "record_view_bench.db";
+    DiskManager disk_manager;
+    RmFileHdr file_hdr = create_record_file(&disk_manager, path, RECORD_SIZE);
+    int fd = disk_manager.open_file(path);
+    {
+        BufferPoolManager bpm(NUM_RECORDS / file_hdr.num_records_per_page + 64, &disk_manager);
+        RmFileHandle file_handle(&disk_manager, &bpm, fd);
+        std::vector<char> rows(static_cast<size_t>(RECORD_SIZE) * NUM_RECORDS, 'a');
+        for (int i = 0; i < NUM_RECORDS; i++) {
+            memcpy(rows.data() + static_cast<size_t>(i) * RECORD_SIZE, &i, sizeof(i));
+        }
+        file_handle.insert_records(rows.data(), NUM_RECORDS, nullptr);
+
+        printf("%d records of %d bytes, 1%% selectivity, best of %d\n", NUM_RECORDS, RECORD_SIZE, ROUNDS);
+        printf("%-11s %8s %12s %10s\n", "method", "matches", "allocs/row", "M rows/s");
+        for (bool use_view : {false, true}) {
+            double best = 1e9;
+            long matches = 0;
+            long allocations = 0;
+            for (int round = 0; round < ROUNDS; round++) {
+                long allocations_before = num_allocations.load();
+                matches = 0;
+                BenchTimer timer;
+                for (RmScan scan(&file_handle); !scan.is_end(); scan.next()) {
+                    bool match;
+                    if (use_view) {
+                        match = qualifies(file_handle.get_record_view(scan.rid(), AccessPattern::SEQUENTIAL).data());
+                    } else {
+                        match = qualifies(file_handle.get_record(scan.rid(), nullptr)->data);
+                    }
+                    if (match) {
+                        matches += file_handle.get_record(scan.rid(), nullptr)->size > 0;
+                    }
+                }
+                best = std::min(best, timer.seconds());
+                allocations = num_allocations.load() - allocations_before;
+            }
+            printf("%-11s %8ld %12.2f %10.1f\n", use_view ? "view" : "get_record", matches,
+                   static_cast<double>(allocations) / NUM_RECORDS, NUM_RECORDS / best / 1e6);
+        }
+    }
+    disk_manager.close_file(fd);
+    disk_manager.destroy_file(path);
+    return 0;
+}
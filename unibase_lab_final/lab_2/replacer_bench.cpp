@@ -0,0 +1,153 @@
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "bench_util.h"
+#include "storage/buffer_pool_manager.h"
+
+/* 三种置换策略在不同访问序列下的命中率和每次访问的耗时
+ * 第一张表只驱动Replacer（内存中模拟页表，不读盘），衡量策略本身的开销；第二张表经过BufferPoolManager的fetch/unpin
+ * uniform：均匀随机；zipfian：theta = 0.99的zipf分布，热点页面打散在文件中；
+ * scan：70%的访问是对整个文件的循环顺序扫描，30%是zipf分布的点查 */
+
+static constexpr int NUM_PAGES = 8192;
+static constexpr int POOL_SIZE = 1024;
+static constexpr int TRACE_LENGTH = 500000;
+
+// 按zipf分布生成页号：第i热的页面被访问的概率与1 / (i + 1)^theta成正比
+class ZipfGenerator {
+   public:
+    ZipfGenerator(int n, double theta, std::mt19937 *rng) : cdf_(n), pages_(n), rng_(rng) {
+        double sum = 0;
+        for (int i = 0; i < n; i++) {
+            sum += 1.0 / std::pow(i + 1, theta);
+            cdf_[i] = sum;
+        }
+        for (int i = 0; i < n; i++) {
+            cdf_[i] /= sum;
+            pages_[i] = i;
+        }
+        std::shuffle(pages_.begin(), pages_.end(), *rng_);
+    }
+
+    page_id_t next() {
+        double u = std::uniform_real_distribution<double>(0, 1)(*rng_);
+        size_t rank = std::lower_bound(cdf_.begin(), cdf_.end(), u) - cdf_.begin();
+        return pages_[std::min(rank, pages_.size() - 1)];
+    }
+
+   private:
+    std::vector<double> cdf_;
+    std::vector<page_id_t> pages_;
+    std::mt19937 *rng_;
+};
+
+static std::vector<page_id_t> make_trace(const std::string &name) {
+    std::mt19937 rng(42);
+    ZipfGenerator zipf(NUM_PAGES, 0.99, &rng);
+    std::vector<page_id_t> trace;
+    trace.reserve(TRACE_LENGTH);
+    page_id_t cursor = 0;
+    for (int i = 0; i < TRACE_LENGTH; i++) {
+        if (name == "uniform") {
+            trace.push_back(rng() % NUM_PAGES);
+        } else if (name == "zipfian" || rng() % 10 < 3) {
+            trace.push_back(zipf.next());
+        } else {
+            trace.push_back(cursor);
+            cursor = (cursor + 1) % NUM_PAGES;
+        }
+    }
+    return trace;
+}
+
+/**
+ * @description: 不经过缓冲池，直接用replacer模拟一个POOL_SIZE帧的缓存执行trace
+ * @return {pair<double, double>} 命中率和每次访问的纳秒数
+ */
+static std::pair<double, double> simulate(Replacer *replacer, const std::vector<page_id_t> &trace) {
+    std::vector<frame_id_t> page_to_frame(NUM_PAGES, -1);
+    std::vector<page_id_t> frame_to_page(POOL_SIZE, INVALID_PAGE_ID);
+    frame_id_t next_free = 0;
+    long hits = 0;
+    BenchTimer timer;
+    for (page_id_t page_no : trace) {
+        frame_id_t frame_id = page_to_frame[page_no];
+        if (frame_id != -1) {
+            hits++;
+        } else {
+            if (next_free < POOL_SIZE) {
+                frame_id = next_free++;
+            } else {
+                replacer->victim(&frame_id);
+                page_to_frame[frame_to_page[frame_id]] = -1;
+            }
+            page_to_frame[page_no] = frame_id;
+            frame_to_page[frame_id] = page_no;
+        }
+        replacer->pin(frame_id);
+        replacer->unpin(frame_id);
+    }
+    double seconds = timer.seconds();
+    return {static_cast<double>(hits) / trace.size(), seconds * 1e9 / trace.size()};
+}
+
+int main() {
+    std::string path = "replacer_bench.db";
+    DiskManager disk_manager;
+    create_bench_file(&disk_manager, path, NUM_PAGES);
+    int fd = disk_manager.open_file(path);
+
+    printf("%d pages, %d frames, %d accesses per trace\n", NUM_PAGES, POOL_SIZE, TRACE_LENGTH);
+    const char *traces[] = {"uniform", "zipfian", "scan"};
+    const std::pair<ReplacerType, const char *> replacers[] = {
+        {ReplacerType::LRU, "LRU"}, {ReplacerType::CLOCK, "CLOCK"}, {ReplacerType::LRU_K, "LRU-K"}};
+
+    printf("\nreplacer only\ntrace     replacer   hit ratio   ns/op\n");
+    for (const char *name : traces) {
+        std::vector<page_id_t> trace = make_trace(name);
+        for (auto [type, replacer_name] : replacers) {
+            std::unique_ptr<Replacer> replacer;
+            if (type == ReplacerType::LRU) {
+                replacer = std::make_unique<LRUReplacer>(POOL_SIZE);
+            } else if (type == ReplacerType::CLOCK) {
+                replacer = std::make_unique<ClockReplacer>(POOL_SIZE);
+            } else {
+                replacer = std::make_unique<LRUKReplacer>(POOL_SIZE);
+            }
+            auto [hit_ratio, ns] = simulate(replacer.get(), trace);
+            printf("%-9s %-9s %10.3f %7.1f\n", name, replacer_name, hit_ratio, ns);
+        }
+    }
+
+    printf("\nthrough BufferPoolManager (misses read from the page cache)\ntrace     replacer   hit ratio   ns/op\n");
+    for (const char *name : traces) {
+        std::vector<page_id_t> trace = make_trace(name);
+        for (auto [type, replacer_name] : replacers) {
+            BufferPoolManager bpm(POOL_SIZE, &disk_manager, 1, type);
+            // 先完整执行一遍使缓冲池达到稳定状态，第二遍计时和统计命中
+            for (page_id_t page_no : trace) {
+                bpm.fetch_page({fd, page_no});
+                bpm.unpin_page({fd, page_no}, false);
+            }
+            BufferPoolStats before = bpm.get_stats();
+            BenchTimer timer;
+            for (page_id_t page_no : trace) {
+                bpm.fetch_page({fd, page_no});
+                bpm.unpin_page({fd, page_no}, false);
+            }
+            double seconds = timer.seconds();
+            BufferPoolStats after = bpm.get_stats();
+            double hits = static_cast<double>(after.hits - before.hits);
+            double misses = static_cast<double>(after.misses - before.misses);
+            printf("%-9s %-9s %10.3f %7.0f\n", name, replacer_name, hits / (hits + misses),
+                   seconds * 1e9 / TRACE_LENGTH);
+        }
+    }
+
+    disk_manager.close_file(fd);
+    disk_manager.destroy_file(path);
+    return 0;
+}
@@ -0,0 +1,155 @@
+#include <algorithm>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "bench_util.h"
+#include "record/rm_file_handle.h"
+#include "record/rm_scan.h"
+#include "record/rm_slotted_file_handle.h"
+#include "record/rm_slotted_scan.h"
+#include "storage/buffer_pool_manager.h"
+
+/* 定长CHAR(n)布局与槽页布局的空间占用和扫描代价
+ * 表customer(id INT, name CHAR(32), email CHAR(64), city CHAR(32), comment CHAR(200))，字符串长度按实际数据的分布随机生成；
+ * CHAR(n)布局每个字段都补齐到定义的长度，槽页布局只存实际长度
+ * 扫描前丢弃文件的页缓存，缓冲池256帧，扫描时读取email字段的第一个字节 */
+
+static constexpr int NUM_ROWS = 1000000;
+static constexpr int NUM_FIELDS = 4;
+static constexpr int FIELD_LENS[NUM_FIELDS] = {32, 64, 32, 200};
+static constexpr int FIXED_LEN = sizeof(int);
+static constexpr int CHAR_ROW_SIZE = FIXED_LEN + 32 + 64 + 32 + 200;
+static constexpr int POOL_SIZE = 256;
+
+using Row = std::vector<std::string>;
+
+static std::vector<Row> make_rows() {
+    std::mt19937 rng(7);
+    auto uniform = [&](int lo, int hi) { return lo + static_cast<int>(rng() % (hi - lo + 1)); };
+    std::exponential_distribution<double> comment_len(1.0 / 40);
+    std::vector<Row> rows(NUM_ROWS);
+    for (Row &row : rows) {
+        int lens[NUM_FIELDS] = {uniform(6, 24), uniform(12, 36), uniform(4, 16),
+                                std::min(FIELD_LENS[3], static_cast<int>(comment_len(rng)))};
+        for (int i = 0; i < NUM_FIELDS; i++) {
+            row.emplace_back(lens[i], static_cast<char>('a' + i));
+        }
+    }
+    return rows;
+}
+
+struct ScanResult {
+    long rows;
+    double mb_read;
+    uint64_t reads;
+    double ms;
+};
+
+template <typename Scan>
+static ScanResult run_scan(DiskManager *disk_manager, int fd, Scan scan) {
+    drop_page_cache(fd);
+    BufferPoolManager bpm(POOL_SIZE, disk_manager);
+    DiskStats before = disk_manager->get_stats();
+    BenchTimer timer;
+    long rows = scan(&bpm);
+    double ms = timer.seconds() * 1e3;
+    DiskStats after = disk_manager->get_stats();
+    return {rows, static_cast<double>(after.bytes_read - before.bytes_read) / (1024 * 1024),
+            after.num_reads - before.num_reads, ms};
+}
+
+int main() {
+    std::vector<Row> rows = make_rows();
+    long payload = 0;
+    for (const Row &row : rows) {
+        for (const std::string &field : row) {
+            payload += static_cast<long>(field.size());
+        }
+    }
+    printf("%d rows, %.1f string bytes per row on average, CHAR(n) pads them to %d\n", NUM_ROWS,
+           static_cast<double>(payload) / NUM_ROWS, CHAR_ROW_SIZE - FIXED_LEN);
+
+    std::string char_path = "slotted_layout_bench_char.db";
+    std::string slotted_path = "slotted_layout_bench_slotted.db";
+    DiskManager disk_manager;
+    create_record_file(&disk_manager, char_path, CHAR_ROW_SIZE);
+    if (disk_manager.is_file(slotted_path)) {
+        disk_manager.destroy_file(slotted_path);
+    }
+    RmSlottedFileHandle::create_file(&disk_manager, slotted_path);
+    int char_fd = disk_manager.open_file(char_path);
+    int slotted_fd = disk_manager.open_file(slotted_path);
+
+    int char_pages;
+    int slotted_pages;
+    {
+        BufferPoolManager bpm(1024, &disk_manager);
+        RmFileHandle char_file(&disk_manager, &bpm, char_fd);
+        RmSlottedFileHandle slotted_file(&disk_manager, &bpm, slotted_fd);
+        char buf[PAGE_SIZE];
+        for (int i = 0; i < NUM_ROWS; i++) {
+            memset(buf, 0, CHAR_ROW_SIZE);
+            memcpy(buf, &i, sizeof(i));
+            int offset = FIXED_LEN;
+            for (int f = 0; f < NUM_FIELDS; f++) {
+                memcpy(buf + offset, rows[i][f].data(), rows[i][f].size());
+                offset += FIELD_LENS[f];
+            }
+            char_file.insert_record(buf, nullptr);
+        }
+        for (int i = 0; i < NUM_ROWS; i++) {
+            std::vector<std::string_view> fields(rows[i].begin(), rows[i].end());
+            int size = RmVarLenRecord::encode(reinterpret_cast<const char *>(&i), FIXED_LEN, fields, buf);
+            slotted_file.insert_record(buf, size, nullptr);
+        }
+        bpm.flush_all_pages(char_fd);
+        bpm.flush_all_pages(slotted_fd);
+        slotted_file.flush_file_hdr();
+        RmFileHdr file_hdr = char_file.get_file_hdr();
+        disk_manager.write_page(char_fd, RM_FILE_HDR_PAGE, reinterpret_cast<char *>(&file_hdr), sizeof(file_hdr));
+        char_pages = file_hdr.num_pages;
+        slotted_pages = slotted_file.get_file_hdr().num_pages;
+    }
+
+    long checksum = 0;
+    ScanResult char_scan = run_scan(&disk_manager, char_fd, [&](BufferPoolManager *bpm) {
+        RmFileHandle file_handle(&disk_manager, bpm, char_fd);
+        long count = 0;
+        for (RmScan scan(&file_handle); !scan.is_end(); scan.next()) {
+            RmRecordView view = file_handle.get_record_view(scan.rid(), AccessPattern::SEQUENTIAL);
+            checksum += view.data()[FIXED_LEN + FIELD_LENS[0]];
+            count++;
+        }
+        return count;
+    });
+    ScanResult slotted_scan = run_scan(&disk_manager, slotted_fd, [&](BufferPoolManager *bpm) {
+        RmSlottedFileHandle file_handle(&disk_manager, bpm, slotted_fd);
+        long count = 0;
+        for (RmSlottedScan scan(&file_handle); !scan.is_end(); scan.next()) {
+            RmRecordView view = file_handle.get_record_view(scan.rid(), AccessPattern::SEQUENTIAL);
+            checksum += RmVarLenRecord::get_field(view.data(), FIXED_LEN, NUM_FIELDS, 1)[0];
+            count++;
+        }
+        return count;
+    });
+
+    printf("%-8s %8s %10s %10s %10s %10s %8s\n", "layout", "pages", "rows/page", "scan rows", "MB read", "reads",
+           "ms");
+    printf("%-8s %8d %10.1f %10ld %10.1f %10lu %8.0f\n", "CHAR(n)", char_pages,
+           static_cast<double>(NUM_ROWS) / (char_pages - 1), char_scan.rows, char_scan.mb_read,
+           static_cast<unsigned long>(char_scan.reads), char_scan.ms);
+    printf("%-8s %8d %10.1f %10ld %10.1f %10lu %8.0f\n", "slotted", slotted_pages,
+           static_cast<double>(NUM_ROWS) / (slotted_pages - 1), slotted_scan.rows, slotted_scan.mb_read,
+           static_cast<unsigned long>(slotted_scan.reads), slotted_scan.ms);
+    if (checksum == -1) {
+        printf("unreachable\n");
+    }
+
+    disk_manager.close_file(char_fd);
+    disk_manager.close_file(slotted_fd);
+    disk_manager.destroy_file(char_path);
+    disk_manager.destroy_file(slotted_path);
+    return 0;
+}
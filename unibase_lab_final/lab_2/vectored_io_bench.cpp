@@ -0,0 +1,125 @@
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+#include "bench_util.h"
+#include "storage/disk_manager.h"
+
+/* 逐页读写与批量读写的系统调用次数和吞吐，文件在页缓存中，衡量的是系统调用本身的开销
+ * lseek + read/write：对照实现，按改用pread/pwrite之前的做法每页两次系统调用
+ * read_page/write_page：每页一次pread/pwrite
+ * read_pages/write_pages：每批64个页面，相邻页面合并为一次preadv/pwritev
+ * sequential为按页号顺序访问整个文件；sparse为随机选取1/4的页面按页号排序后访问，对应flush_all_pages写回部分脏页 */
+
+static constexpr int NUM_PAGES = 16384;
+static constexpr int BATCH = 64;
+static constexpr int ROUNDS = 5;  // 每种方式重复执行，取最快的一次
+
+struct Result {
+    uint64_t syscalls;
+    double seconds;
+};
+
+static Result run_lseek(int fd, const std::vector<page_id_t> &page_nos, char *buf, bool is_write) {
+    BenchTimer timer;
+    for (page_id_t page_no : page_nos) {
+        lseek(fd, static_cast<off_t>(page_no) * PAGE_SIZE, SEEK_SET);
+        ssize_t bytes = is_write ? write(fd, buf, PAGE_SIZE) : read(fd, buf, PAGE_SIZE);
+        if (bytes != PAGE_SIZE) {
+            perror("lseek + read/write");
+        }
+    }
+    return {2 * page_nos.size(), timer.seconds()};
+}
+
+static Result run_per_page(DiskManager *disk_manager, int fd, const std::vector<page_id_t> &page_nos, char *buf,
+                           bool is_write) {
+    DiskStats before = disk_manager->get_stats();
+    BenchTimer timer;
+    for (page_id_t page_no : page_nos) {
+        if (is_write) {
+            disk_manager->write_page(fd, page_no, buf, PAGE_SIZE);
+        } else {
+            disk_manager->read_page(fd, page_no, buf, PAGE_SIZE);
+        }
+    }
+    double seconds = timer.seconds();
+    DiskStats after = disk_manager->get_stats();
+    return {is_write ? after.num_writes - before.num_writes : after.num_reads - before.num_reads, seconds};
+}
+
+static Result run_batched(DiskManager *disk_manager, int fd, const std::vector<page_id_t> &page_nos,
+                          std::vector<char> *bufs, bool is_write) {
+    DiskStats before = disk_manager->get_stats();
+    BenchTimer timer;
+    for (size_t start = 0; start < page_nos.size(); start += BATCH) {
+        size_t end = std::min(page_nos.size(), start + BATCH);
+        if (is_write) {
+            std::vector<std::pair<page_id_t, const char *>> pages;
+            for (size_t i = start; i < end; i++) {
+                pages.emplace_back(page_nos[i], bufs->data() + (i - start) * PAGE_SIZE);
+            }
+            disk_manager->write_pages(fd, pages);
+        } else {
+            std::vector<std::pair<page_id_t, char *>> pages;
+            for (size_t i = start; i < end; i++) {
+                pages.emplace_back(page_nos[i], bufs->data() + (i - start) * PAGE_SIZE);
+            }
+            disk_manager->read_pages(fd, pages);
+        }
+    }
+    double seconds = timer.seconds();
+    DiskStats after = disk_manager->get_stats();
+    return {is_write ? after.num_writes - before.num_writes : after.num_reads - before.num_reads, seconds};
+}
+
+int main() {
+    std::string path = "vectored_io_bench.db";
+    DiskManager disk_manager;
+    create_bench_file(&disk_manager, path, NUM_PAGES);
+    int fd = disk_manager.open_file(path);
+
+    std::vector<page_id_t> sequential(NUM_PAGES);
+    for (int i = 0; i < NUM_PAGES; i++) {
+        sequential[i] = i;
+    }
+    std::vector<page_id_t> sparse = sequential;
+    std::shuffle(sparse.begin(), sparse.end(), std::mt19937(5));
+    sparse.resize(NUM_PAGES / 4);
+    std::sort(sparse.begin(), sparse.end());
+
+    std::vector<char> bufs(static_cast<size_t>(BATCH) * PAGE_SIZE, 'x');
+    printf("%d-page file in the page cache, batches of %d pages, best of %d\n", NUM_PAGES, BATCH, ROUNDS);
+    printf("%-11s %-6s %-22s %10s %12s %10s\n", "pages", "op", "method", "syscalls", "syscalls/pg", "MB/s");
+    for (auto [name, page_nos] : {std::pair<const char *, std::vector<page_id_t> *>{"sequential", &sequential},
+                                  std::pair<const char *, std::vector<page_id_t> *>{"sparse 1/4", &sparse}}) {
+        for (bool is_write : {false, true}) {
+            Result results[3];
+            for (int round = 0; round < ROUNDS; round++) {
+                Result current[3] = {run_lseek(fd, *page_nos, bufs.data(), is_write),
+                                     run_per_page(&disk_manager, fd, *page_nos, bufs.data(), is_write),
+                                     run_batched(&disk_manager, fd, *page_nos, &bufs, is_write)};
+                for (int i = 0; i < 3; i++) {
+                    if (round == 0 || current[i].seconds < results[i].seconds) {
+                        results[i] = current[i];
+                    }
+                }
+            }
+            const char *methods[3] = {"lseek + read/write", is_write ? "write_page" : "read_page",
+                                      is_write ? "write_pages" : "read_pages"};
+            for (int i = 0; i < 3; i++) {
+                printf("%-11s %-6s %-22s %10lu %12.3f %10.1f\n", name, is_write ? "write" : "read", methods[i],
+                       static_cast<unsigned long>(results[i].syscalls),
+                       static_cast<double>(results[i].syscalls) / page_nos->size(),
+                       static_cast<double>(page_nos->size()) * PAGE_SIZE / results[i].seconds / (1024 * 1024));
+            }
+        }
+    }
+
+    disk_manager.close_file(fd);
+    disk_manager.destroy_file(path);
+    return 0;
+}
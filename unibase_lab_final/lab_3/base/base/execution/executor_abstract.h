@@ -43,4 +43,44 @@ class AbstractExecutor {
         }
         return pos;
     }
+
+    /**
+     * @description: 在一条记录上计算条件，rec_data可以是物化的RmRecord::data，也可以是RmRecordView::data()
+     */
+    bool eval_cond(const std::vector<ColMeta> &rec_cols, const Condition &cond, const char *rec_data) {
+        auto lhs_col = get_col(rec_cols, cond.lhs_col);
+        const char *lhs = rec_data + lhs_col->offset;
+        const char *rhs;
+        ColType rhs_type;
+        if (cond.is_rhs_val) {
+            rhs_type = cond.rhs_val.type;
+            rhs = cond.rhs_val.raw->data;
+        } else {
+            auto rhs_col = get_col(rec_cols, cond.rhs_col);
+            rhs_type = rhs_col->type;
+            rhs = rec_data + rhs_col->offset;
+        }
+        assert(rhs_type == lhs_col->type);
+        int cmp = ix_compare(lhs, rhs, rhs_type, lhs_col->len);
+        if (cond.op == OP_EQ) {
+            return cmp == 0;
+        } else if (cond.op == OP_NE) {
+            return cmp != 0;
+        } else if (cond.op == OP_LT) {
+            return cmp < 0;
+        } else if (cond.op == OP_GT) {
+            return cmp > 0;
+        } else if (cond.op == OP_LE) {
+            return cmp <= 0;
+        } else if (cond.op == OP_GE) {
+            return cmp >= 0;
+        } else {
+            throw InternalError("Unexpected op type");
+        }
+    }
+
+    bool eval_conds(const std::vector<ColMeta> &rec_cols, const std::vector<Condition> &conds, const char *rec_data) {
+        return std::all_of(conds.begin(), conds.end(),
+                           [&](const Condition &cond) { return eval_cond(rec_cols, cond, rec_data); });
+    }
 };
\ No newline at end of file
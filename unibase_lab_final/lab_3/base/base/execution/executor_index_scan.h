@@ -84,71 +84,38 @@ class IndexScanExecutor : public AbstractExecutor {
             }
         }
         scan_ = std::make_unique<IxScan>(ih, lower, upper, sm_manager_->get_bpm()); // 获取第一个记录
-        while (!scan_->is_end()) {
-            rid_ = scan_->rid();
-            auto rec = fh_->get_record(rid_, context_);
-            if (eval_conds(cols_, fed_conds_, rec.get()))
-            {
-                break;
-            }
-            scan_->next();
-        }
+        find_next();
     }
 
     void nextTuple() override {
-            scan_->next();
-        while (!scan_->is_end())
-        {
-            rid_ = scan_->rid();
-            auto rec = fh_->get_record(rid_, context_); // 当前扫描到的记录
-            if (eval_conds(cols_, fed_conds_, rec.get())) // 利用eval_conds判断是否当前记录(rec.get())满足谓词条件
-            {
-                break;
-            }
-            scan_->next(); // 找下一个有record的位置
-        }
+        scan_->next();
+        find_next();
     }
 
-
+    // 只有满足条件的记录才被物化
     std::unique_ptr<RmRecord> Next() override {
-        return nullptr;
+        return fh_->get_record(rid_, context_);
     }
 
+    bool is_end() const override { return scan_->is_end(); }
+
+    size_t tupleLen() const override { return len_; }
+
+    const std::vector<ColMeta> &cols() const override { return cols_; }
+
+    std::string getType() override { return "IndexScanExecutor"; }
+
     Rid &rid() override { return rid_; }
-     bool eval_cond(const std::vector<ColMeta> &rec_cols, const Condition &cond, const RmRecord *rec) {
-        auto lhs_col = get_col(rec_cols, cond.lhs_col);
-        char *lhs = rec->data + lhs_col->offset;
-        char *rhs;
-        ColType rhs_type;
-        if (cond.is_rhs_val) {
-            rhs_type = cond.rhs_val.type;
-            rhs = cond.rhs_val.raw->data;
-        } else {
-            auto rhs_col = get_col(rec_cols, cond.rhs_col);
-            rhs_type = rhs_col->type;
-            rhs = rec->data + rhs_col->offset;
-        }
-        assert(rhs_type == lhs_col->type);  
-        int cmp = ix_compare(lhs, rhs, rhs_type, lhs_col->len);
-        if (cond.op == OP_EQ) {
-            return cmp == 0;
-        } else if (cond.op == OP_NE) {
-            return cmp != 0;
-        } else if (cond.op == OP_LT) {
-            return cmp < 0;
-        } else if (cond.op == OP_GT) {
-            return cmp > 0;
-        } else if (cond.op == OP_LE) {
-            return cmp <= 0;
-        } else if (cond.op == OP_GE) {
-            return cmp >= 0;
-        } else {
-            throw InternalError("Unexpected op type");
+
+   private:
+    // 从scan_当前位置开始找到第一条满足条件的记录；条件在缓冲池中的记录视图上计算，不复制记录
+    void find_next() {
+        while (!scan_->is_end()) {
+            rid_ = scan_->rid();
+            if (eval_conds(cols_, fed_conds_, fh_->get_record_view(rid_).data())) {
+                break;
+            }
+            scan_->next(); // 找下一个有record的位置
         }
     }
-    
-    bool eval_conds(const std::vector<ColMeta> &rec_cols, const std::vector<Condition> &conds, const RmRecord *rec) {
-        return std::all_of(conds.begin(), conds.end(),
-                           [&](const Condition &cond) { return eval_cond(rec_cols, cond, rec); });
-    }
 };
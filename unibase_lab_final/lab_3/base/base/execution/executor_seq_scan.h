@@ -36,16 +36,39 @@ class SeqScanExecutor : public AbstractExecutor {
     }
 
     void beginTuple() override {
-    
+        scan_ = std::make_unique<RmScan>(fh_);
+        find_next();
     }
 
     void nextTuple() override {
-
+        scan_->next();
+        find_next();
     }
 
+    // 只有满足条件的记录才被物化
     std::unique_ptr<RmRecord> Next() override {
-        return nullptr;
+        return fh_->get_record(rid_, context_);
     }
 
+    bool is_end() const override { return scan_->is_end(); }
+
+    size_t tupleLen() const override { return len_; }
+
+    const std::vector<ColMeta> &cols() const override { return cols_; }
+
+    std::string getType() override { return "SeqScanExecutor"; }
+
     Rid &rid() override { return rid_; }
+
+   private:
+    // 从scan_当前位置开始找到第一条满足条件的记录；条件在缓冲池中的记录视图上计算，不复制记录
+    void find_next() {
+        while (!scan_->is_end()) {
+            rid_ = scan_->rid();
+            if (eval_conds(cols_, fed_conds_, fh_->get_record_view(rid_, AccessPattern::SEQUENTIAL).data())) {
+                break;
+            }
+            scan_->next();
+        }
+    }
 };
\ No newline at end of file
@@ -2,3 +2,6 @@
 
 #include "defs.h"
 #include <string>
+
+// 关闭数据库时记录缓冲池中的页面（文件名 页号），打开数据库时据此预热缓冲池
+static const std::string WARMUP_FILE_NAME = "bufferpool.warmup";
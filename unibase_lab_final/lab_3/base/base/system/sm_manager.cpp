@@ -73,8 +73,9 @@ void SmManager::drop_db(const std::string& db_name) {
 /**
  * @description: 打开数据库，找到数据库对应的文件夹，并加载数据库元数据和相关文件
  * @param {string&} db_name 数据库名称，与文件夹同名
+ * @param {bool} read_only 只读打开（如只做查询的副本）：索引文件以只读映射打开，结点页面不占用缓冲池的帧
  */
-void SmManager::open_db(const std::string& db_name) {
+void SmManager::open_db(const std::string& db_name, bool read_only) {
     if (!is_dir(db_name)) {
         throw DatabaseNotFoundError(db_name);
     }
@@ -87,6 +88,17 @@ void SmManager::open_db(const std::string& db_name) {
     }
     ifs >> db_; //用重载过的>>载入数据库元数据
     ifs.close(); // 关闭文件
+    read_only_ = read_only;
+    // 打开每张表的记录文件和索引文件
+    for (auto &entry : db_.tabs_) {
+        auto &tab = entry.second;
+        fhs_.emplace(tab.name, rm_manager_->open_file(tab.name));
+        for (auto &index : tab.indexes) {
+            ihs_.emplace(ix_manager_->get_index_name(tab.name, index.cols),
+                         ix_manager_->open_index(tab.name, index.cols, read_only_));
+        }
+    }
+    load_warmup_pages();
 }
 
 
@@ -103,13 +115,91 @@ void SmManager::flush_meta() {
  * @description: 关闭数据库并把数据落盘
  */
 void SmManager::close_db() {
-    flush_meta();
+    // 必须在关闭文件之前记录，关闭后页面的fd已无法对应到文件名
+    if (!read_only_) {
+        save_warmup_pages();
+    }
+    for (auto &entry : fhs_) {
+        rm_manager_->close_file(entry.second.get());
+    }
+    for (auto &entry : ihs_) {
+        ix_manager_->close_index(entry.second.get());
+    }
+    fhs_.clear();
+    ihs_.clear();
+    if (!read_only_) {
+        flush_meta();
+    }
+    read_only_ = false;
     db_.name_.clear();
     db_.tabs_.clear();
     if (chdir("..") < 0) {
         throw UnixError();}
 }
 
+/**
+ * @description: 只读打开的数据库不能修改表和索引的定义
+ */
+void SmManager::check_writable() const {
+    if (read_only_) {
+        throw InternalError("SmManager: database " + db_.name_ + " is opened read-only");
+    }
+}
+
+/**
+ * @description: 获取当前数据库中已打开的记录文件和索引文件
+ * @return {unordered_map<int, string>} fd -> 文件名
+ */
+std::unordered_map<int, std::string> SmManager::open_file_names() {
+    std::unordered_map<int, std::string> names;
+    for (auto &entry : fhs_) {
+        names[entry.second->GetFd()] = entry.first;
+    }
+    for (auto &entry : ihs_) {
+        names[disk_manager_->get_file_fd(entry.first)] = entry.first;
+    }
+    return names;
+}
+
+/**
+ * @description: 把缓冲池中属于当前数据库的页面写入预热文件，每行为"文件名 页号"
+ *               fd在重启后会变化，因此按文件名记录
+ */
+void SmManager::save_warmup_pages() {
+    auto names = open_file_names();
+    std::ofstream ofs(WARMUP_FILE_NAME);
+    for (auto &page_id : buffer_pool_manager_->get_resident_pages()) {
+        auto it = names.find(page_id.fd);
+        if (it != names.end()) {
+            ofs << it->second << ' ' << page_id.page_no << '\n';
+        }
+    }
+}
+
+/**
+ * @description: 按预热文件把上次关闭时缓冲池中的页面交给后台预读线程读入
+ *               每个文件按页号顺序预读，连续的页面合并为一次读盘；不再存在的文件直接跳过
+ */
+void SmManager::load_warmup_pages() {
+    std::ifstream ifs(WARMUP_FILE_NAME);
+    if (!ifs.is_open()) {
+        return;
+    }
+    std::unordered_map<std::string, std::vector<page_id_t>> file_pages;
+    std::string file_name;
+    page_id_t page_no;
+    while (ifs >> file_name >> page_no) {
+        file_pages[file_name].push_back(page_no);
+    }
+    ifs.close();
+    for (auto &[fd, name] : open_file_names()) {
+        auto it = file_pages.find(name);
+        if (it != file_pages.end()) {
+            buffer_pool_manager_->prefetch_pages(fd, std::move(it->second));
+        }
+    }
+}
+
 /**
  * @description: 显示所有的表,通过测试需要将其结果写入到output.txt,详情看题目文档
  * @param {Context*} context 
@@ -131,6 +221,64 @@ void SmManager::show_tables(Context* context) {
     outfile.close();
 }
 
+/**
+ * @description: 显示缓冲池每个分片和磁盘读写的统计信息，用于确定缓冲池大小和发现页面抖动
+ * @param {Context*} context 
+ */
+void SmManager::show_bufferpool(Context* context) {
+    std::vector<std::string> captions = {"Shard", "Frames", "Free", "Dirty", "Pinned", "Hits", "Misses", "HitRatio",
+                                         "Evictions", "DirtyEvictions", "BgWrites", "Prefetched", "PinFailures",
+                                         "MissP99(us)"};
+    auto to_row = [](const std::string& name, const BufferPoolStats& stats) {
+        char ratio[16];
+        snprintf(ratio, sizeof(ratio), "%.2f%%", stats.hit_ratio() * 100);
+        return std::vector<std::string>{name,
+                                        std::to_string(stats.pool_size),
+                                        std::to_string(stats.free_frames),
+                                        std::to_string(stats.dirty_frames),
+                                        std::to_string(stats.pinned_frames),
+                                        std::to_string(stats.hits),
+                                        std::to_string(stats.misses),
+                                        ratio,
+                                        std::to_string(stats.evictions),
+                                        std::to_string(stats.dirty_evictions),
+                                        std::to_string(stats.background_writes),
+                                        std::to_string(stats.prefetched_pages),
+                                        std::to_string(stats.pin_failures),
+                                        std::to_string(LatencyHistogram::percentile(stats.miss_latency, 0.99))};
+    };
+    RecordPrinter printer(captions.size());
+    printer.print_separator(context);
+    printer.print_record(captions, context);
+    printer.print_separator(context);
+    auto shard_stats = buffer_pool_manager_->get_shard_stats();
+    BufferPoolStats total;
+    for (size_t i = 0; i < shard_stats.size(); i++) {
+        printer.print_record(to_row(std::to_string(i), shard_stats[i]), context);
+        total.merge(shard_stats[i]);
+    }
+    if (shard_stats.size() > 1) {
+        printer.print_record(to_row("total", total), context);
+    }
+    printer.print_separator(context);
+
+    DiskStats disk = disk_manager_->get_stats();
+    std::vector<std::string> disk_captions = {"Reads", "BytesRead", "ReadP50(us)", "ReadP99(us)",
+                                              "Writes", "BytesWritten", "WriteP50(us)", "WriteP99(us)"};
+    RecordPrinter disk_printer(disk_captions.size());
+    disk_printer.print_separator(context);
+    disk_printer.print_record(disk_captions, context);
+    disk_printer.print_separator(context);
+    disk_printer.print_record({std::to_string(disk.num_reads), std::to_string(disk.bytes_read),
+                               std::to_string(LatencyHistogram::percentile(disk.read_latency, 0.5)),
+                               std::to_string(LatencyHistogram::percentile(disk.read_latency, 0.99)),
+                               std::to_string(disk.num_writes), std::to_string(disk.bytes_written),
+                               std::to_string(LatencyHistogram::percentile(disk.write_latency, 0.5)),
+                               std::to_string(LatencyHistogram::percentile(disk.write_latency, 0.99))},
+                              context);
+    disk_printer.print_separator(context);
+}
+
 /**
  * @description: 显示表的元数据
  * @param {string&} tab_name 表名称
@@ -161,6 +309,7 @@ void SmManager::desc_table(const std::string& tab_name, Context* context) {
  * @param {Context*} context 
  */
 void SmManager::create_table(const std::string& tab_name, const std::vector<ColDef>& col_defs, Context* context) {
+    check_writable();
     if (db_.is_table(tab_name)) {
         throw TableExistsError(tab_name);
     }
@@ -194,6 +343,7 @@ void SmManager::create_table(const std::string& tab_name, const std::vector<ColD
  * @param {Context*} context
  */
 void SmManager::drop_table(const std::string& tab_name, Context* context) {
+    check_writable();
      //判断表是否存在
     if (!db_.is_table(tab_name)) {
         throw TableNotFoundError(tab_name);
@@ -215,6 +365,7 @@ void SmManager::drop_table(const std::string& tab_name, Context* context) {
  * @param {Context*} context
  */
 void SmManager::create_index(const std::string& tab_name, const std::vector<std::string>& col_names, Context* context) {
+    check_writable();
     //判断表是否存在
     if (!db_.is_table(tab_name)) {
         throw TableNotFoundError(tab_name);
@@ -25,6 +25,7 @@ class SmManager {
     BufferPoolManager* buffer_pool_manager_;
     RmManager* rm_manager_;
     IxManager* ix_manager_;
+    bool read_only_ = false;    // 以只读方式打开的数据库：索引文件只读映射，不执行DDL，关闭时不写回元数据
 
    public:
     SmManager(DiskManager* disk_manager, BufferPoolManager* buffer_pool_manager, RmManager* rm_manager,
@@ -48,7 +49,7 @@ class SmManager {
 
     void drop_db(const std::string& db_name);
 
-    void open_db(const std::string& db_name);
+    void open_db(const std::string& db_name, bool read_only = false);
 
     void close_db();
 
@@ -58,6 +59,8 @@ class SmManager {
 
     void desc_table(const std::string& tab_name, Context* context);
 
+    void show_bufferpool(Context* context);
+
     void create_table(const std::string& tab_name, const std::vector<ColDef>& col_defs, Context* context);
 
     void drop_table(const std::string& tab_name, Context* context);
@@ -67,4 +70,13 @@ class SmManager {
     void drop_index(const std::string& tab_name, const std::vector<std::string>& col_names, Context* context);
     
     void drop_index(const std::string& tab_name, const std::vector<ColMeta>& col_names, Context* context);
+
+   private:
+    void check_writable() const;
+
+    std::unordered_map<int, std::string> open_file_names();
+
+    void save_warmup_pages();
+
+    void load_warmup_pages();
 };
\ No newline at end of file